@@ -0,0 +1,280 @@
+
+// NOTE: Loads assets in the background while the window is already up.
+// Everything gets queued first, then worker threads do the file reads and
+// the PNG/WAV decoding while the main thread uploads whatever is ready a
+// few milliseconds at a time, since GL and the audio device only want to
+// be touched from there. The web build has no threads so the main thread
+// does the decoding as well, inside the same budget.
+//
+// Nothing that comes out of the asset pack needs decoding, those jobs are
+// ready to upload the moment they're queued. On the web an asset whose pack
+// hasn't arrived yet waits for it rather than going to the file.
+
+#if !defined(PLATFORM_WEB)
+#include <thread>
+#endif
+
+inline u32 AtomicCompareExchangeU32(volatile u32 *value, u32 expected, u32 desired) {
+#if defined(_MSC_VER)
+    u32 result = (u32)_InterlockedCompareExchange((volatile long *)value, (long)desired, (long)expected);
+#else
+    u32 result = expected;
+    __atomic_compare_exchange_n(value, &result, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+#endif
+    return result;
+}
+
+inline u32 AtomicLoadU32(volatile u32 *value) {
+#if defined(_MSC_VER)
+    u32 result = *value;
+    _ReadWriteBarrier();
+#else
+    u32 result = __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
+    return result;
+}
+
+inline void AtomicStoreU32(volatile u32 *value, u32 new_value) {
+#if defined(_MSC_VER)
+    _ReadWriteBarrier();
+    *value = new_value;
+#else
+    __atomic_store_n(value, new_value, __ATOMIC_RELEASE);
+#endif
+}
+
+void AssetLoaderInit(Asset_Loader *loader, Asset_Library *library) {
+    *loader               = {};
+    loader->library       = library;
+    loader->arrivals_seen = library->arrival_count;
+}
+
+// Points the job straight at the asset in the pack if it's there.
+b32 AssetLoaderFillFromPack(Asset_Loader *loader, Asset_Job *job) {
+    void             *data  = NULL;
+    Asset_Pack_Entry *entry = AssetLibraryFind(loader->library, job->path, job->kind, &data);
+    if (!entry) return false;
+
+    switch (job->kind) {
+        case AssetKind_image: {
+            job->image = {data, (s32)entry->width, (s32)entry->height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+        } break;
+        case AssetKind_wave: {
+            job->wave  = {entry->frame_count, entry->sample_rate, entry->sample_size, entry->channels, data};
+        } break;
+        case AssetKind_file: {
+            job->file_data = (u8 *)data;
+            job->file_size = (s32)entry->size;
+        } break;
+    }
+    return true;
+}
+
+// Returns the job number, which is its index plus one so zero can mean
+// there isn't one. Queueing the same path twice hands back the first job.
+u32 AssetLoaderQueue(Asset_Loader *loader, Asset_Kind kind, const char *path, Asset_Priority priority) {
+    ASSERT(loader->thread_count == 0);
+    for (u32 index = 0; index < loader->job_count; index++) {
+        if (loader->jobs[index].kind == kind && TextIsEqual(loader->jobs[index].path, path)) {
+            return index + 1;
+        }
+    }
+
+    ASSERT(loader->job_count < ASSET_LOADER_MAX_JOBS);
+    Asset_Job *job = &loader->jobs[loader->job_count++];
+    *job           = {};
+    snprintf(job->path, TEXTURE_PATH_MAX, "%s", path);
+    job->kind      = kind;
+    job->priority  = priority;
+
+    if (AssetLoaderFillFromPack(loader, job)) {
+        job->state = AssetJob_decoded;
+    } else if (AssetLibraryPending(loader->library)) {
+        job->state = AssetJob_waiting;
+    }
+    return loader->job_count;
+}
+
+// Whoever gets a job from queued to decoding is the one that decodes it.
+b32 AssetLoaderDecode(Asset_Job *job) {
+    if (AtomicCompareExchangeU32(&job->state, AssetJob_queued, AssetJob_decoding) != AssetJob_queued) {
+        return false;
+    }
+
+    switch (job->kind) {
+        case AssetKind_image: job->image     = LoadImage(job->path);                 break;
+        case AssetKind_wave:  job->wave      = LoadWave(job->path);                  break;
+        case AssetKind_file:  job->file_data = LoadFileData(job->path, &job->file_size); break;
+    }
+    job->owns_data = true;
+    AtomicStoreU32(&job->state, AssetJob_decoded);
+    return true;
+}
+
+#if !defined(PLATFORM_WEB)
+void AssetLoaderWorker(Asset_Loader *loader) {
+    for (u32 index = 0; index < loader->job_count; index++) {
+        AssetLoaderDecode(&loader->jobs[index]);
+    }
+}
+#endif
+
+// Call once everything has been queued.
+void AssetLoaderStart(Asset_Loader *loader) {
+#if !defined(PLATFORM_WEB)
+    u32 thread_count = std::thread::hardware_concurrency();
+    thread_count     = CLAMP(thread_count > 1 ? thread_count - 1 : 1, 1, ASSET_LOADER_MAX_THREADS);
+    // NOTE: The workers just run off the end of the queue and exit, they
+    // don't have to be joined.
+    for (u32 index = 0; index < thread_count; index++) {
+        std::thread(AssetLoaderWorker, loader).detach();
+    }
+    loader->thread_count = thread_count;
+#else
+    loader->thread_count = 1;
+#endif
+}
+
+void AssetLoaderUpload(Asset_Loader *loader, Asset_Job *job) {
+    switch (job->kind) {
+        case AssetKind_image: {
+            job->texture = LoadTextureFromImage(job->image);
+#if defined(PLATFORM_WEB)
+            SetTextureWrap(job->texture, TEXTURE_WRAP_CLAMP);
+            SetTextureFilter(job->texture, TEXTURE_FILTER_POINT);
+#endif
+            if (job->owns_data) UnloadImage(job->image);
+            job->image = {};
+        } break;
+        case AssetKind_wave: {
+            job->sound = LoadSoundFromWave(job->wave);
+            if (job->owns_data) UnloadWave(job->wave);
+            job->wave = {};
+        } break;
+        case AssetKind_file: {
+            // NOTE: Music streams keep reading from the data so it's never
+            // freed, the game holds onto its music until it exits anyway.
+        } break;
+    }
+    AtomicStoreU32(&job->state, AssetJob_done);
+    loader->done_count++;
+}
+
+// Uploads whatever has been decoded in queue order until the budget runs
+// out, always at least one so it can't stall on something big.
+void AssetLoaderUpdate(Asset_Loader *loader, f64 budget) {
+    f64 start = GetTime();
+
+    // NOTE: Waiting jobs only get looked at again when a pack has turned
+    // up, and once nothing else can turn up they go to the file instead.
+    if (loader->arrivals_seen != loader->library->arrival_count) {
+        loader->arrivals_seen = loader->library->arrival_count;
+        b32 pending           = AssetLibraryPending(loader->library);
+        for (u32 index = 0; index < loader->job_count; index++) {
+            Asset_Job *job = &loader->jobs[index];
+            if (AtomicLoadU32(&job->state) != AssetJob_waiting) continue;
+            if (AssetLoaderFillFromPack(loader, job)) {
+                AtomicStoreU32(&job->state, AssetJob_decoded);
+            } else if (!pending) {
+                AtomicStoreU32(&job->state, AssetJob_queued);
+            }
+        }
+    }
+
+    for (u32 index = 0; index < loader->job_count; index++) {
+        Asset_Job *job   = &loader->jobs[index];
+        u32        state = AtomicLoadU32(&job->state);
+        if (state == AssetJob_done) continue;
+#if defined(PLATFORM_WEB)
+        if (state == AssetJob_queued) {
+            AssetLoaderDecode(job);
+            state = AssetJob_decoded;
+        }
+#endif
+        if (state != AssetJob_decoded) continue;
+
+        AssetLoaderUpload(loader, job);
+        if (GetTime() - start >= budget) break;
+    }
+}
+
+// Finishes the job right now on this thread if it isn't done yet, for when
+// something needs the asset before the loader got around to it.
+Asset_Job *AssetLoaderFinish(Asset_Loader *loader, u32 job_number) {
+    Asset_Job *job = &loader->jobs[job_number - 1];
+    if (AtomicLoadU32(&job->state) == AssetJob_done) return job;
+
+    // Can't wait around for the pack, take the file.
+    AtomicCompareExchangeU32(&job->state, AssetJob_waiting, AssetJob_queued);
+    AssetLoaderDecode(job);
+    while (AtomicLoadU32(&job->state) != AssetJob_decoded) {
+        // A worker has it, it'll be done in a moment.
+#if !defined(PLATFORM_WEB)
+        std::this_thread::yield();
+#endif
+    }
+    AssetLoaderUpload(loader, job);
+    return job;
+}
+
+u32 AssetLoaderFind(Asset_Loader *loader, const char *path, Asset_Kind kind) {
+    for (u32 index = 0; index < loader->job_count; index++) {
+        Asset_Job *job = &loader->jobs[index];
+        if (!job->taken && job->kind == kind && TextIsEqual(job->path, path)) return index + 1;
+    }
+    return 0;
+}
+
+b32 AssetLoaderIsDone(Asset_Loader *loader, u32 job_number) {
+    b32 result = AtomicLoadU32(&loader->jobs[job_number - 1].state) == AssetJob_done;
+    return result;
+}
+
+// True once every job at this priority or more urgent has been uploaded.
+b32 AssetLoaderReached(Asset_Loader *loader, Asset_Priority priority) {
+    for (u32 index = 0; index < loader->job_count; index++) {
+        Asset_Job *job = &loader->jobs[index];
+        if (job->priority <= priority && AtomicLoadU32(&job->state) != AssetJob_done) return false;
+    }
+    return true;
+}
+
+// Hands the loaded asset over to the caller, it's theirs to unload after
+// this. Each one can only be taken once.
+b32 AssetLoaderTakeTexture(Asset_Loader *loader, const char *path, Texture2D *texture) {
+    u32 job_number = AssetLoaderFind(loader, path, AssetKind_image);
+    if (!job_number) return false;
+    Asset_Job *job = AssetLoaderFinish(loader, job_number);
+    job->taken     = true;
+    *texture       = job->texture;
+    return true;
+}
+
+b32 AssetLoaderTakeSound(Asset_Loader *loader, const char *path, Sound *sound) {
+    u32 job_number = AssetLoaderFind(loader, path, AssetKind_wave);
+    if (!job_number) return false;
+    Asset_Job *job = AssetLoaderFinish(loader, job_number);
+    job->taken     = true;
+    *sound         = job->sound;
+    return true;
+}
+
+b32 AssetLoaderTakeFile(Asset_Loader *loader, const char *path, u8 **data, s32 *size) {
+    u32 job_number = AssetLoaderFind(loader, path, AssetKind_file);
+    if (!job_number) return false;
+    Asset_Job *job = AssetLoaderFinish(loader, job_number);
+    job->taken     = true;
+    *data          = job->file_data;
+    *size          = job->file_size;
+    return true;
+}
+
+// Opening the stream is just reading the header so it happens here rather
+// than in the upload.
+b32 AssetLoaderTakeMusic(Asset_Loader *loader, const char *path, Music *music) {
+    u8 *data = NULL;
+    s32 size = 0;
+    if (!AssetLoaderTakeFile(loader, path, &data, &size)) return false;
+    *music   = LoadMusicStreamFromMemory(GetFileExtension(path), data, size);
+    return true;
+}
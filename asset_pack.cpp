@@ -0,0 +1,361 @@
+
+// NOTE: Desktop maps every pack in the index straight into memory so the
+// only cost at startup is faulting in the pages that actually get uploaded.
+// The web build fetches them into the heap one group at a time instead, see
+// AssetLibraryFetch(), and keeps them in IndexedDB so a second visit only
+// downloads the index.
+
+#if defined(PLATFORM_WEB)
+#include <emscripten/fetch.h>
+#elif defined(_WIN32)
+// NOTE: windows.h clashes with raylib (Rectangle, CloseWindow, DrawText...)
+// so just declare the handful of kernel32 calls this needs.
+extern "C" {
+__declspec(dllimport) void *__stdcall CreateFileA(const char *, unsigned long, unsigned long, void *,
+                                                  unsigned long, unsigned long, void *);
+__declspec(dllimport) void *__stdcall CreateFileMappingA(void *, void *, unsigned long, unsigned long,
+                                                         unsigned long, const char *);
+__declspec(dllimport) void *__stdcall MapViewOfFile(void *, unsigned long, unsigned long, unsigned long, size_t);
+__declspec(dllimport) int   __stdcall UnmapViewOfFile(const void *);
+__declspec(dllimport) int   __stdcall GetFileSizeEx(void *, long long *);
+__declspec(dllimport) int   __stdcall CloseHandle(void *);
+}
+#define PACK_GENERIC_READ          0x80000000
+#define PACK_FILE_SHARE_READ       0x00000001
+#define PACK_OPEN_EXISTING         3
+#define PACK_FILE_ATTRIBUTE_NORMAL 0x00000080
+#define PACK_PAGE_READONLY         0x02
+#define PACK_FILE_MAP_READ         0x0004
+#define PACK_INVALID_HANDLE        ((void *)(intptr_t)-1)
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Checks the header and points the pack at the entries. The memory has to
+// stay alive for as long as anything loaded out of the pack does, music
+// streams keep reading from it.
+// A pack whose content hash doesn't match the index is from some other
+// build, which is how a stale cached copy gets caught. One whose size
+// doesn't match got cut short, a half written .pak or an IndexedDB copy
+// from a download that didn't finish.
+b32 AssetPackOpenMemory(Asset_Pack *pack, u8 *base, size_t size) {
+    if ((u64)size != pack->index_size) {
+        TraceLog(LOG_WARNING, "PACK: %s is %llu bytes but the index wants %llu", pack->path,
+                 (unsigned long long)size, (unsigned long long)pack->index_size);
+        return false;
+    }
+    Asset_Pack_Header *header = (Asset_Pack_Header *)base;
+    if (size < sizeof(Asset_Pack_Header) || header->magic != ASSET_PACK_MAGIC ||
+        header->version != ASSET_PACK_VERSION || header->entries_offset > size ||
+        (u64)header->entry_count*sizeof(Asset_Pack_Entry) > size - header->entries_offset) {
+        TraceLog(LOG_WARNING, "PACK: %s isn't a version %d asset pack", pack->path, ASSET_PACK_VERSION);
+        return false;
+    }
+    if (header->content_hash != pack->content_hash) {
+        TraceLog(LOG_WARNING, "PACK: %s is %08x but the index wants %08x", pack->path,
+                 header->content_hash, pack->content_hash);
+        return false;
+    }
+    // NOTE: A truncated pack can still have its header and entries intact,
+    // the hash is only ever compared and never recomputed, so each blob has
+    // to be checked against the size or loading it reads off the end of
+    // the mapping.
+    Asset_Pack_Entry *entries = (Asset_Pack_Entry *)(base + header->entries_offset);
+    for (u32 index = 0; index < header->entry_count; index++) {
+        Asset_Pack_Entry *entry = &entries[index];
+        if (entry->offset > size || entry->size > size - entry->offset) {
+            TraceLog(LOG_WARNING, "PACK: %s is cut short, %.*s doesn't fit", pack->path,
+                     ASSET_PACK_PATH_MAX, entry->path);
+            return false;
+        }
+    }
+
+    pack->base        = base;
+    pack->size        = size;
+    pack->entries     = entries;
+    pack->entry_count = header->entry_count;
+    TraceLog(LOG_INFO, "PACK: %s has %u assets, %.1f MB", pack->path, pack->entry_count, size / (1024.0*1024.0));
+    return true;
+}
+
+// One line per pack, see asset_pack.h. Lines that don't parse get skipped.
+void AssetLibraryParseIndex(Asset_Library *library, const char *text, size_t size) {
+    const char *at  = text;
+    const char *end = text + size;
+    while (at < end) {
+        char line[256];
+        u32  length = 0;
+        while (at < end && *at != '\n') {
+            if (length + 1 < sizeof(line)) line[length++] = *at;
+            at++;
+        }
+        line[length] = 0;
+        at++;
+
+        char group[ASSET_PACK_GROUP_MAX], path[ASSET_PACK_PATH_MAX];
+        u32  content_hash = 0;
+        unsigned long long index_size = 0;
+        if (sscanf(line, "pack %15s %63s %x %llu", group, path, &content_hash, &index_size) != 4) continue;
+        if (library->pack_count == ASSET_LIBRARY_MAX_PACKS) {
+            TraceLog(LOG_WARNING, "PACK: Only the first %d packs in the index get loaded", ASSET_LIBRARY_MAX_PACKS);
+            break;
+        }
+
+        Asset_Pack *pack   = &library->packs[library->pack_count++];
+        *pack              = {};
+        pack->content_hash = content_hash;
+        pack->index_size   = index_size;
+        snprintf(pack->group, sizeof(pack->group), "%s", group);
+        snprintf(pack->path,  sizeof(pack->path),  "%s", path);
+    }
+}
+
+#if defined(PLATFORM_WEB)
+void AssetPackFetch(Asset_Library *library, Asset_Pack *pack);
+void AssetLibraryFetchNext(Asset_Library *library);
+
+// NOTE: Packs are only ever fetched one at a time so the one in flight is
+// just whichever is fetching.
+Asset_Pack *AssetLibraryFetching(Asset_Library *library) {
+    for (u32 index = 0; index < library->pack_count; index++) {
+        if (library->packs[index].state == AssetPack_fetching) return &library->packs[index];
+    }
+    return NULL;
+}
+
+void AssetPackFetchSucceeded(emscripten_fetch_t *fetch) {
+    Asset_Library *library = (Asset_Library *)fetch->userData;
+    Asset_Pack    *pack    = AssetLibraryFetching(library);
+    if (AssetPackOpenMemory(pack, (u8 *)fetch->data, (size_t)fetch->numBytes)) {
+        pack->fetch = fetch;
+        pack->state = AssetPack_arrived;
+    } else {
+        emscripten_fetch_close(fetch);
+        if (!pack->refetched) {
+            // Whatever IndexedDB had is from an older build, so go around the
+            // cache and overwrite it.
+            pack->refetched = true;
+            AssetPackFetch(library, pack);
+            return;
+        }
+        pack->state = AssetPack_failed;
+    }
+    library->arrival_count++;
+    AssetLibraryFetchNext(library);
+}
+
+void AssetPackFetchFailed(emscripten_fetch_t *fetch) {
+    Asset_Library *library = (Asset_Library *)fetch->userData;
+    Asset_Pack    *pack    = AssetLibraryFetching(library);
+    TraceLog(LOG_WARNING, "PACK: Couldn't fetch %s (%d), loading its files instead", fetch->url, fetch->status);
+    emscripten_fetch_close(fetch);
+    pack->state = AssetPack_failed;
+    library->arrival_count++;
+    AssetLibraryFetchNext(library);
+}
+
+// NOTE: PERSIST_FILE has emscripten look in IndexedDB before going to the
+// network and store whatever it downloads there, keyed by the url. REPLACE
+// skips the lookup, which is what a stale copy needs.
+void AssetPackFetch(Asset_Library *library, Asset_Pack *pack) {
+    pack->state = AssetPack_fetching;
+
+    emscripten_fetch_attr_t attr;
+    emscripten_fetch_attr_init(&attr);
+    snprintf(attr.requestMethod, sizeof(attr.requestMethod), "GET");
+    attr.attributes = EMSCRIPTEN_FETCH_LOAD_TO_MEMORY | EMSCRIPTEN_FETCH_PERSIST_FILE;
+    if (pack->refetched) attr.attributes |= EMSCRIPTEN_FETCH_REPLACE;
+    attr.onsuccess  = AssetPackFetchSucceeded;
+    attr.onerror    = AssetPackFetchFailed;
+    attr.userData   = library;
+    emscripten_fetch(&attr, pack->path);
+}
+
+void AssetLibraryFetchNext(Asset_Library *library) {
+    for (u32 index = 0; index < library->pack_count; index++) {
+        if (library->packs[index].state == AssetPack_waiting) {
+            AssetPackFetch(library, &library->packs[index]);
+            return;
+        }
+    }
+}
+
+void AssetLibraryIndexSucceeded(emscripten_fetch_t *fetch) {
+    Asset_Library *library = (Asset_Library *)fetch->userData;
+    AssetLibraryParseIndex(library, fetch->data, (size_t)fetch->numBytes);
+    emscripten_fetch_close(fetch);
+    library->index_pending = false;
+    library->arrival_count++;
+    AssetLibraryFetchNext(library);
+}
+
+void AssetLibraryIndexFailed(emscripten_fetch_t *fetch) {
+    Asset_Library *library = (Asset_Library *)fetch->userData;
+    TraceLog(LOG_WARNING, "PACK: Couldn't fetch %s (%d), loading files instead", fetch->url, fetch->status);
+    emscripten_fetch_close(fetch);
+    library->index_pending = false;
+    library->arrival_count++;
+}
+
+// Kicks off the index download, then every pack in it in order. The index
+// itself is never cached since it's what says whether the packs are stale.
+void AssetLibraryFetch(Asset_Library *library, const char *index_url) {
+    *library               = {};
+    library->index_pending = true;
+
+    static const char *headers[] = {"Cache-Control", "no-cache", NULL};
+    emscripten_fetch_attr_t attr;
+    emscripten_fetch_attr_init(&attr);
+    snprintf(attr.requestMethod, sizeof(attr.requestMethod), "GET");
+    attr.attributes     = EMSCRIPTEN_FETCH_LOAD_TO_MEMORY;
+    attr.requestHeaders = headers;
+    attr.onsuccess      = AssetLibraryIndexSucceeded;
+    attr.onerror        = AssetLibraryIndexFailed;
+    attr.userData       = library;
+    emscripten_fetch(&attr, index_url);
+}
+
+void AssetPackClose(Asset_Pack *pack) {
+    if (pack->fetch) emscripten_fetch_close((emscripten_fetch_t *)pack->fetch);
+    *pack = {};
+}
+#elif defined(_WIN32)
+b32 AssetPackOpen(Asset_Pack *pack) {
+    void *file = CreateFileA(pack->path, PACK_GENERIC_READ, PACK_FILE_SHARE_READ, NULL,
+                             PACK_OPEN_EXISTING, PACK_FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == PACK_INVALID_HANDLE) return false;
+
+    long long size = 0;
+    void *mapping  = NULL;
+    void *view     = NULL;
+    if (GetFileSizeEx(file, &size) && size > 0) {
+        mapping = CreateFileMappingA(file, NULL, PACK_PAGE_READONLY, 0, 0, NULL);
+    }
+    if (mapping) view = MapViewOfFile(mapping, PACK_FILE_MAP_READ, 0, 0, 0);
+
+    if (!view || !AssetPackOpenMemory(pack, (u8 *)view, (size_t)size)) {
+        if (view)    UnmapViewOfFile(view);
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    pack->file    = file;
+    pack->mapping = mapping;
+    return true;
+}
+
+void AssetPackClose(Asset_Pack *pack) {
+    if (pack->base) {
+        UnmapViewOfFile(pack->base);
+        CloseHandle(pack->mapping);
+        CloseHandle(pack->file);
+    }
+    *pack = {};
+}
+#else
+b32 AssetPackOpen(Asset_Pack *pack) {
+    s32 file = open(pack->path, O_RDONLY);
+    if (file < 0) return false;
+
+    struct stat info;
+    void *view = MAP_FAILED;
+    if (fstat(file, &info) == 0 && info.st_size > 0) {
+        view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    // NOTE: The mapping keeps the file alive on its own.
+    close(file);
+
+    if (view == MAP_FAILED) return false;
+    if (!AssetPackOpenMemory(pack, (u8 *)view, (size_t)info.st_size)) {
+        munmap(view, (size_t)info.st_size);
+        return false;
+    }
+    return true;
+}
+
+void AssetPackClose(Asset_Pack *pack) {
+    if (pack->base) munmap(pack->base, pack->size);
+    *pack = {};
+}
+#endif
+
+#if !defined(PLATFORM_WEB)
+// Maps every pack in the index. No index is fine, everything just gets
+// loaded from the assets folder.
+b32 AssetLibraryOpen(Asset_Library *library, const char *index_path) {
+    *library = {};
+    if (!FileExists(index_path)) return false;
+
+    char *text = LoadFileText(index_path);
+    if (!text) return false;
+    AssetLibraryParseIndex(library, text, TextLength(text));
+    UnloadFileText(text);
+
+    for (u32 index = 0; index < library->pack_count; index++) {
+        Asset_Pack *pack = &library->packs[index];
+        pack->state      = AssetPackOpen(pack) ? AssetPack_arrived : AssetPack_failed;
+        library->arrival_count++;
+    }
+    return true;
+}
+#endif
+
+void AssetLibraryClose(Asset_Library *library) {
+    for (u32 index = 0; index < library->pack_count; index++) {
+        AssetPackClose(&library->packs[index]);
+    }
+    *library = {};
+}
+
+// True while there's a pack that could still turn up with more assets in it.
+b32 AssetLibraryPending(Asset_Library *library) {
+    if (library->index_pending) return true;
+    for (u32 index = 0; index < library->pack_count; index++) {
+        if (library->packs[index].state < AssetPack_arrived) return true;
+    }
+    return false;
+}
+
+// The first group in the index is what the title screen needs, the game
+// can start once that one's in and the rest can follow.
+b32 AssetLibraryFirstGroupPending(Asset_Library *library) {
+    b32 result = library->index_pending ||
+                 (library->pack_count > 0 && library->packs[0].state < AssetPack_arrived);
+    return result;
+}
+
+// Returns NULL when the pack isn't loaded or doesn't have the path.
+Asset_Pack_Entry *AssetPackFind(Asset_Pack *pack, const char *path, Asset_Kind kind) {
+    u32 hash = HashString(path);
+    for (u32 index = 0; index < pack->entry_count; index++) {
+        Asset_Pack_Entry *entry = &pack->entries[index];
+        if (entry->hash == hash && entry->kind == (u32)kind && TextIsEqual(entry->path, path)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+void *AssetPackData(Asset_Pack *pack, Asset_Pack_Entry *entry) {
+    void *result = pack->base + entry->offset;
+    return result;
+}
+
+// Looks through every pack that's in so far and hands back where the
+// asset's data is. Returns NULL when none of them have it, the caller is
+// expected to go to the file on disk in that case, unless the library is
+// still pending and it can wait.
+Asset_Pack_Entry *AssetLibraryFind(Asset_Library *library, const char *path, Asset_Kind kind, void **data) {
+    for (u32 index = 0; index < library->pack_count; index++) {
+        Asset_Pack       *pack  = &library->packs[index];
+        Asset_Pack_Entry *entry = AssetPackFind(pack, path, kind);
+        if (entry) {
+            if (data) *data = AssetPackData(pack, entry);
+            return entry;
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,211 @@
+// NOTE: Offline sprite atlas packer. Reads the list of images in
+// assets/atlas_manifest.txt, packs them all into assets/atlas.png and
+// writes include/atlas_regions.h with where each one ended up. The game
+// looks sprites up in that table by the same path it used to load them
+// with, so nothing that calls TextureAcquire() has to know about it.
+// See build_atlas.bat, it runs from the build folder like everything else.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include "types.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#include "stb_image.h"
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "stb_rect_pack.h"
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+#define ATLAS_MANIFEST_PATH "../assets/atlas_manifest.txt"
+#define ATLAS_IMAGE_PATH    "../assets/atlas.png"
+#define ATLAS_HEADER_PATH   "../include/atlas_regions.h"
+#define ATLAS_MAX_WIDTH     2048
+#define ATLAS_MAX_HEIGHT    2048
+#define ATLAS_MAX_SPRITES   256
+#define ATLAS_PATH_MAX      256
+// Gap left around every sprite. The edge pixels get copied out into it
+// so sampling right on the border never picks up the neighbour.
+#define ATLAS_PADDING       2
+
+struct Packed_Sprite {
+    char path[ATLAS_PATH_MAX];
+    char name[64];
+    u8  *pixels;
+    s32  width;
+    s32  height;
+    s32  x;
+    s32  y;
+};
+
+static Packed_Sprite g_sprites[ATLAS_MAX_SPRITES];
+static u32           g_sprite_count;
+
+// The file name without the folder or the extension,
+// "../assets/sprites/hat_up.png" becomes "hat_up".
+void SpriteNameFromPath(char *name, u32 name_max, const char *path) {
+    const char *start = path;
+    for (const char *at = path; *at; at++) {
+        if (*at == '/' || *at == '\\') start = at + 1;
+    }
+    u32 length = 0;
+    for (const char *at = start; *at && *at != '.' && length < name_max - 1; at++) {
+        name[length++] = isalnum((u8)*at) ? (char)tolower((u8)*at) : '_';
+    }
+    name[length] = 0;
+}
+
+b32 LoadManifest(const char *manifest_path) {
+    FILE *file = fopen(manifest_path, "r");
+    if (!file) {
+        fprintf(stderr, "error: can't open %s\n", manifest_path);
+        return false;
+    }
+
+    char line[ATLAS_PATH_MAX];
+    while (fgets(line, sizeof(line), file)) {
+        // Comments start with # and blank lines are skipped.
+        char *at = line;
+        while (*at == ' ' || *at == '\t') at++;
+        u32 length = (u32)strlen(at);
+        while (length && (at[length - 1] == '\n' || at[length - 1] == '\r' || at[length - 1] == ' ')) {
+            at[--length] = 0;
+        }
+        if (length == 0 || at[0] == '#') continue;
+
+        if (g_sprite_count == ATLAS_MAX_SPRITES) {
+            fprintf(stderr, "error: more than %d sprites in the manifest\n", ATLAS_MAX_SPRITES);
+            fclose(file);
+            return false;
+        }
+
+        Packed_Sprite *sprite = &g_sprites[g_sprite_count];
+        s32 channels;
+        sprite->pixels = stbi_load(at, &sprite->width, &sprite->height, &channels, 4);
+        if (!sprite->pixels) {
+            // NOTE: Missing sprites just fall back to being loaded on
+            // their own at runtime, so this isn't fatal.
+            fprintf(stderr, "warning: skipping %s (%s)\n", at, stbi_failure_reason());
+            continue;
+        }
+        snprintf(sprite->path, ATLAS_PATH_MAX, "%s", at);
+        SpriteNameFromPath(sprite->name, sizeof(sprite->name), at);
+        g_sprite_count++;
+    }
+
+    fclose(file);
+    return true;
+}
+
+// Packs everything into the narrowest power of two width it'll fit in
+// and hands back the height that actually got used.
+b32 PackSprites(s32 *atlas_width, s32 *atlas_height) {
+    static stbrp_rect  rects[ATLAS_MAX_SPRITES];
+    static stbrp_node  nodes[ATLAS_MAX_WIDTH];
+
+    for (s32 width = 256; width <= ATLAS_MAX_WIDTH; width *= 2) {
+        for (u32 index = 0; index < g_sprite_count; index++) {
+            rects[index]    = {};
+            rects[index].id = (s32)index;
+            rects[index].w  = g_sprites[index].width  + 2*ATLAS_PADDING;
+            rects[index].h  = g_sprites[index].height + 2*ATLAS_PADDING;
+        }
+
+        stbrp_context context;
+        stbrp_init_target(&context, width, ATLAS_MAX_HEIGHT, nodes, ATLAS_MAX_WIDTH);
+        // NOTE: Sorting by height and then taking the first one that
+        // fits every time packs strips of frames pretty tightly.
+        stbrp_setup_heuristic(&context, STBRP_HEURISTIC_Skyline_BF_sortHeight);
+        if (!stbrp_pack_rects(&context, rects, (s32)g_sprite_count)) continue;
+
+        s32 height = 0;
+        for (u32 index = 0; index < g_sprite_count; index++) {
+            Packed_Sprite *sprite = &g_sprites[rects[index].id];
+            sprite->x = rects[index].x + ATLAS_PADDING;
+            sprite->y = rects[index].y + ATLAS_PADDING;
+            if (rects[index].y + rects[index].h > height) height = rects[index].y + rects[index].h;
+        }
+        // Keep it a multiple of 4 so the GPU doesn't have to deal with
+        // odd row alignments.
+        *atlas_width  = width;
+        *atlas_height = (height + 3) & ~3;
+        return true;
+    }
+    return false;
+}
+
+void BlitSprite(u8 *atlas, s32 atlas_width, Packed_Sprite *sprite) {
+    for (s32 y = -ATLAS_PADDING; y < sprite->height + ATLAS_PADDING; y++) {
+        s32 source_y = CLAMP(y, 0, sprite->height - 1);
+        for (s32 x = -ATLAS_PADDING; x < sprite->width + ATLAS_PADDING; x++) {
+            s32 source_x = CLAMP(x, 0, sprite->width - 1);
+            u8 *source   = sprite->pixels + 4*(source_y*sprite->width + source_x);
+            u8 *dest     = atlas + 4*((sprite->y + y)*atlas_width + sprite->x + x);
+            memcpy(dest, source, 4);
+        }
+    }
+}
+
+b32 WriteHeader(const char *header_path, s32 atlas_width, s32 atlas_height) {
+    FILE *file = fopen(header_path, "w");
+    if (!file) {
+        fprintf(stderr, "error: can't write %s\n", header_path);
+        return false;
+    }
+
+    fprintf(file, "// NOTE: Generated by atlas_packer.cpp from assets/atlas_manifest.txt, don't\n");
+    fprintf(file, "// edit this by hand. Run build_atlas.bat after changing any of the sprites.\n\n");
+    fprintf(file, "#define ATLAS_PATH   \"%s\"\n", ATLAS_IMAGE_PATH);
+    fprintf(file, "#define ATLAS_WIDTH  %d\n", atlas_width);
+    fprintf(file, "#define ATLAS_HEIGHT %d\n\n", atlas_height);
+
+    fprintf(file, "enum Atlas_Region_Id {\n");
+    for (u32 index = 0; index < g_sprite_count; index++) {
+        fprintf(file, "    AtlasRegion_%s,\n", g_sprites[index].name);
+    }
+    fprintf(file, "    AtlasRegion_count,\n");
+    fprintf(file, "};\n\n");
+
+    fprintf(file, "static const Atlas_Region g_atlas_regions[AtlasRegion_count] = {\n");
+    for (u32 index = 0; index < g_sprite_count; index++) {
+        Packed_Sprite *sprite = &g_sprites[index];
+        fprintf(file, "    {\"%s\", {%d, %d, %d, %d}},\n", sprite->path,
+                sprite->x, sprite->y, sprite->width, sprite->height);
+    }
+    fprintf(file, "};\n");
+
+    fclose(file);
+    return true;
+}
+
+int main() {
+    if (!LoadManifest(ATLAS_MANIFEST_PATH)) return 1;
+    if (g_sprite_count == 0) {
+        fprintf(stderr, "error: nothing to pack\n");
+        return 1;
+    }
+
+    s32 atlas_width, atlas_height;
+    if (!PackSprites(&atlas_width, &atlas_height)) {
+        fprintf(stderr, "error: sprites don't fit in %dx%d\n", ATLAS_MAX_WIDTH, ATLAS_MAX_HEIGHT);
+        return 1;
+    }
+
+    u8 *atlas = (u8 *)calloc((size_t)atlas_width*atlas_height, 4);
+    for (u32 index = 0; index < g_sprite_count; index++) {
+        BlitSprite(atlas, atlas_width, &g_sprites[index]);
+        stbi_image_free(g_sprites[index].pixels);
+    }
+
+    if (!stbi_write_png(ATLAS_IMAGE_PATH, atlas_width, atlas_height, 4, atlas, atlas_width*4)) {
+        fprintf(stderr, "error: can't write %s\n", ATLAS_IMAGE_PATH);
+        return 1;
+    }
+    if (!WriteHeader(ATLAS_HEADER_PATH, atlas_width, atlas_height)) return 1;
+
+    printf("packed %u sprites into %dx%d\n", g_sprite_count, atlas_width, atlas_height);
+    free(atlas);
+    return 0;
+}
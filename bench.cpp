@@ -0,0 +1,624 @@
+// NOTE: Headless benchmarks for the gameplay hot paths. This builds the same
+// way the game does, one translation unit that pulls garden.cpp in, but it
+// never opens a window so the numbers are just the gameplay code. See
+// build_bench.bat, or build_bench.sh on Linux which doesn't need X11 or GL.
+//
+// Each benchmark is swept over map size, how much of the floor is on fire
+// and how many enemies there are. What gets reported is the fastest of a few
+// runs in ns per call, along with a checksum of what the calls came back
+// with so something that got faster by getting wrong shows up as well.
+//
+//   bench                          runs all of them and prints a table
+//   bench -filter Enemy            only the ones with that in their name
+//   bench -json out.json           writes the results out too
+//   bench -compare base.json       compares against an earlier -json run and
+//         [-threshold 10]          fails if anything is more than threshold
+//                                  percent slower or its checksum changed
+//
+// Baselines only mean anything from the same machine and the same build.
+//
+// "bench -music song.wav song.qoa ..." streams each song instead and
+// reports what it costs per frame and how much memory it keeps resident.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+
+// NOTE: The draw code only lives in garden.cpp so the bench takes all of
+// it, just not its main.
+#define GARDEN_NO_MAIN
+#include "garden.cpp"
+
+f64 BenchNow() {
+    using namespace std::chrono;
+    f64 result = duration<f64>(steady_clock::now().time_since_epoch()).count();
+    return result;
+}
+
+#define BENCH_SEED         1234
+// Its own Random_Series stream for setting the worlds up and the walk, so
+// they don't shift when the game's own streams get used differently.
+#define BENCH_STREAM       0xBE
+#define BENCH_REPEATS      5
+#define BENCH_MAX_RESULTS  512
+#define BENCH_NAME_MAX     96
+#define BENCH_TEXTURE      1
+// Roughly how many tiles a run gets to touch, the per call count comes out
+// of this so the big maps don't take all day. See BenchIterations().
+#define BENCH_TILE_WORK    (1u << 22)
+
+struct Bench_World {
+    Memory_Arena  arena;
+    Tilemap       map;
+    Player        player;
+    Game_Manager  manager;
+    Game_Sim      sim;
+    Tile_Cache    cache;
+    Camera2D      camera;
+    u32           center;
+
+    // Every floor tile, for the benchmarks that go tile by tile.
+    u32          *floor_tiles;
+    u32           floor_count;
+};
+
+struct Bench_Result {
+    char name[BENCH_NAME_MAX];
+    f64  ns_per_call;
+    u32  calls;
+    u32  checksum;
+};
+
+struct Bench_Suite {
+    Bench_Result results[BENCH_MAX_RESULTS];
+    u32          count;
+    const char  *filter;
+};
+
+// Makes that many calls and hands back a checksum of what they returned.
+typedef u32 Bench_Calls(Bench_World *world, u32 call_count);
+
+inline u32 BenchHash(u32 checksum, u32 value) {
+    u32 result = (checksum ^ value) * 16777619u;
+    return result;
+}
+
+// A size by size walled in arena with room for all the entities it could
+// ever need.
+void BenchWorldInit(Bench_World *world, u32 size) {
+    u32 tile_count = size*size;
+    ArenaInit(&world->arena, MB(1) + TilemapMemorySize(size, size) + tile_count*sizeof(u32));
+
+    Tilemap *map   = &world->map;
+    *map           = {};
+    map->tile_size = TILE_SIZE;
+    TilemapAlloc(map, &world->arena, size, size);
+    TilemapGenerateArena(map);
+    EnclosureTrackerInit(&map->enclosure, &world->arena, tile_count);
+    map->random    = RandomSeed(BENCH_SEED, RandomStream_tiles);
+
+    Game_Manager *manager            = &world->manager;
+    *manager                         = {};
+    manager->enemy_sentinel.next     = &manager->enemy_sentinel;
+    manager->enemy_sentinel.prev     = &manager->enemy_sentinel;
+    manager->powerup_sentinel.next   = &manager->powerup_sentinel;
+    manager->powerup_sentinel.prev   = &manager->powerup_sentinel;
+    PoolInit(&manager->enemy_pool,   &world->arena, sizeof(Enemy),   tile_count);
+    PoolInit(&manager->powerup_pool, &world->arena, sizeof(Powerup), tile_count);
+
+    // NOTE: Everything draws out of the stand-in texture main() registers,
+    // the animations just need some frames to step through.
+    Animation animation         = {{BENCH_TEXTURE}, 4, 0, {0, 0, TILE_SIZE, TILE_SIZE}, true};
+    manager->atlas[Atlas_tile]  = {BENCH_TEXTURE};
+    manager->atlas[Atlas_wall]  = {BENCH_TEXTURE};
+    manager->powerup_animator   = animation;
+    manager->anim_steps         = 1;
+    map->fire_animation         = animation;
+    for (u32 index = 0; index < EnemyAnimator_count; index++) {
+        manager->enemy_animators[index] = animation;
+    }
+
+    TileInit(map);
+    PlayerInit(&world->player);
+
+    // The player and the camera go in the middle of the map.
+    u32 middle               = size / 2;
+    world->center            = TilemapIndex(middle, middle, size);
+    world->player.pos        = {(f32)(middle*TILE_SIZE), (f32)(middle*TILE_SIZE)};
+    world->camera            = {};
+    world->camera.zoom       = 1.0f;
+    world->camera.target.x   = fmaxf(0.0f, world->player.pos.x - base_screen_width*0.5f);
+    world->camera.target.y   = fmaxf(0.0f, world->player.pos.y - base_screen_height*0.5f);
+    world->cache             = {};
+    world->cache.walls_baked = true;
+
+    world->floor_tiles = (u32 *)ArenaAlloc(&world->arena, tile_count*sizeof(u32));
+    world->floor_count = 0;
+    for (u32 index = 0; index < tile_count; index++) {
+        if (GetTileType(GetTile(map, index)) == TileType_floor) world->floor_tiles[world->floor_count++] = index;
+    }
+
+    world->sim         = {};
+    world->sim.arena   = &world->arena;
+    world->sim.map     = map;
+    world->sim.player  = &world->player;
+    world->sim.manager = manager;
+    world->sim.random  = RandomSeed(BENCH_SEED, RandomStream_gameplay);
+    world->sim.effects = RandomSeed(BENCH_SEED, RandomStream_effects);
+}
+
+void BenchWorldFree(Bench_World *world) {
+    ArenaFree(&world->arena);
+    free(world);
+}
+
+// Sets about fire_percent of the floor alight and drops the enemies on
+// random empty tiles, with a powerup for every eight of them which is about
+// what a game has lying around. The player's tile is always left alone.
+void BenchWorldPopulate(Bench_World *world, u32 fire_percent, u32 enemy_count) {
+    Tilemap       *map     = &world->map;
+    Game_Manager  *manager = &world->manager;
+    Random_Series  random  = RandomSeed(BENCH_SEED, BENCH_STREAM);
+
+    for (u32 floor = 0; floor < world->floor_count; floor++) {
+        u32 index = world->floor_tiles[floor];
+        if (index != world->center && (u32)RandomRange(&random, 0, 99) < fire_percent) {
+            AddFlag(GetTile(map, index), TileFlag_fire);
+        }
+    }
+
+    u32 powerup_count = enemy_count / 8;
+    u32 placed        = 0;
+    u32 attempt_count = world->floor_count*4;
+    for (u32 attempt = 0; attempt < attempt_count && placed < enemy_count + powerup_count; attempt++) {
+        u32  index = world->floor_tiles[RandomRange(&random, 0, world->floor_count - 1)];
+        Tile tile  = GetTile(map, index);
+        if (index == world->center || GetTileFlags(tile)) continue;
+
+        Pool_Handle handle;
+        if (placed < enemy_count) {
+            Enemy *enemy = (Enemy *)PoolAlloc(&manager->enemy_pool, &handle);
+            AddFlag(tile, TileFlag_enemy);
+            EnemyInit(enemy, &manager->enemy_sentinel, index, manager->enemy_animators);
+            map->enemy_slots[index] = handle;
+        } else {
+            Powerup *powerup = (Powerup *)PoolAlloc(&manager->powerup_pool, &handle);
+            AddFlag(tile, TileFlag_powerup);
+            PowerupInit(powerup, &manager->powerup_sentinel, index, &manager->powerup_animator);
+            map->powerup_slots[index] = handle;
+        }
+        placed++;
+    }
+    map->enclosure.needs_full_check = true;
+}
+
+// Random walk that leaves fire behind it the way the player does, running the
+// enclosure check every time it lands on a tile. When it boxes itself in the
+// map gets reset. The walk only depends on the seed and the map so both modes
+// see exactly the same steps.
+f64 BenchEnclosure(u32 size, u32 step_count, b32 force_full, u32 *checksum) {
+    Bench_World *world = (Bench_World *)calloc(1, sizeof(Bench_World));
+    BenchWorldInit(world, size);
+    Tilemap *map = &world->map;
+
+    Random_Series random = RandomSeed(BENCH_SEED, BENCH_STREAM);
+    s32 x = size / 2, y = size / 2;
+    s32 offset_x[4] = {1,-1, 0, 0};
+    s32 offset_y[4] = {0, 0, 1,-1};
+    *checksum = 2166136261u;
+
+    f64 elapsed = 0;
+    for (u32 step = 0; step < step_count; step++) {
+        u32 dir = (u32)RandomRange(&random, 0, 3);
+        s32 next_x = x, next_y = y;
+        for (u32 attempt = 0; attempt < 4; attempt++) {
+            u32 try_dir = (dir + attempt) % 4;
+            if (IsOpenTile(map, x + offset_x[try_dir], y + offset_y[try_dir])) {
+                next_x = x + offset_x[try_dir];
+                next_y = y + offset_y[try_dir];
+                break;
+            }
+        }
+        if (next_x == x && next_y == y) {
+            TileInit(map);
+            x = size / 2, y = size / 2;
+            continue;
+        }
+
+        u32 index = TilemapIndex(x, y, map->width);
+        AddFlag(GetTile(map, index), TileFlag_fire);
+        EnclosureMarkFire(map, index);
+        x = next_x, y = next_y;
+
+        if (force_full) map->enclosure.needs_full_check = true;
+
+        f64 start = BenchNow();
+        FillEnclosedAreas(&world->sim, x, y);
+        elapsed  += BenchNow() - start;
+
+        *checksum = BenchHash(BenchHash(*checksum, map->enclosure.pending_count), (u32)world->player.speed);
+    }
+
+    // Both modes have to end up burning exactly the same tiles.
+    for (u32 index = 0; index < size*size; index++) {
+        *checksum = BenchHash(*checksum, GetTileFlags(GetTile(map, index)));
+    }
+
+    BenchWorldFree(world);
+    return elapsed;
+}
+
+u32 BenchCheckEnclosedAreas(Bench_World *world, u32 call_count) {
+    Tilemap *map      = &world->map;
+    u32      checksum = 2166136261u;
+    for (u32 call = 0; call < call_count; call++) {
+        CheckEnclosedAreasFromPlayerPosition(map, map->width / 2, map->height / 2);
+    }
+    checksum = BenchHash(checksum, CountTilesWithFlag(map, TilePlane_visited));
+    return checksum;
+}
+
+// The whole reset, most of which is drawing the tile seeds.
+u32 BenchTileInit(Bench_World *world, u32 call_count) {
+    u32 checksum = 2166136261u;
+    for (u32 call = 0; call < call_count; call++) {
+        TileInit(&world->map);
+        Tile tile = GetTile(&world->map, world->floor_tiles[call % world->floor_count]);
+        checksum  = BenchHash(checksum, tile.chunk->seeds[tile.slot]);
+    }
+    return checksum;
+}
+
+u32 BenchGetRandomEmptyTile(Bench_World *world, u32 call_count) {
+    u32 checksum = 2166136261u;
+    for (u32 call = 0; call < call_count; call++) {
+        checksum = BenchHash(checksum, GetRandomEmptyTileIndex(&world->map, &world->sim.random));
+    }
+    return checksum;
+}
+
+u32 BenchGetRandomEmptyTileAwayFrom(Bench_World *world, u32 call_count) {
+    u32 checksum = 2166136261u;
+    for (u32 call = 0; call < call_count; call++) {
+        checksum = BenchHash(checksum, GetRandomEmptyTileIndex(&world->map, world->center, &world->sim.random));
+    }
+    return checksum;
+}
+
+u32 BenchFindEnemyMove(Bench_World *world, u32 call_count) {
+    u32 checksum = 2166136261u;
+    for (u32 call = 0; call < call_count; call++) {
+        u32 index = world->floor_tiles[call % world->floor_count];
+        checksum  = BenchHash(checksum, FindEligibleTileIndexForEnemyMove(&world->map, index, &world->sim.random));
+    }
+    return checksum;
+}
+
+// Just the movement half of the enemy update, the spawn timer never runs
+// out and the move timer always has.
+u32 BenchEnemyMovePass(Bench_World *world, u32 call_count) {
+    Game_Manager *manager = &world->manager;
+    u32           checksum = 2166136261u;
+    for (u32 call = 0; call < call_count; call++) {
+        manager->spawn_timer      = 1e9f;
+        manager->enemy_move_timer = 0;
+        SimUpdateEnemies(&world->sim, 1.0f / 60.0f);
+    }
+    for (Enemy *enemy = manager->enemy_sentinel.next; enemy != &manager->enemy_sentinel; enemy = enemy->next) {
+        checksum = BenchHash(checksum, enemy->tile_index);
+    }
+    return checksum;
+}
+
+// The commands for one frame of whatever's on top of the tiles. The queue
+// gets emptied rather than flushed so nothing ever goes near GL.
+u32 BenchPushTileContents(Bench_World *world, u32 call_count) {
+    Render_Queue *queue    = &g_render_queue;
+    u32           checksum = 2166136261u;
+    for (u32 call = 0; call < call_count; call++) {
+        RenderQueueBegin(queue, world->camera);
+        PushTileContents(queue, &world->cache, &world->map, &world->manager, &world->player, 0.5f);
+        checksum = BenchHash(checksum, queue->count);
+    }
+    return checksum;
+}
+
+// Enough calls that a run touches about BENCH_TILE_WORK tiles, within reason
+// for the calls that only look at a handful.
+u32 BenchIterations(u32 tiles_per_call) {
+    u32 result = BENCH_TILE_WORK / (tiles_per_call ? tiles_per_call : 1);
+    result     = CLAMP(result, 4u, 1u << 18);
+    return result;
+}
+
+b32 BenchWanted(Bench_Suite *suite, const char *name) {
+    b32 result = !suite->filter || strstr(name, suite->filter);
+    return result;
+}
+
+Bench_Result *BenchAddResult(Bench_Suite *suite, const char *name, f64 ns_per_call, u32 calls, u32 checksum) {
+    ASSERT(suite->count < BENCH_MAX_RESULTS);
+    Bench_Result *result = &suite->results[suite->count++];
+    snprintf(result->name, BENCH_NAME_MAX, "%s", name);
+    result->ns_per_call  = ns_per_call;
+    result->calls        = calls;
+    result->checksum     = checksum;
+    printf("%-64s %14.1f %10u %08x\n", result->name, ns_per_call, calls, checksum);
+    fflush(stdout);
+    return result;
+}
+
+// Builds a fresh world for each run so the ones that move things around all
+// start from the same place, and keeps the fastest run. Every run has to
+// come out with the same checksum, the last one is what gets reported.
+void BenchRun(Bench_Suite *suite, const char *name, Bench_Calls *calls, u32 size,
+              u32 fire_percent, u32 enemy_count, u32 call_count) {
+    if (!BenchWanted(suite, name)) return;
+
+    f64 best     = 0;
+    u32 checksum = 0;
+    for (u32 repeat = 0; repeat < BENCH_REPEATS; repeat++) {
+        Bench_World *world = (Bench_World *)calloc(1, sizeof(Bench_World));
+        BenchWorldInit(world, size);
+        BenchWorldPopulate(world, fire_percent, enemy_count);
+
+        f64 start    = BenchNow();
+        u32 result   = calls(world, call_count);
+        f64 elapsed  = BenchNow() - start;
+        if (repeat == 0 || elapsed < best) best = elapsed;
+        if (repeat > 0 && result != checksum) printf("%s: runs disagree, it isn't deterministic\n", name);
+        checksum     = result;
+        BenchWorldFree(world);
+    }
+    BenchAddResult(suite, name, best / call_count*1e9, call_count, checksum);
+}
+
+void BenchRunAll(Bench_Suite *suite) {
+    u32 sizes[]         = {16, 64, 256, 1024};
+    u32 fire_percents[] = {0, 10, 30};
+    u32 enemy_counts[]  = {0, 64, 1024};
+    char name[BENCH_NAME_MAX];
+
+    // The full flood fill touches every tile on every step so the bigger
+    // maps get fewer steps to keep the run time sane.
+    u32 step_counts[] = {20000, 20000, 2000, 200};
+    for (u32 size_index = 0; size_index < ARRAY_COUNT(sizes); size_index++) {
+        u32 size       = sizes[size_index];
+        u32 step_count = step_counts[size_index];
+        for (u32 mode = 0; mode < 2; mode++) {
+            b32 force_full = mode == 0;
+            snprintf(name, sizeof(name), "FillEnclosedAreas/walk/%s/size=%u", force_full ? "full" : "incremental", size);
+            if (!BenchWanted(suite, name)) continue;
+            u32 checksum = 0;
+            f64 elapsed  = BenchEnclosure(size, step_count, force_full, &checksum);
+            BenchAddResult(suite, name, elapsed / step_count*1e9, step_count, checksum);
+        }
+    }
+
+    for (u32 size_index = 0; size_index < ARRAY_COUNT(sizes); size_index++) {
+        u32 size       = sizes[size_index];
+        u32 tile_count = size*size;
+        snprintf(name, sizeof(name), "TileInit/size=%u", size);
+        BenchRun(suite, name, BenchTileInit, size, 0, 0, BenchIterations(tile_count));
+
+        for (u32 fire_index = 0; fire_index < ARRAY_COUNT(fire_percents); fire_index++) {
+            u32 fire = fire_percents[fire_index];
+            snprintf(name, sizeof(name), "CheckEnclosedAreasFromPlayerPosition/size=%u/fire=%u", size, fire);
+            BenchRun(suite, name, BenchCheckEnclosedAreas, size, fire, 0, BenchIterations(tile_count*8));
+
+            for (u32 enemy_index = 0; enemy_index < ARRAY_COUNT(enemy_counts); enemy_index++) {
+                // NOTE: The small maps can't fit the big crowds.
+                u32 enemies = enemy_counts[enemy_index];
+                if (enemies > tile_count / 4) continue;
+
+                snprintf(name, sizeof(name), "GetRandomEmptyTileIndex/size=%u/fire=%u/enemies=%u", size, fire, enemies);
+                BenchRun(suite, name, BenchGetRandomEmptyTile, size, fire, enemies, BenchIterations(tile_count));
+                snprintf(name, sizeof(name), "GetRandomEmptyTileIndex/away/size=%u/fire=%u/enemies=%u", size, fire, enemies);
+                BenchRun(suite, name, BenchGetRandomEmptyTileAwayFrom, size, fire, enemies, BenchIterations(tile_count));
+                snprintf(name, sizeof(name), "FindEligibleTileIndexForEnemyMove/size=%u/fire=%u/enemies=%u", size, fire, enemies);
+                BenchRun(suite, name, BenchFindEnemyMove, size, fire, enemies, BenchIterations(4));
+                if (enemies) {
+                    snprintf(name, sizeof(name), "SimUpdateEnemies/move/size=%u/fire=%u/enemies=%u", size, fire, enemies);
+                    BenchRun(suite, name, BenchEnemyMovePass, size, fire, enemies, BenchIterations(enemies*4));
+                }
+                snprintf(name, sizeof(name), "PushTileContents/size=%u/fire=%u/enemies=%u", size, fire, enemies);
+                BenchRun(suite, name, BenchPushTileContents, size, fire, enemies, BenchIterations(1024));
+            }
+        }
+    }
+}
+
+// One result per line so the compare can read it back without a parser.
+b32 BenchWriteJson(Bench_Suite *suite, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) return false;
+    fprintf(file, "{\n  \"bitplanes\": \"%s\",\n  \"results\": [\n", BITPLANE_PATH);
+    for (u32 index = 0; index < suite->count; index++) {
+        Bench_Result *result = &suite->results[index];
+        fprintf(file, "    {\"name\": \"%s\", \"ns_per_call\": %.3f, \"calls\": %u, \"checksum\": %u}%s\n",
+                result->name, result->ns_per_call, result->calls, result->checksum,
+                index + 1 < suite->count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return true;
+}
+
+// Reads back what BenchWriteJson() wrote, not JSON in general.
+b32 BenchReadJson(Bench_Suite *suite, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) return false;
+    char line[512];
+    while (fgets(line, sizeof(line), file) && suite->count < BENCH_MAX_RESULTS) {
+        char *name = strstr(line, "\"name\": \"");
+        if (!name) continue;
+        name += strlen("\"name\": \"");
+        char *name_end = strchr(name, '"');
+        if (!name_end) continue;
+        *name_end = 0;
+
+        Bench_Result *result = &suite->results[suite->count];
+        *result              = {};
+        snprintf(result->name, BENCH_NAME_MAX, "%s", name);
+        if (sscanf(name_end + 1, ", \"ns_per_call\": %lf, \"calls\": %u, \"checksum\": %u",
+                   &result->ns_per_call, &result->calls, &result->checksum) == 3) {
+            suite->count++;
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+// Returns how many got slower by more than the threshold or changed their
+// checksum. Anything only one side has is listed but doesn't count.
+u32 BenchCompare(Bench_Suite *suite, Bench_Suite *baseline, f64 threshold_percent) {
+    u32 regressions = 0;
+    printf("\n%-64s %12s %12s %8s\n", "compared to the baseline", "base ns", "now ns", "change");
+    for (u32 index = 0; index < suite->count; index++) {
+        Bench_Result *result = &suite->results[index];
+        Bench_Result *base   = NULL;
+        for (u32 base_index = 0; base_index < baseline->count; base_index++) {
+            if (TextIsEqual(baseline->results[base_index].name, result->name)) {
+                base = &baseline->results[base_index];
+                break;
+            }
+        }
+        if (!base) {
+            printf("%-64s %12s %12.1f %8s\n", result->name, "-", result->ns_per_call, "new");
+            continue;
+        }
+
+        f64         change = (result->ns_per_call / base->ns_per_call - 1.0)*100.0;
+        const char *note   = "";
+        if (base->calls == result->calls && base->checksum != result->checksum) {
+            note = "  CHECKSUM CHANGED";
+            regressions++;
+        } else if (change > threshold_percent) {
+            note = "  SLOWER";
+            regressions++;
+        }
+        printf("%-64s %12.1f %12.1f %+7.1f%%%s\n", result->name, base->ns_per_call, result->ns_per_call, change, note);
+    }
+    for (u32 base_index = 0; base_index < baseline->count; base_index++) {
+        Bench_Result *base  = &baseline->results[base_index];
+        b32           found = false;
+        for (u32 index = 0; index < suite->count && !found; index++) {
+            found = TextIsEqual(suite->results[index].name, base->name);
+        }
+        if (!found && BenchWanted(suite, base->name)) {
+            printf("%-64s %12.1f %12s %8s\n", base->name, base->ns_per_call, "-", "gone");
+        }
+    }
+    printf("%u regression%s over %.1f%%\n", regressions, regressions == 1 ? "" : "s", threshold_percent);
+    return regressions;
+}
+
+// Streams the song the same way the game does when it isn't in the pack,
+// the whole file read into memory and UpdateMusicStream() once a 60 Hz
+// frame, and times just that call. The refills only come every few frames
+// so the worst frame matters as much as the average.
+void BenchMusic(const char *path, f64 seconds) {
+    u64 resident_before = ProfilerResidentBytes();
+    s32 file_size       = 0;
+    u8 *file_data       = LoadFileData(path, &file_size);
+    Music music         = {};
+    if (file_data) music = LoadMusicStreamFromMemory(GetFileExtension(path), file_data, file_size);
+    if (!IsMusicReady(music)) {
+        printf("%-40s can't stream it\n", path);
+        if (file_data) UnloadFileData(file_data);
+        return;
+    }
+    music.looping = true;
+    SetMusicVolume(music, 0.0f);
+    PlayMusicStream(music);
+
+    u32 frame_count = (u32)(seconds*60.0);
+    f64 total       = 0;
+    f64 worst       = 0;
+    for (u32 frame = 0; frame < frame_count; frame++) {
+        f64 start   = BenchNow();
+        UpdateMusicStream(music);
+        f64 elapsed = BenchNow() - start;
+        total      += elapsed;
+        if (elapsed > worst) worst = elapsed;
+        std::this_thread::sleep_for(std::chrono::microseconds(16667));
+    }
+    u64 resident_after = ProfilerResidentBytes();
+
+    printf("%-40s %9.2f %12.1f %12.1f %12.2f\n", path, file_size / (1024.0*1024.0),
+           total / frame_count * 1e6, worst * 1e6,
+           (f64)(s64)(resident_after - resident_before) / (1024.0*1024.0));
+
+    StopMusicStream(music);
+    UnloadMusicStream(music);
+    UnloadFileData(file_data);
+}
+
+int BenchMusicMain(s32 path_count, char **paths) {
+    SetTraceLogLevel(LOG_WARNING);
+    InitAudioDevice();
+    if (!IsAudioDeviceReady()) {
+        fprintf(stderr, "error: no audio device\n");
+        return 1;
+    }
+
+    printf("%-40s %9s %12s %12s %12s\n", "song", "file MB", "us/frame", "worst us", "resident MB");
+    for (s32 index = 0; index < path_count; index++) {
+        BenchMusic(paths[index], 10.0);
+    }
+    CloseAudioDevice();
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "-music") == 0) {
+        return BenchMusicMain(argc - 2, argv + 2);
+    }
+
+    static Bench_Suite suite;
+    static Bench_Suite baseline;
+    const char *json_path    = NULL;
+    const char *compare_path = NULL;
+    f64         threshold    = 10.0;
+    for (s32 arg = 1; arg < argc; arg++) {
+        b32 has_value = arg + 1 < argc;
+        if      (strcmp(argv[arg], "-filter")    == 0 && has_value) suite.filter = argv[++arg];
+        else if (strcmp(argv[arg], "-json")      == 0 && has_value) json_path    = argv[++arg];
+        else if (strcmp(argv[arg], "-compare")   == 0 && has_value) compare_path = argv[++arg];
+        else if (strcmp(argv[arg], "-threshold") == 0 && has_value) threshold    = atof(argv[++arg]);
+        else {
+            fprintf(stderr, "usage: bench [-filter text] [-json out.json] [-compare base.json] [-threshold percent]\n"
+                            "       bench -music song...\n");
+            return 1;
+        }
+    }
+    if (compare_path && !BenchReadJson(&baseline, compare_path)) {
+        fprintf(stderr, "error: can't read %s\n", compare_path);
+        return 1;
+    }
+
+    // NOTE: A stand-in for a loaded texture so the draw code pushes its
+    // commands, there's no GL context so it never gets drawn.
+    SetTraceLogLevel(LOG_WARNING);
+    Texture_Entry *entry = &g_textures.entries[BENCH_TEXTURE];
+    entry->texture       = {1, 512, 512, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    entry->region        = {0, 0, 512, 512};
+
+    printf("bit planes: %s\n", BITPLANE_PATH);
+    printf("%-64s %14s %10s %8s\n", "benchmark", "ns/call", "calls", "checksum");
+    BenchRunAll(&suite);
+
+    if (json_path) {
+        if (!BenchWriteJson(&suite, json_path)) {
+            fprintf(stderr, "error: can't write %s\n", json_path);
+            return 1;
+        }
+        printf("wrote %u results to %s\n", suite.count, json_path);
+    }
+
+    s32 result = 0;
+    if (compare_path && BenchCompare(&suite, &baseline, threshold) > 0) result = 1;
+    return result;
+}
@@ -0,0 +1,217 @@
+
+void BitPlaneLayoutInit(Bit_Plane_Layout *layout, u32 width, u32 height) {
+    u32 word_count     = (width*height + 63) >> 6;
+    layout->width      = width;
+    layout->height     = height;
+    layout->word_count = (word_count + BITPLANE_WORD_ALIGN - 1) & ~(BITPLANE_WORD_ALIGN - 1);
+    // Shifting by a row reaches back (width >> 6) words plus one more for
+    // the bits that carry over.
+    layout->pad        = (width >> 6) + 1;
+}
+
+size_t BitPlaneMemorySize(Bit_Plane_Layout *layout, u32 plane_count) {
+    size_t result = (size_t)plane_count*(layout->word_count + 2*layout->pad)*sizeof(u64);
+    return result;
+}
+
+// Hands back a zeroed plane. The pad words either side of it are never
+// written to after this.
+u64 *BitPlaneAlloc(Bit_Plane_Layout *layout, Memory_Arena *arena) {
+    u32  total  = layout->word_count + 2*layout->pad;
+    u64 *result = (u64 *)ArenaAlloc(arena, sizeof(u64)*total);
+    for (u32 word = 0; word < total; word++) {
+        result[word] = 0;
+    }
+    result += layout->pad;
+    return result;
+}
+
+void BitPlaneClear(Bit_Plane_Layout *layout, u64 *plane) {
+    for (u32 word = 0; word < layout->word_count; word++) {
+        plane[word] = 0;
+    }
+}
+
+u32 BitPlaneCount(Bit_Plane_Layout *layout, u64 *plane) {
+    u32 result = 0;
+    for (u32 word = 0; word < layout->word_count; word++) {
+        result += PopCount64(plane[word]);
+    }
+    return result;
+}
+
+// Index of the nth set bit counting from zero, the plane has to have more
+// than n bits set.
+u32 BitPlaneSelect(Bit_Plane_Layout *layout, u64 *plane, u32 n) {
+    u32 word = 0;
+    for (; word < layout->word_count; word++) {
+        u32 count = PopCount64(plane[word]);
+        if (n < count) break;
+        n -= count;
+    }
+    ASSERT(word < layout->word_count);
+
+    u64 bits = plane[word];
+    while (n--) bits &= bits - 1;
+    u32 result = (word << 6) + CountTrailingZeros64(bits);
+    return result;
+}
+
+// One pass over the plane growing fill by a tile in each direction. The
+// masks say which tiles can be grown into from each side, from_left has
+// the first column cleared so a row never leaks into the one below it
+// and from_right has the last column cleared for the same reason. Words
+// get written back as we go so later words in the pass already see the
+// growth, which is why the passes alternate direction.
+#if defined(BITPLANE_AVX2)
+b32 BitPlaneFloodPass(Bit_Plane_Layout *layout, u64 *fill, u64 *open,
+                      u64 *from_left, u64 *from_right, u64 *blocked, b32 backwards) {
+    s32     row_words  = layout->width >> 6;
+    __m128i row_bits   = _mm_cvtsi32_si128(layout->width & 63);
+    __m128i carry_bits = _mm_cvtsi32_si128(64 - (layout->width & 63));
+    __m256i changed    = _mm256_setzero_si256();
+
+    for (u32 step = 0; step < layout->word_count; step += 4) {
+        s32     word  = backwards ? layout->word_count - 4 - step : step;
+        __m256i cur   = _mm256_loadu_si256((__m256i *)(fill + word));
+        __m256i prev  = _mm256_loadu_si256((__m256i *)(fill + word - 1));
+        __m256i next  = _mm256_loadu_si256((__m256i *)(fill + word + 1));
+        __m256i above = _mm256_or_si256(
+            _mm256_sll_epi64(_mm256_loadu_si256((__m256i *)(fill + word - row_words)), row_bits),
+            _mm256_srl_epi64(_mm256_loadu_si256((__m256i *)(fill + word - row_words - 1)), carry_bits));
+        __m256i below = _mm256_or_si256(
+            _mm256_srl_epi64(_mm256_loadu_si256((__m256i *)(fill + word + row_words)), row_bits),
+            _mm256_sll_epi64(_mm256_loadu_si256((__m256i *)(fill + word + row_words + 1)), carry_bits));
+        __m256i left  = _mm256_or_si256(_mm256_slli_epi64(cur, 1), _mm256_srli_epi64(prev, 63));
+        __m256i right = _mm256_or_si256(_mm256_srli_epi64(cur, 1), _mm256_slli_epi64(next, 63));
+
+        __m256i spread = _mm256_and_si256(_mm256_or_si256(above, below),
+                                          _mm256_loadu_si256((__m256i *)(open + word)));
+        spread = _mm256_or_si256(spread, _mm256_and_si256(left,  _mm256_loadu_si256((__m256i *)(from_left  + word))));
+        spread = _mm256_or_si256(spread, _mm256_and_si256(right, _mm256_loadu_si256((__m256i *)(from_right + word))));
+        spread = _mm256_andnot_si256(_mm256_loadu_si256((__m256i *)(blocked + word)), spread);
+
+        __m256i grown = _mm256_or_si256(cur, spread);
+        changed       = _mm256_or_si256(changed, _mm256_xor_si256(grown, cur));
+        _mm256_storeu_si256((__m256i *)(fill + word), grown);
+    }
+
+    b32 result = !_mm256_testz_si256(changed, changed);
+    return result;
+}
+#elif defined(BITPLANE_SSE2)
+b32 BitPlaneFloodPass(Bit_Plane_Layout *layout, u64 *fill, u64 *open,
+                      u64 *from_left, u64 *from_right, u64 *blocked, b32 backwards) {
+    s32     row_words  = layout->width >> 6;
+    __m128i row_bits   = _mm_cvtsi32_si128(layout->width & 63);
+    __m128i carry_bits = _mm_cvtsi32_si128(64 - (layout->width & 63));
+    __m128i changed    = _mm_setzero_si128();
+
+    for (u32 step = 0; step < layout->word_count; step += 2) {
+        s32     word  = backwards ? layout->word_count - 2 - step : step;
+        __m128i cur   = _mm_loadu_si128((__m128i *)(fill + word));
+        __m128i prev  = _mm_loadu_si128((__m128i *)(fill + word - 1));
+        __m128i next  = _mm_loadu_si128((__m128i *)(fill + word + 1));
+        __m128i above = _mm_or_si128(
+            _mm_sll_epi64(_mm_loadu_si128((__m128i *)(fill + word - row_words)), row_bits),
+            _mm_srl_epi64(_mm_loadu_si128((__m128i *)(fill + word - row_words - 1)), carry_bits));
+        __m128i below = _mm_or_si128(
+            _mm_srl_epi64(_mm_loadu_si128((__m128i *)(fill + word + row_words)), row_bits),
+            _mm_sll_epi64(_mm_loadu_si128((__m128i *)(fill + word + row_words + 1)), carry_bits));
+        __m128i left  = _mm_or_si128(_mm_slli_epi64(cur, 1), _mm_srli_epi64(prev, 63));
+        __m128i right = _mm_or_si128(_mm_srli_epi64(cur, 1), _mm_slli_epi64(next, 63));
+
+        __m128i spread = _mm_and_si128(_mm_or_si128(above, below),
+                                       _mm_loadu_si128((__m128i *)(open + word)));
+        spread = _mm_or_si128(spread, _mm_and_si128(left,  _mm_loadu_si128((__m128i *)(from_left  + word))));
+        spread = _mm_or_si128(spread, _mm_and_si128(right, _mm_loadu_si128((__m128i *)(from_right + word))));
+        spread = _mm_andnot_si128(_mm_loadu_si128((__m128i *)(blocked + word)), spread);
+
+        __m128i grown = _mm_or_si128(cur, spread);
+        changed       = _mm_or_si128(changed, _mm_xor_si128(grown, cur));
+        _mm_storeu_si128((__m128i *)(fill + word), grown);
+    }
+
+    b32 result = _mm_movemask_epi8(_mm_cmpeq_epi8(changed, _mm_setzero_si128())) != 0xFFFF;
+    return result;
+}
+#elif defined(BITPLANE_WASM)
+b32 BitPlaneFloodPass(Bit_Plane_Layout *layout, u64 *fill, u64 *open,
+                      u64 *from_left, u64 *from_right, u64 *blocked, b32 backwards) {
+    s32    row_words  = layout->width >> 6;
+    u32    row_bits   = layout->width & 63;
+    // NOTE: WASM shifts wrap the count, so shifting by 64 isn't zero like
+    // it is on x64. Mask the carry off instead when rows are whole words.
+    v128_t carry_mask = wasm_i64x2_splat(row_bits ? -1 : 0);
+    v128_t changed    = wasm_i64x2_splat(0);
+
+    for (u32 step = 0; step < layout->word_count; step += 2) {
+        s32    word  = backwards ? layout->word_count - 2 - step : step;
+        v128_t cur   = wasm_v128_load(fill + word);
+        v128_t prev  = wasm_v128_load(fill + word - 1);
+        v128_t next  = wasm_v128_load(fill + word + 1);
+        v128_t above = wasm_v128_or(
+            wasm_i64x2_shl(wasm_v128_load(fill + word - row_words), row_bits),
+            wasm_v128_and(wasm_u64x2_shr(wasm_v128_load(fill + word - row_words - 1), 64 - row_bits), carry_mask));
+        v128_t below = wasm_v128_or(
+            wasm_u64x2_shr(wasm_v128_load(fill + word + row_words), row_bits),
+            wasm_v128_and(wasm_i64x2_shl(wasm_v128_load(fill + word + row_words + 1), 64 - row_bits), carry_mask));
+        v128_t left  = wasm_v128_or(wasm_i64x2_shl(cur, 1), wasm_u64x2_shr(prev, 63));
+        v128_t right = wasm_v128_or(wasm_u64x2_shr(cur, 1), wasm_i64x2_shl(next, 63));
+
+        v128_t spread = wasm_v128_and(wasm_v128_or(above, below), wasm_v128_load(open + word));
+        spread = wasm_v128_or(spread, wasm_v128_and(left,  wasm_v128_load(from_left  + word)));
+        spread = wasm_v128_or(spread, wasm_v128_and(right, wasm_v128_load(from_right + word)));
+        spread = wasm_v128_andnot(spread, wasm_v128_load(blocked + word));
+
+        v128_t grown = wasm_v128_or(cur, spread);
+        changed      = wasm_v128_or(changed, wasm_v128_xor(grown, cur));
+        wasm_v128_store(fill + word, grown);
+    }
+
+    b32 result = wasm_v128_any_true(changed);
+    return result;
+}
+#else
+b32 BitPlaneFloodPass(Bit_Plane_Layout *layout, u64 *fill, u64 *open,
+                      u64 *from_left, u64 *from_right, u64 *blocked, b32 backwards) {
+    s32 row_words = layout->width >> 6;
+    u32 row_bits  = layout->width & 63;
+    u64 changed   = 0;
+
+    for (u32 step = 0; step < layout->word_count; step++) {
+        s32 word  = backwards ? layout->word_count - 1 - step : step;
+        u64 cur   = fill[word];
+        u64 above = fill[word - row_words] << row_bits;
+        u64 below = fill[word + row_words] >> row_bits;
+        if (row_bits) {
+            above |= fill[word - row_words - 1] >> (64 - row_bits);
+            below |= fill[word + row_words + 1] << (64 - row_bits);
+        }
+        u64 left  = (cur << 1) | (fill[word - 1] >> 63);
+        u64 right = (cur >> 1) | (fill[word + 1] << 63);
+
+        u64 spread = ((above | below) & open[word]) |
+                     (left & from_left[word]) | (right & from_right[word]);
+        u64 grown  = cur | (spread & ~blocked[word]);
+        changed   |= grown ^ cur;
+        fill[word] = grown;
+    }
+
+    b32 result = (changed != 0);
+    return result;
+}
+#endif
+
+// Grows fill out through everything it's connected to until it stops
+// changing. Returns how many passes that took.
+u32 BitPlaneFlood(Bit_Plane_Layout *layout, u64 *fill, u64 *open,
+                  u64 *from_left, u64 *from_right, u64 *blocked) {
+    u32 passes = 0;
+    b32 changed = true;
+    while (changed) {
+        changed = BitPlaneFloodPass(layout, fill, open, from_left, from_right, blocked, passes & 1);
+        passes++;
+    }
+    return passes;
+}
@@ -0,0 +1,381 @@
+
+// NOTE: An autopilot for soak testing. It plays round after round on its own
+// so the slow stuff shows up: the arena growing, texture refs that never get
+// handed back, fadeables piling up towards MAX_FADEABLES. Each round gets a
+// line in the log with its frame time percentiles and what the memory and
+// the textures look like at the end of it.
+//
+// The bot fills in the Input_Frame the same as the keyboard would, so its
+// directions go through StorePlayerDirectionsInBuffer() and InputBufferPush()
+// like a player's and a -record of it plays back like any other. It picks
+// one direction per tile, for the tile the player is walking onto:
+//
+//   - never a wall, a demon, or fire unless it's powered up with time left
+//   - never a move that leaves it fewer than BOT_SAFE_SPACE tiles to go
+//   - powered up it heads for the nearest fire, otherwise the nearest
+//     powerup, otherwise it walks circles round the nearest demon and lets
+//     the trail of fire box it in
+//   - with nothing to head for it mostly keeps going straight
+//
+// Off the play screen it taps space every BOT_PRESS_INTERVAL to get back in.
+
+// Offsets for DirectionFacing_down, up, left and right. Flipping the bottom
+// bit of a direction turns it around.
+static const s32 g_bot_offset_x[4] = { 0, 0,-1, 1};
+static const s32 g_bot_offset_y[4] = { 1,-1, 0, 0};
+
+void BotOpen(Bot *bot, u32 round_limit, b32 fast) {
+    *bot             = {};
+    bot->active      = true;
+    bot->fast        = fast;
+    bot->round_limit = round_limit;
+    bot->log         = fopen(BOT_LOG_PATH, "w");
+    if (bot->log) {
+        fprintf(bot->log, "round,outcome,seconds,score,frames,p50_ms,p95_ms,p99_ms,max_ms,"
+                          "resident_kb,arena_kb,textures,texture_refs,texture_kb,fadeables,enemies,powerups\n");
+    } else {
+        TraceLog(LOG_WARNING, "BOT: Can't write %s, the rounds only go to the log", BOT_LOG_PATH);
+    }
+}
+
+// Call once GameInit() has the seed, the bot's tie breaks come out of it too.
+void BotStart(Bot *bot, u32 seed, u32 tile_count, Texture_Registry *textures) {
+    if (!bot->active) return;
+    bot->random     = RandomSeed(seed, RandomStream_bot);
+    bot->textures   = textures;
+    bot->seen       = (u32 *)calloc(tile_count, sizeof(u32));
+    bot->seen_count = tile_count;
+    bot->time       = GetTime();
+}
+
+void BotNextStamp(Bot *bot) {
+    bot->stamp++;
+    if (bot->stamp == 0) {
+        memset(bot->seen, 0, bot->seen_count*sizeof(u32));
+        bot->stamp = 1;
+    }
+}
+
+// Whether stepping onto x, y right now would be fine. Same rules as
+// SimUpdatePlayer(), the edge of the map counts as out of bounds.
+b32 BotCanEnter(Tilemap *map, s32 x, s32 y, b32 fire_ok) {
+    if (x < 1 || y < 1 || x >= (s32)map->width - 1 || y >= (s32)map->height - 1) return false;
+
+    Tile tile = TileAt(map, (u32)x, (u32)y);
+    b32 result = GetTileType(tile) == TileType_floor && !IsFlagSet(tile, TileFlag_enemy) &&
+                 (fire_ok || !IsFlagSet(tile, TileFlag_fire));
+    return result;
+}
+
+b32 BotNextToEnemy(Tilemap *map, s32 x, s32 y) {
+    for (u32 dir = 0; dir < 4; dir++) {
+        s32 next_x = x + g_bot_offset_x[dir];
+        s32 next_y = y + g_bot_offset_y[dir];
+        if (next_x < 0 || next_y < 0 || next_x >= (s32)map->width || next_y >= (s32)map->height) continue;
+        if (IsFlagSet(TileAt(map, (u32)next_x, (u32)next_y), TileFlag_enemy)) return true;
+    }
+    return false;
+}
+
+b32 BotIsGoal(Tilemap *map, u32 index, Bot_Goal goal) {
+    s32  x    = (s32)(index % map->width);
+    s32  y    = (s32)(index / map->width);
+    Tile tile = GetTile(map, index);
+    switch (goal) {
+        case BotGoal_fire:    return IsFlagSet(tile, TileFlag_fire);
+        case BotGoal_powerup: return IsFlagSet(tile, TileFlag_powerup);
+        case BotGoal_enemy: {
+            // Two steps from a demon, close enough to wall it in without
+            // walking into it when it moves.
+            static const s32 ring_x[8] = {2,-2, 0, 0, 1, 1,-1,-1};
+            static const s32 ring_y[8] = {0, 0, 2,-2, 1,-1, 1,-1};
+            for (u32 ring = 0; ring < 8; ring++) {
+                s32 ring_tile_x = x + ring_x[ring];
+                s32 ring_tile_y = y + ring_y[ring];
+                if (ring_tile_x < 0 || ring_tile_y < 0 ||
+                    ring_tile_x >= (s32)map->width || ring_tile_y >= (s32)map->height) continue;
+                if (IsFlagSet(TileAt(map, (u32)ring_tile_x, (u32)ring_tile_y), TileFlag_enemy)) return true;
+            }
+            return false;
+        }
+        default: return false;
+    }
+}
+
+// How many tiles could still be reached after stepping from blocked onto
+// start, up to BOT_SEARCH_MAX. The tile being left counts as a wall, it's
+// about to be on fire.
+u32 BotSpace(Bot *bot, Tilemap *map, u32 start, u32 blocked, b32 fire_ok) {
+    BotNextStamp(bot);
+    bot->seen[blocked] = bot->stamp;
+    bot->seen[start]   = bot->stamp;
+    bot->queue[0]      = start;
+
+    u32 head = 0, tail = 1;
+    while (head < tail && tail < BOT_SEARCH_MAX) {
+        u32 index = bot->queue[head++];
+        s32 x     = (s32)(index % map->width);
+        s32 y     = (s32)(index / map->width);
+        for (u32 dir = 0; dir < 4 && tail < BOT_SEARCH_MAX; dir++) {
+            s32 next_x = x + g_bot_offset_x[dir];
+            s32 next_y = y + g_bot_offset_y[dir];
+            if (!BotCanEnter(map, next_x, next_y, fire_ok)) continue;
+
+            u32 next = TilemapIndex((u32)next_x, (u32)next_y, map->width);
+            if (bot->seen[next] == bot->stamp) continue;
+            bot->seen[next]    = bot->stamp;
+            bot->queue[tail++] = next;
+        }
+    }
+    return tail;
+}
+
+// Breadth first out from the moves that are allowed, remembering which one
+// each tile was reached through, so the first goal found says which way to
+// go. Hands back DirectionFacing_none if there isn't one close enough.
+Direction_Facing BotGoalDirection(Bot *bot, Tilemap *map, u32 from, b32 *allowed, Bot_Goal goal, b32 fire_ok) {
+    BotNextStamp(bot);
+    bot->seen[from] = bot->stamp;
+
+    u32 head = 0, tail = 0;
+    s32 from_x = (s32)(from % map->width);
+    s32 from_y = (s32)(from / map->width);
+    for (u32 dir = 0; dir < 4; dir++) {
+        if (!allowed[dir]) continue;
+        u32 next = TilemapIndex((u32)(from_x + g_bot_offset_x[dir]), (u32)(from_y + g_bot_offset_y[dir]), map->width);
+        if (BotIsGoal(map, next, goal)) return (Direction_Facing)dir;
+        bot->seen[next]       = bot->stamp;
+        bot->queue[tail]      = next;
+        bot->first_dir[tail]  = (u8)dir;
+        tail++;
+    }
+
+    while (head < tail) {
+        u32 index = bot->queue[head];
+        u8  first = bot->first_dir[head];
+        head++;
+        s32 x = (s32)(index % map->width);
+        s32 y = (s32)(index / map->width);
+        for (u32 dir = 0; dir < 4; dir++) {
+            s32 next_x = x + g_bot_offset_x[dir];
+            s32 next_y = y + g_bot_offset_y[dir];
+            if (!BotCanEnter(map, next_x, next_y, fire_ok)) continue;
+
+            u32 next = TilemapIndex((u32)next_x, (u32)next_y, map->width);
+            if (bot->seen[next] == bot->stamp) continue;
+            if (BotIsGoal(map, next, goal)) return (Direction_Facing)first;
+            if (tail == BOT_SEARCH_MAX) continue;
+            bot->seen[next]       = bot->stamp;
+            bot->queue[tail]      = next;
+            bot->first_dir[tail]  = first;
+            tail++;
+        }
+    }
+    return DirectionFacing_none;
+}
+
+// Picks the direction to take off the tile at x, y, the player is either
+// on it or on the way to it.
+Direction_Facing BotPickDirection(Bot *bot, Game_Sim *sim, u32 x, u32 y) {
+    Tilemap      *map     = sim->map;
+    Player       *player  = sim->player;
+    Game_Manager *manager = sim->manager;
+    u32           from    = TilemapIndex(x, y, map->width);
+    b32           fire_ok = player->powered_up && !IsPowerupEnding(player, sim->time);
+
+    // NOTE: Turning straight round gets thrown away by the input buffer.
+    u32 space[4]   = {};
+    u32 best_space = 0;
+    for (u32 dir = 0; dir < 4; dir++) {
+        if (player->facing <= DirectionFacing_right && dir == ((u32)player->facing ^ 1)) continue;
+
+        s32 next_x = (s32)x + g_bot_offset_x[dir];
+        s32 next_y = (s32)y + g_bot_offset_y[dir];
+        if (!BotCanEnter(map, next_x, next_y, fire_ok)) continue;
+
+        space[dir] = BotSpace(bot, map, TilemapIndex((u32)next_x, (u32)next_y, map->width), from, fire_ok);
+        // A demon next door could step in the way.
+        if (BotNextToEnemy(map, next_x, next_y)) space[dir] /= 2;
+        if (space[dir] > best_space) best_space = space[dir];
+    }
+    if (!best_space) return player->facing;
+
+    u32 enough = best_space < BOT_SAFE_SPACE ? best_space : BOT_SAFE_SPACE;
+    b32 allowed[4];
+    for (u32 dir = 0; dir < 4; dir++) {
+        allowed[dir] = space[dir] && space[dir] >= enough;
+    }
+
+    Bot_Goal goal = fire_ok                        ? BotGoal_fire    :
+                    manager->powerup_pool.in_use   ? BotGoal_powerup :
+                    manager->enemy_pool.in_use     ? BotGoal_enemy   : BotGoal_none;
+    if (goal != BotGoal_none) {
+        Direction_Facing result = BotGoalDirection(bot, map, from, allowed, goal, fire_ok);
+        if (result != DirectionFacing_none) return result;
+    }
+
+    if (player->facing <= DirectionFacing_right && allowed[player->facing] &&
+        RandomUnilateral(&bot->random) < 0.75f) {
+        return player->facing;
+    }
+    u32 pick_count = 0;
+    u32 picks[4];
+    for (u32 dir = 0; dir < 4; dir++) {
+        if (allowed[dir]) picks[pick_count++] = dir;
+    }
+    Direction_Facing result = (Direction_Facing)picks[RandomRange(&bot->random, 0, pick_count - 1)];
+    return result;
+}
+
+void BotBeginRound(Bot *bot, Game_Sim *sim) {
+    bot->in_round     = true;
+    bot->round_start  = sim->time;
+    bot->round_score  = 0;
+    bot->round_frames = 0;
+    bot->worst_frame  = 0;
+    bot->decided_tile = 0xFFFFFFFF;
+    memset(bot->frame_buckets, 0, sizeof(bot->frame_buckets));
+}
+
+// In ms, from the histogram so it's only ever as precise as a bucket. The
+// top of the bucket gets reported, unless the worst frame was under that.
+f64 BotFramePercentile(Bot *bot, f64 percentile) {
+    u32 wanted = (u32)(bot->round_frames*percentile);
+    u32 seen   = 0;
+    f64 result = BOT_FRAME_BUCKETS*BOT_FRAME_BUCKET_MS;
+    for (u32 bucket = 0; bucket < BOT_FRAME_BUCKETS; bucket++) {
+        seen += bot->frame_buckets[bucket];
+        if (seen > wanted) {
+            result = (bucket + 1)*BOT_FRAME_BUCKET_MS;
+            break;
+        }
+    }
+    if (result > bot->worst_frame*1000.0) result = bot->worst_frame*1000.0;
+    return result;
+}
+
+void BotEndRound(Bot *bot, Game_Sim *sim, b32 won) {
+    bot->in_round = false;
+    bot->rounds++;
+    if (won) bot->wins++;
+
+    // NOTE: Atlas sprites don't own a texture, the atlas entry does.
+    u32 textures = 0, texture_refs = 0;
+    u64 texture_bytes = 0;
+    for (u32 index = 1; index < TEXTURE_REGISTRY_MAX; index++) {
+        Texture_Entry *entry = &bot->textures->entries[index];
+        if (!entry->ref_count) continue;
+        textures++;
+        texture_refs += entry->ref_count;
+        if (!entry->atlas.index && entry->texture.id) {
+            texture_bytes += GetPixelDataSize(entry->texture.width, entry->texture.height, entry->texture.format);
+        }
+    }
+
+    Game_Manager *manager  = sim->manager;
+    size_t        arena    = sim->arena->used;
+    u64           resident = ProfilerResidentBytes();
+    f64           seconds  = sim->time - bot->round_start;
+    f64           p50      = BotFramePercentile(bot, 0.50);
+    f64           p95      = BotFramePercentile(bot, 0.95);
+    f64           p99      = BotFramePercentile(bot, 0.99);
+    TraceLog(LOG_INFO, "BOT: Round %u %s after %.1f s with %u points, frames p50 %.2f p95 %.2f p99 %.2f max %.2f ms, "
+             "%.1f MB resident, %u KB arena, %u textures (%u refs, %u KB), %u fadeables",
+             bot->rounds, won ? "won" : "died", seconds, bot->round_score, p50, p95, p99, bot->worst_frame*1000.0,
+             resident / (1024.0*1024.0), (u32)(arena / 1024), textures, texture_refs, (u32)(texture_bytes / 1024),
+             manager->fade_count);
+    if (bot->log) {
+        fprintf(bot->log, "%u,%s,%.2f,%u,%u,%.2f,%.2f,%.2f,%.2f,%u,%u,%u,%u,%u,%u,%u,%u\n",
+                bot->rounds, won ? "won" : "died", seconds, bot->round_score, bot->round_frames,
+                p50, p95, p99, bot->worst_frame*1000.0, (u32)(resident / 1024), (u32)(arena / 1024),
+                textures, texture_refs, (u32)(texture_bytes / 1024), manager->fade_count,
+                manager->enemy_pool.in_use, manager->powerup_pool.in_use);
+        fflush(bot->log);
+    }
+
+    // NOTE: The first few rounds go through screens that load things for
+    // the first time, so only start calling it a leak after those.
+    if (bot->rounds > 3) {
+        if (arena > bot->peak_arena) {
+            TraceLog(LOG_WARNING, "BOT: Arena grew to %u KB by round %u", (u32)(arena / 1024), bot->rounds);
+        }
+        if (texture_refs > bot->peak_texture_refs) {
+            TraceLog(LOG_WARNING, "BOT: Texture refs went up to %u by round %u", texture_refs, bot->rounds);
+        }
+        if (manager->fade_count > bot->peak_fadeables) {
+            TraceLog(LOG_WARNING, "BOT: %u of %u fadeables in use by round %u", manager->fade_count,
+                     MAX_FADEABLES, bot->rounds);
+        }
+    }
+    if (arena                > bot->peak_arena)        bot->peak_arena        = arena;
+    if (texture_refs         > bot->peak_texture_refs) bot->peak_texture_refs = texture_refs;
+    if (manager->fade_count  > bot->peak_fadeables)    bot->peak_fadeables    = manager->fade_count;
+
+    if (bot->round_limit && bot->rounds >= bot->round_limit) bot->quit = true;
+}
+
+// Call once a frame where the input has been gathered, before a replay
+// gets a look at it. Swaps the keyboard's input for the bot's, and when
+// it's running fast the frame time for a fixed step.
+void BotFrame(Bot *bot, Game_Sim *sim, Input_Frame *input, f32 *delta_t, f32 *current_time) {
+    if (!bot->active) return;
+
+    if (bot->fast) {
+        *delta_t      = SIM_DT;
+        bot->time    += SIM_DT;
+        *current_time = (f32)bot->time;
+    }
+
+    f64 now = ProfilerNow();
+    if (bot->in_round && bot->last_frame) {
+        f64 frame_time = now - bot->last_frame;
+        u32 bucket     = (u32)(frame_time*1000.0 / BOT_FRAME_BUCKET_MS);
+        bot->frame_buckets[bucket < BOT_FRAME_BUCKETS ? bucket : BOT_FRAME_BUCKETS - 1]++;
+        bot->round_frames++;
+        if (frame_time > bot->worst_frame) bot->worst_frame = frame_time;
+    }
+    bot->last_frame = now;
+
+    *input = {};
+    Game_Manager *manager = sim->manager;
+    if (manager->state != GameState_play) {
+        bot->press_timer -= *delta_t;
+        if (bot->press_timer <= 0.0f) {
+            bot->press_timer     = BOT_PRESS_INTERVAL;
+            input->space_pressed = true;
+        }
+        return;
+    }
+    if (!bot->in_round) BotBeginRound(bot, sim);
+
+    Player *player = sim->player;
+    Tilemap *map   = sim->map;
+    u32 x          = (u32)(player->target_pos.x / map->tile_size);
+    u32 y          = (u32)(player->target_pos.y / map->tile_size);
+    u32 tile       = TilemapIndex(x, y, map->width);
+    if (tile != bot->decided_tile) {
+        bot->decided_tile       = tile;
+        input->directions[0]    = BotPickDirection(bot, sim, x, y);
+        input->direction_count  = 1;
+    }
+}
+
+// Call after every sim step, that's where rounds end.
+void BotAfterStep(Bot *bot, Game_Sim *sim, b32 was_playing) {
+    if (!bot->active || !was_playing || !bot->in_round) return;
+
+    if (sim->events.flags & SimEvent_game_over) {
+        BotEndRound(bot, sim, false);
+    } else {
+        bot->round_score = sim->manager->score;
+        if (sim->manager->state == GameState_win) BotEndRound(bot, sim, true);
+    }
+}
+
+void BotClose(Bot *bot) {
+    if (!bot->active) return;
+    TraceLog(LOG_INFO, "BOT: %u rounds, %u won", bot->rounds, bot->wins);
+    if (bot->log) fclose(bot->log);
+    free(bot->seen);
+    *bot = {};
+}
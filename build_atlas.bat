@@ -0,0 +1,19 @@
+@echo off
+
+:: NOTE: Builds and runs the sprite atlas packer. This rewrites 
+:: assets\atlas.png and include\atlas_regions.h so run it whenever 
+:: a sprite in assets\atlas_manifest.txt changes.
+
+set CompilerFlags= /O2 /FC /nologo
+
+IF NOT EXIST build mkdir build
+
+pushd build
+
+cl %CompilerFlags% ^
+    ..\atlas_packer.cpp ^
+    /I ..\include/ /I ..\external\Raylib\external/ /link -incremental:no -out:atlas_packer.exe
+
+atlas_packer.exe
+
+popd
@@ -0,0 +1,29 @@
+@echo off
+
+:: NOTE: Builds the headless benchmarks. This links against the raylib
+:: objects that build.bat leaves in the build folder so run that first.
+
+:: The raylib objects are built with /MDd so this has to match.
+set CompilerFlags= /O2 /Zi /MDd /FC /nologo
+
+IF NOT EXIST build mkdir build
+
+pushd build
+
+cl %CompilerFlags% ^
+    ..\bench.cpp ^
+    rcore.obj ^
+    rmodels.obj ^
+    raudio.obj ^
+    rglfw.obj ^
+    rshapes.obj ^
+    rtext.obj ^
+    rtextures.obj ^
+    utils.obj ^
+    /I ..\include/ /link /FORCE:MULTIPLE -incremental:no -out:bench.exe ^
+    Gdi32.lib ^
+    winmm.lib ^
+    user32.lib ^
+    shell32.lib
+
+popd
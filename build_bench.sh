@@ -0,0 +1,25 @@
+#!/bin/sh
+
+# NOTE: Builds the headless benchmarks on Linux, the same thing as
+# build_bench.bat. raylib gets built without GLFW and everything that would
+# have needed it is dropped at link time, since the bench never opens a
+# window, so there's no X11 or GL to install. Run it from the repo root.
+#
+#   build/bench -json baseline.json       before the change
+#   build/bench -compare baseline.json    after it, fails on a regression
+
+set -e
+
+CompilerFlags="-O2 -g -ffunction-sections -fdata-sections"
+
+mkdir -p build
+cd build
+
+for source in rcore rshapes rtext rtextures raudio utils; do
+    gcc $CompilerFlags -c -DPLATFORM_DESKTOP -I../external/Raylib/external/glfw/include \
+        ../external/Raylib/$source.c -o $source.o
+done
+
+g++ $CompilerFlags -I../include ../bench.cpp \
+    rcore.o rshapes.o rtext.o rtextures.o raudio.o utils.o \
+    -Wl,--gc-sections -lm -lpthread -ldl -o bench
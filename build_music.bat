@@ -0,0 +1,35 @@
+@echo off
+
+:: NOTE: Builds and runs the music encoder. This turns the WAV masters 
+:: of the songs in assets\sounds into the QOA files the game streams, 
+:: run it whenever one of the songs changes and then build_pack.bat. 
+:: It links against the raylib objects that build.bat leaves in the 
+:: build folder so run that first.
+
+:: The raylib objects are built with /MDd so this has to match.
+set CompilerFlags= /O2 /MDd /FC /nologo
+
+IF NOT EXIST build mkdir build
+
+pushd build
+
+cl %CompilerFlags% ^
+    ..\music_encoder.cpp ^
+    rcore.obj ^
+    rmodels.obj ^
+    raudio.obj ^
+    rglfw.obj ^
+    rshapes.obj ^
+    rtext.obj ^
+    rtextures.obj ^
+    utils.obj ^
+    /I ..\include/ /link /FORCE:MULTIPLE -incremental:no -out:music_encoder.exe ^
+    Gdi32.lib ^
+    winmm.lib ^
+    user32.lib ^
+    shell32.lib
+
+set Songs=music music_muted tutorial_track intro_music win_track
+for %%s in (%Songs%) do music_encoder.exe ..\assets\sounds\%%s.wav ..\assets\sounds\%%s.qoa
+
+popd
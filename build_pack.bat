@@ -0,0 +1,20 @@
+@echo off
+
+:: NOTE: Builds and runs the asset pack builder. This writes a 
+:: build\garden_<group>.pak for each group in assets\pack_manifest.txt 
+:: and the build\garden_packs.txt index of them, 
+:: run build_atlas.bat first if any of the sprites changed.
+
+set CompilerFlags= /O2 /FC /nologo
+
+IF NOT EXIST build mkdir build
+
+pushd build
+
+cl %CompilerFlags% ^
+    ..\pack_builder.cpp ^
+    /I ..\include/ /I ..\external\Raylib\external/ /link -incremental:no -out:pack_builder.exe
+
+pack_builder.exe
+
+popd
@@ -34,15 +34,21 @@ emcc ^
   -sMIN_WEBGL_VERSION=2 -sMAX_WEBGL_VERSION=2 ^
   -sFULL_ES3=1 ^
   -sALLOW_MEMORY_GROWTH=1 ^
-  --preload-file "..\assets@assets" ^
+  -sFETCH=1 ^
+  -msimd128 ^
   -O3 ^
   -o "%OUTNAME%.html"
 
+rem The assets come from the packs (see build_pack.bat) which the game 
+rem fetches itself, so there's no --preload-file of the assets folder.
+copy /Y ..\build\garden_*.pak .
+copy /Y ..\build\garden_packs.txt garden_packs.txt
+
 popd
 
   echo.
   echo Built %OUTDIR%\%OUTNAME%.html 
-  echo Run a local server in the dist/ folder: 
+  echo Run serve_web.bat, or any static server in the dist/ folder: 
   echo python -m http.server 8080
   echo then open: http://localhost:8080/%OUTNAME%.html 
   echo.
@@ -146,11 +146,13 @@ qoaplay_desc *qoaplay_open_memory(const unsigned char *data, int data_size)
 
     qoa_ctx->file = NULL;
 
-    // Keep a copy of file data provided to be managed internally
-    qoa_ctx->file_data = (unsigned char *)QOA_MALLOC(data_size);
-    memcpy(qoa_ctx->file_data, data, data_size);
+    // NOTE(garden): Read straight out of the data provided instead of keeping
+    // a copy, the same as the other music formats do, so it has to stay alive
+    // until the stream is unloaded. Reading also starts at the first frame
+    // rather than on top of the file header.
+    qoa_ctx->file_data = (unsigned char *)data;
     qoa_ctx->file_data_size = data_size;
-    qoa_ctx->file_data_offset = 0;
+    qoa_ctx->file_data_offset = first_frame_pos;
     qoa_ctx->first_frame_pos = first_frame_pos;
 
     // Setup data pointers to previously allocated data
@@ -169,11 +171,7 @@ void qoaplay_close(qoaplay_desc *qoa_ctx)
 {
     if (qoa_ctx->file) fclose(qoa_ctx->file);
 
-    if ((qoa_ctx->file_data) && (qoa_ctx->file_data_size > 0))
-    {
-        QOA_FREE(qoa_ctx->file_data);
-        qoa_ctx->file_data_size = 0;
-    }
+    // NOTE(garden): file_data belongs to the caller, see qoaplay_open_memory()
 
     QOA_FREE(qoa_ctx);
 }
@@ -184,7 +182,10 @@ unsigned int qoaplay_decode_frame(qoaplay_desc *qoa_ctx)
     if (qoa_ctx->file) qoa_ctx->buffer_len = fread(qoa_ctx->buffer, 1, qoa_max_frame_size(&qoa_ctx->info), qoa_ctx->file);
     else
     {
+        // NOTE(garden): The last frame is usually shorter, don't read past the end
+        unsigned int bytes_left = (qoa_ctx->file_data_offset < qoa_ctx->file_data_size)? qoa_ctx->file_data_size - qoa_ctx->file_data_offset : 0;
         qoa_ctx->buffer_len = qoa_max_frame_size(&qoa_ctx->info);
+        if (qoa_ctx->buffer_len > bytes_left) qoa_ctx->buffer_len = bytes_left;
         memcpy(qoa_ctx->buffer, qoa_ctx->file_data + qoa_ctx->file_data_offset, qoa_ctx->buffer_len);
         qoa_ctx->file_data_offset += qoa_ctx->buffer_len;
     }
@@ -201,7 +202,7 @@ unsigned int qoaplay_decode_frame(qoaplay_desc *qoa_ctx)
 void qoaplay_rewind(qoaplay_desc *qoa_ctx)
 {
     if (qoa_ctx->file) fseek(qoa_ctx->file, qoa_ctx->first_frame_pos, SEEK_SET);
-    else qoa_ctx->file_data_offset = 0;
+    else qoa_ctx->file_data_offset = qoa_ctx->first_frame_pos;
 
     qoa_ctx->sample_position = 0;
     qoa_ctx->sample_data_len = 0;
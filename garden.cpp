@@ -1,16 +1,31 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <time.h>
 #include "raylib.h"
 #include "rlgl.h"
 #include "types.h"
 #include "mymath.h"
+#include "random.h"
 #include "game_memory.h"
+#include "bitplane.h"
+#include "asset_pack.h"
 #include "shader.h"
 #include "garden.h"
+#include "atlas_regions.h"
 
 #include "shader.cpp"
+#include "asset_pack.cpp"
+#include "asset_loader.cpp"
+#include "music.cpp"
 #include "web_platform.cpp"
+#include "profiler.cpp"
+#include "bitplane.cpp"
+#include "sim.cpp"
+#include "replay.cpp"
+#include "bot.cpp"
+#include "hot_reload.cpp"
 
 static Memory_Arena         g_arena;
 static Tilemap              g_map;
@@ -21,13 +36,83 @@ static Event_Manager        g_event_manager;
 static Tutorial_Entities    g_tutorial_entities;
 static Win_Screen           g_win_screen; // TODO: Find out if this is initialised to zero.
 static Title_Screen_Manager g_title_screen_manager;
+static Game_Sim             g_sim;
+static Texture_Registry     g_textures;
+static Asset_Library        g_asset_library;
+static Asset_Loader         g_loader;
+static Render_Queue         g_render_queue;
+static Tile_Cache           g_tile_cache;
+static f32                  g_sim_accumulator;
+static Input_Frame          g_pending_input;
 static RenderTexture2D      g_target;
 static bool                 g_audio_initiated;
+static b32                  g_game_initialised;
+static f64                  g_first_frame_time;
+static rlDrawCounters       g_draw_totals;
+static Replay               g_replay;
+static Bot                  g_bot;
+static Hot_Reload           g_hot_reload;
+static u32                  g_map_width;
+static u32                  g_map_height;
+#if defined(PLATFORM_WEB)
+static u64                  g_web_sfx_preloaded;
+static u32                  g_web_arrivals_seen;
+static Web_Song_Decode      g_web_song_decode;
+static u32                  g_web_songs_asked;  // Bits of songs that wanted to play before they were decoded.
+static u32                  g_web_songs_wanted; // Bits of songs to decode ahead of time.
+#endif
+
+// NOTE: The songs ship as QOA, build_music.bat makes them from the WAV
+// masters. Anything else raylib can stream works here too (ogg, mp3), the
+// extension picks the decoder.
+static const char *g_song_paths[Song_count] = {
+    "../assets/sounds/music.qoa",          // Song_play
+    "../assets/sounds/music_muted.qoa",    // Song_play_muted
+    "../assets/sounds/tutorial_track.qoa", // Song_tutorial
+    "../assets/sounds/intro_music.qoa",    // Song_intro
+    "../assets/sounds/win_track.qoa",      // Song_win
+};
+
+static const char *g_sfx_paths[SoundEffect_count] = {
+    "../assets/sounds/powerup.wav",         // SoundEffect_powerup
+    "../assets/sounds/powerup_end.wav",     // SoundEffect_powerup_end
+    "../assets/sounds/powerup_collect.wav", // SoundEffect_powerup_collect
+    "../assets/sounds/powerup_appear.wav",  // SoundEffect_powerup_appear
+    "../assets/sounds/start.wav",           // SoundEffect_spacebar
+};
+
+static const char *g_hype_paths[HYPE_WORD_COUNT] = {
+    "../assets/sounds/hype_1.wav", 
+    "../assets/sounds/hype_2.wav", 
+    "../assets/sounds/hype_3.wav", 
+    "../assets/sounds/hype_4.wav", 
+    "../assets/sounds/hype_5.wav", 
+    "../assets/sounds/hype_6.wav", 
+    "../assets/sounds/hype_7.wav", 
+    "../assets/sounds/hype_8.wav", 
+    "../assets/sounds/hype_9.wav", 
+    "../assets/sounds/hype_10.wav", 
+    "../assets/sounds/hype_11.wav", 
+    "../assets/sounds/hype_12.wav", 
+};
 
 
 // ---------------------------------------------------------------
+// Takes the texture from the background loader if it was queued there, 
+// otherwise uploads it straight out of the asset pack or decodes it from 
+// the file on disk.
 Texture2D LoadTextureWebSafe(const char* path) {
-    Texture2D texture = LoadTexture(path);
+    Texture2D texture;
+    if (AssetLoaderTakeTexture(&g_loader, path, &texture)) return texture;
+
+    void             *data  = NULL;
+    Asset_Pack_Entry *entry = AssetLibraryFind(&g_asset_library, path, AssetKind_image, &data);
+    if (entry) {
+        Image image = {data, (s32)entry->width, (s32)entry->height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+        texture     = LoadTextureFromImage(image);
+    } else {
+        texture     = LoadTexture(path);
+    }
 
 #if defined(PLATFORM_WEB) 
     SetTextureWrap(texture, TEXTURE_WRAP_CLAMP);
@@ -36,6 +121,225 @@ Texture2D LoadTextureWebSafe(const char* path) {
     return texture;
 }
 
+b32 AssetExists(const char *path) {
+    b32 result = AssetLibraryFind(&g_asset_library, path, AssetKind_image, NULL) ||
+                 AssetLibraryFind(&g_asset_library, path, AssetKind_wave, NULL) ||
+                 AssetLibraryFind(&g_asset_library, path, AssetKind_file, NULL) ||
+                 FileExists(path);
+    return result;
+}
+
+Sound LoadSoundAsset(const char *path) {
+    Sound result;
+    if (AssetLoaderTakeSound(&g_loader, path, &result)) return result;
+
+    void             *data  = NULL;
+    Asset_Pack_Entry *entry = AssetLibraryFind(&g_asset_library, path, AssetKind_wave, &data);
+    if (entry) {
+        Wave wave = {entry->frame_count, entry->sample_rate, entry->sample_size, entry->channels, data};
+        result    = LoadSoundFromWave(wave);
+    } else {
+        result    = LoadSound(path);
+    }
+    return result;
+}
+
+// NOTE: The stream keeps reading out of the pack while it plays so the 
+// pack can't be closed until the music has been unloaded.
+Music LoadMusicAsset(const char *path) {
+    Music result;
+    if (AssetLoaderTakeMusic(&g_loader, path, &result)) return result;
+
+    void             *data  = NULL;
+    Asset_Pack_Entry *entry = AssetLibraryFind(&g_asset_library, path, AssetKind_file, &data);
+    if (entry) {
+        result = LoadMusicStreamFromMemory(GetFileExtension(path), (u8 *)data, (s32)entry->size);
+    } else {
+        result = LoadMusicStream(path);
+    }
+    return result;
+}
+
+// The bytes of the file as is, for things that decode it themselves. This
+// is only used for music so nothing loaded here ever gets freed.
+u8 *LoadFileAsset(const char *path, s32 *size) {
+    u8 *result = NULL;
+    if (AssetLoaderTakeFile(&g_loader, path, &result, size)) return result;
+
+    void             *data  = NULL;
+    Asset_Pack_Entry *entry = AssetLibraryFind(&g_asset_library, path, AssetKind_file, &data);
+    if (entry) {
+        result = (u8 *)data;
+        *size  = (s32)entry->size;
+    } else {
+        result = LoadFileData(path, size);
+    }
+    return result;
+}
+
+#if defined(PLATFORM_WEB)
+// The web build plays everything through WebAudio, these just hand it the 
+// bytes out of the pack when they're there instead of a MEMFS path. While
+// the packs are still coming in they hold off rather than going to the 
+// file and get retried as each pack arrives.
+b32 WebAudioPreloadSfxAsset(int id, const char *path) {
+    void             *data  = NULL;
+    Asset_Pack_Entry *entry = AssetLibraryFind(&g_asset_library, path, AssetKind_wave, &data);
+    if (entry && entry->sample_size == 16) {
+        WebAudioSfxPreloadPcm(id, (s16 *)data, entry->frame_count, entry->sample_rate, entry->channels);
+    } else if (!entry && AssetLibraryPending(&g_asset_library)) {
+        return false;
+    } else {
+        WebAudioSfxPreload(id, path);
+    }
+    return true;
+}
+
+void WebAudioPreloadSfxAssets() {
+    for (int i = 0; i < (int)SoundEffect_count; i++) {
+        if (!(g_web_sfx_preloaded & (1ull << i)) && WebAudioPreloadSfxAsset(i, g_sfx_paths[i])) {
+            g_web_sfx_preloaded |= 1ull << i;
+        }
+    }
+    for (int i = 0; i < (int)HYPE_WORD_COUNT; i++) {
+        int id = HYPE_SFX_BASE + i;
+        if (!(g_web_sfx_preloaded & (1ull << id)) && WebAudioPreloadSfxAsset(id, g_hype_paths[i])) {
+            g_web_sfx_preloaded |= 1ull << id;
+        }
+    }
+}
+
+// NOTE: Browsers can't decode QOA so WebAudioSongDecodeUpdate() decodes
+// those songs and hands them over as PCM. One that isn't decoded yet gets
+// asked for and starts once it's done, the slot hangs onto the buffer.
+void WebAudioPlaySongAsset(int slot, const char *path, bool loop) {
+    void             *data  = NULL;
+    Asset_Pack_Entry *entry = AssetLibraryFind(&g_asset_library, path, AssetKind_file, &data);
+    if (!entry && AssetLibraryPending(&g_asset_library)) return;
+    if (IsFileExtension(path, ".qoa")) {
+        if (WebAudioSlotHasPcm(slot, path)) {
+            WebAudioPlaySlotPcm(slot, loop);
+        } else {
+            g_web_songs_asked |= 1u << slot;
+        }
+    } else if (entry) {
+        WebAudioPlaySlotMemory(slot, path, data, (u32)entry->size, loop);
+    } else {
+        WebAudioPlaySlot(slot, path, loop);
+    }
+}
+
+// NOTE: The stems get crossfaded so they have to stay in step. Neither one
+// starts until all of them are decoded and then they all start together
+// off the same WebAudio clock. They're QOA, so they always come through
+// WebAudioSongDecodeUpdate().
+void WebAudioPlaySongStems(int first, int count, bool loop) {
+    b32 ready = true;
+    for (int slot = first; slot < first + count; slot++) {
+        if (!WebAudioSlotHasPcm(slot, g_song_paths[slot])) {
+            g_web_songs_asked |= 1u << slot;
+            ready              = false;
+        }
+    }
+    if (ready) WebAudioPlaySlotsPcm(first, count, loop);
+}
+
+// Opens the first song in the mask that's ready to decode and clears its 
+// bit. Songs whose pack hasn't arrived yet keep theirs.
+b32 WebAudioSongDecodeBegin(Web_Song_Decode *decode, u32 *songs, b32 asked) {
+    for (u32 slot = 0; slot < Song_count; slot++) {
+        if (!(*songs & (1u << slot))) continue;
+        const char *path = g_song_paths[slot];
+        if (!IsFileExtension(path, ".qoa") || WebAudioSlotHasPcm((int)slot, path)) {
+            *songs &= ~(1u << slot);
+            continue;
+        }
+
+        void             *data      = NULL;
+        u8               *file_data = NULL;
+        s32               size      = 0;
+        Asset_Pack_Entry *entry     = AssetLibraryFind(&g_asset_library, path, AssetKind_file, &data);
+        if (entry) {
+            size = (s32)entry->size;
+        } else {
+            if (AssetLibraryPending(&g_asset_library)) continue;
+            file_data = LoadFileData(path, &size);
+            data      = file_data;
+        }
+        *songs &= ~(1u << slot);
+
+        u32 channels = 0, sample_rate = 0, frame_count = 0;
+        void *qoa = data && ReadQoaHeader((u8 *)data, size, &channels, &sample_rate, &frame_count) ? 
+                    qoaplay_open_memory((u8 *)data, size) : NULL;
+        if (!qoa) {
+            TraceLog(LOG_WARNING, "AUDIO: Can't decode %s", path);
+            if (file_data) UnloadFileData(file_data);
+            continue;
+        }
+        decode->qoa         = qoa;
+        decode->file_data   = file_data;
+        decode->slot        = (s32)slot;
+        decode->asked       = asked;
+        decode->channels    = channels;
+        decode->frame_count = frame_count;
+        decode->frames_done = 0;
+        WebAudioSlotBeginPcm((int)slot, path, frame_count, sample_rate, channels);
+        return true;
+    }
+    return false;
+}
+
+// Decodes the songs that have been asked for first and then the rest as
+// their packs come in, a slice at a time until budget seconds are up, so 
+// no frame stops for a whole song the way decoding it in one go did. 
+// Returns true when a song has just finished, the caller should have the
+// songs looked at again so it starts if it's still wanted.
+b32 WebAudioSongDecodeUpdate(Web_Song_Decode *decode, f64 budget) {
+    f64 start = GetTime();
+
+    // NOTE: A song the game is waiting on goes ahead of one that's only
+    // being decoded ahead of time, even partway through. If it's the one
+    // already going that just carries on, otherwise the background one is
+    // dropped and starts over once the asked for ones are done.
+    if (decode->qoa && !decode->asked && g_web_songs_asked) {
+        u32 bit = 1u << decode->slot;
+        if (g_web_songs_asked & bit) {
+            g_web_songs_asked &= ~bit;
+            decode->asked      = true;
+        } else {
+            void *qoa       = decode->qoa;
+            u8   *file_data = decode->file_data;
+            if (WebAudioSongDecodeBegin(decode, &g_web_songs_asked, true)) {
+                qoaplay_close((qoaplay_desc *)qoa);
+                if (file_data) UnloadFileData(file_data);
+                g_web_songs_wanted |= bit;
+            }
+        }
+    }
+    if (!decode->qoa && !WebAudioSongDecodeBegin(decode, &g_web_songs_asked, true) && 
+        !WebAudioSongDecodeBegin(decode, &g_web_songs_wanted, false)) return false;
+
+    qoaplay_desc *qoa   = (qoaplay_desc *)decode->qoa;
+    u32           chunk = WEB_SONG_DECODE_SAMPLES / decode->channels;
+    while (decode->frames_done < decode->frame_count) {
+        u32 frames = decode->frame_count - decode->frames_done;
+        if (frames > chunk) frames = chunk;
+        qoaplay_decode(qoa, decode->samples, (s32)frames);
+        WebAudioSlotAppendPcm(decode->slot, decode->frames_done, decode->samples, frames);
+        decode->frames_done += frames;
+        if (GetTime() - start >= budget) break;
+    }
+    if (decode->frames_done < decode->frame_count) return false;
+
+    WebAudioSlotFinishPcm(decode->slot);
+    qoaplay_close(qoa);
+    if (decode->file_data) UnloadFileData(decode->file_data);
+    decode->qoa       = NULL;
+    decode->file_data = NULL;
+    return true;
+}
+#endif
+
 RenderTexture2D LoadRenderTextureWebSafe(u32 width, u32 height) {
     RenderTexture2D render_texture = LoadRenderTexture(width, height);
 
@@ -46,95 +350,270 @@ RenderTexture2D LoadRenderTextureWebSafe(u32 width, u32 height) {
     return render_texture;
 }
 
-void AnimatorInit(Animation *animator, const char *path, u32 sprite_width, b32 looping) {
-    animator->texture       = LoadTextureWebSafe(path);
-    animator->max_frames    = (f32)animator->texture.width / sprite_width;
-    animator->frame_rec     = {0.0f, 0.0f,
-                               (f32)animator->texture.width / animator->max_frames,
-                               (f32)animator->texture.height};
-    animator->current_frame = 0;
-    animator->looping       = looping;
+// NOTE: Atlas sprites read through to the atlas entry so they pick the 
+// texture up even if the atlas was still loading when they were acquired.
+Texture2D TextureGet(Texture_Handle handle) {
+    Texture_Entry *entry = &g_textures.entries[handle.index];
+    if (entry->atlas.index) entry = &g_textures.entries[entry->atlas.index];
+    Texture2D result = entry->texture;
+    return result;
 }
 
-void TilemapInit(Tilemap *tilemap) {
-    tilemap->width       = TILEMAP_WIDTH;
-    tilemap->height      = TILEMAP_HEIGHT;
-    tilemap->tile_size   = TILE_SIZE;
-    b32 animation_looping = true;
-    AnimatorInit(&tilemap->fire_animation, "../assets/sprites/fire.png", SPRITE_WIDTH, animation_looping); 
+// Hands back a handle to the texture at path, only hitting the disk 
+// and the GPU the first time that path is asked for. Everyone after 
+// that just bumps the ref count. Paths that were packed into the sprite 
+// atlas come back pointing at the atlas with their region set, so a 
+// caller that sticks to TextureRegion() never has to care which it got.
+Texture_Handle TextureAcquire(const char *path) {
+    Texture_Handle result = {};
+    u32 hash              = HashString(path);
+    u32 free_index        = 0;
+
+    // NOTE: Slot 0 is the null handle so it never gets used.
+    for (u32 index = 1; index < TEXTURE_REGISTRY_MAX; index++) {
+        Texture_Entry *entry = &g_textures.entries[index];
+        if (entry->ref_count == 0) {
+            if (!free_index) free_index = index;
+        } else if (entry->hash == hash && TextIsEqual(entry->path, path)) {
+            entry->ref_count++;
+            result.index = index;
+            return result;
+        }
+    }
 
-    f32 amplitude = 0.015, frequency = 15.0f, speed = 32.0f;
-    WobbleShaderInit(&tilemap->wobble, amplitude, frequency, speed); 
-    SetShaderValue(tilemap->wobble.shader, tilemap->wobble.amplitude_location, &tilemap->wobble.amplitude, SHADER_UNIFORM_FLOAT);
-    SetShaderValue(tilemap->wobble.shader, tilemap->wobble.frequency_location, &tilemap->wobble.frequency, SHADER_UNIFORM_FLOAT);
-    SetShaderValue(tilemap->wobble.shader, tilemap->wobble.speed_location,     &tilemap->wobble.speed,     SHADER_UNIFORM_FLOAT);
-}
+    ASSERT(free_index);
+    Texture_Entry *entry = &g_textures.entries[free_index];
+    snprintf(entry->path, TEXTURE_PATH_MAX, "%s", path);
+    entry->hash          = hash;
+    entry->ref_count     = 1;
+
+    // NOTE: If the atlas hasn't been built the sprite just gets loaded 
+    // on its own like it used to. The entry is already taken at this 
+    // point so acquiring the atlas can't land in the same slot.
+    const Atlas_Region *region = NULL;
+    for (u32 index = 0; index < AtlasRegion_count; index++) {
+        if (TextIsEqual(g_atlas_regions[index].path, path)) {
+            region = &g_atlas_regions[index];
+            break;
+        }
+    }
+    u32 job = AssetLoaderFind(&g_loader, path, AssetKind_image);
+    if (region && AssetExists(ATLAS_PATH)) {
+        entry->atlas   = TextureAcquire(ATLAS_PATH);
+        entry->region  = region->rect;
+    } else if (job && !AssetLoaderIsDone(&g_loader, job)) {
+        // NOTE: Still loading in the background, draws of it get skipped 
+        // until TextureRegistryResolve() fills it in.
+        entry->atlas   = {};
+        entry->texture = {};
+        entry->region  = {};
+        entry->job     = job;
+    } else {
+        entry->atlas   = {};
+        entry->texture = LoadTextureWebSafe(path);
+        entry->region  = {0, 0, (f32)entry->texture.width, (f32)entry->texture.height};
+        g_textures.load_count++;
+    }
 
-void StackInit(StackU32 *stack) {
-    stack->top = -1;
+    result.index = free_index;
+    return result;
 }
 
-bool StackPush(StackU32 *stack, u32 x_val, u32 y_val) {
-    if (stack->top >= STACK_MAX_SIZE - 1) return false;
-    stack->top++;
-    stack->x[stack->top] = x_val;
-    stack->y[stack->top] = y_val;
-    return true;
-}
+void TextureRelease(Texture_Handle handle) {
+    if (handle.index == 0) return;
 
-bool StackPop(StackU32 *stack, u32 *x_val, u32 *y_val) {
-    if (stack->top < 0) return false;
-    *x_val = stack->x[stack->top];
-    *y_val = stack->y[stack->top];
-    stack->top--;
-    return true;
+    Texture_Entry *entry = &g_textures.entries[handle.index];
+    ASSERT(entry->ref_count > 0);
+    entry->ref_count--;
+    if (entry->ref_count == 0) {
+        if (entry->atlas.index) {
+            TextureRelease(entry->atlas);
+        } else if (!entry->job) {
+            UnloadTexture(entry->texture);
+        }
+        *entry = {};
+    }
 }
 
-u32 TilemapIndex(u32 x, u32 y, u32 width) {
-    u32 result = y * width + x;
+// Where the sprite lives inside TextureGet(handle), use it as the 
+// source rectangle instead of the texture's own width and height.
+Rectangle TextureRegion(Texture_Handle handle) {
+    Rectangle result = g_textures.entries[handle.index].region;
     return result;
 }
 
-void TileSeedInit(Tile *tile) {
-    switch (tile->type) {
-        case TileType_floor: tile->seed = GetRandomValue(0, TILE_ATLAS_COUNT - 1); break;
-        case TileType_wall:  tile->seed = GetRandomValue(0, WALL_ATLAS_COUNT - 1); break;
-        default:             tile->seed = 0;                                       break;
+// Picks up anything the background loader has finished since last time.
+void TextureRegistryResolve() {
+    for (u32 index = 1; index < TEXTURE_REGISTRY_MAX; index++) {
+        Texture_Entry *entry = &g_textures.entries[index];
+        if (entry->ref_count && entry->job && AssetLoaderIsDone(&g_loader, entry->job)) {
+            entry->texture = LoadTextureWebSafe(entry->path);
+            entry->region  = {0, 0, (f32)entry->texture.width, (f32)entry->texture.height};
+            entry->job     = 0;
+            g_textures.load_count++;
+        }
     }
 }
 
-void TileInit(Tilemap *tilemap) {
-    for (u32 y = 0; y < tilemap->height; y++) {
-        for (u32 x = 0; x < tilemap->width; x++) {
-            u32 index      = TilemapIndex(x, y, tilemap->width);
-            Tile *tile     = &tilemap->tiles[index];
-            tile->type     = (Tile_Type)tilemap->original_map[index];
-            tile->flags    = 0;
-            tile->animator = tilemap->fire_animation;
-            TileSeedInit(tile);
+// Swaps a fresh copy of path off the disk into its registry entry, so every
+// handle to it picks the new one up. A sprite that was in the atlas comes
+// off it and gets a texture of its own, the atlas only has the change once 
+// build_atlas.bat has been run again. Anything that doesn't load leaves the
+// old texture where it was.
+b32 TextureReload(const char *path) {
+    for (u32 index = 1; index < TEXTURE_REGISTRY_MAX; index++) {
+        Texture_Entry *entry = &g_textures.entries[index];
+        if (!entry->ref_count || entry->job || !TextIsEqual(entry->path, path)) continue;
+
+        Texture2D texture = LoadTexture(path);
+        if (!IsTextureReady(texture)) return false;
+
+        if (entry->atlas.index) {
+            TextureRelease(entry->atlas);
+            entry->atlas = {};
+        } else {
+            UnloadTexture(entry->texture);
         }
+        entry->texture = texture;
+        entry->region  = {0, 0, (f32)texture.width, (f32)texture.height};
+        return true;
+    }
+    return false;
+}
+
+void TextureRegistryUnloadAll() {
+    for (u32 index = 1; index < TEXTURE_REGISTRY_MAX; index++) {
+        Texture_Entry *entry = &g_textures.entries[index];
+        if (entry->ref_count && !entry->atlas.index && !entry->job) UnloadTexture(entry->texture);
+        *entry = {};
     }
 }
 
-void PlayerInit(Player *player) {
-    player->pos                 = {base_screen_width*0.5, base_screen_height*0.5};
-    player->target_pos          = player->pos;
-    player->size                = {20, 20};
-    player->col                 = WHITE;
-    player->speed               = 75.0f;
-    player->powered_up          = false;
-    player->powerup_timer       = 0;
-    player->blink_speed         = 0;
-    player->blinking_duration   = 0;
-    player->col_bool            = false;
-    player->facing              = DirectionFacing_down;
-    for(u32 index = 0; index < INPUT_MAX; index++) {
-        player->input_buffer.inputs[index] = DirectionFacing_down;
+int CompareRenderKeys(const void *a, const void *b) {
+    u64 key_a = *(u64 *)a;
+    u64 key_b = *(u64 *)b;
+    int result = (key_a < key_b) ? -1 : (key_a > key_b) ? 1 : 0;
+    return result;
+}
+
+b32 RenderLayerInWorld(u32 layer) {
+    b32 result = (layer >= RenderLayer_ground && layer <= RenderLayer_player);
+    return result;
+}
+
+// Only the tile layers get grouped by texture. Anything in the other layers 
+// might overlap something else in the same layer, so apart from grouping by 
+// shader they go out in the order they were pushed.
+b32 RenderLayerSortsTextures(u32 layer) {
+    b32 result = (layer >= RenderLayer_ground && layer <= RenderLayer_pickups);
+    return result;
+}
+
+void RenderQueueBegin(Render_Queue *queue, Camera2D camera) {
+    queue->count           = 0;
+    queue->camera          = camera;
+    queue->draws           = 0;
+    queue->flushes         = 0;
+    queue->shader_switches = 0;
+}
+
+void RenderQueueFlush(Render_Queue *queue);
+
+// A NULL shader means the default one.
+void PushTexturePro(Render_Queue *queue, Render_Layer layer, Shader *shader, Texture2D texture,
+                    Rectangle source, Rectangle dest, Vector2 origin, Color tint) {
+    // Textures that are still loading just don't draw yet.
+    if (texture.id == 0) return;
+    if (queue->count == queue->capacity) {
+        queue->capacity = queue->capacity ? queue->capacity*2 : RENDER_QUEUE_START;
+        queue->commands = (Render_Command *)realloc(queue->commands, queue->capacity*sizeof(Render_Command));
+        queue->keys     = (u64 *)realloc(queue->keys, queue->capacity*sizeof(u64));
     }
-    player->input_buffer.start = 0;
-    player->input_buffer.end   = 0;
+
+    u32             index   = queue->count++;
+    Render_Command *command = &queue->commands[index];
+    command->texture        = texture;
+    command->shader         = shader ? *shader : Shader{};
+    command->source         = source;
+    command->dest           = dest;
+    command->origin         = origin;
+    command->tint           = tint;
+
+    u64 key  = (u64)layer << 60;
+    key     |= (u64)(command->shader.id & 0xFFF) << 48;
+    if (RenderLayerSortsTextures(layer)) key |= (u64)(texture.id & 0xFFFF) << 32;
+    key     |= (u64)index;
+    queue->keys[index] = key;
+}
+
+void PushTextureRec(Render_Queue *queue, Render_Layer layer, Shader *shader, Texture2D texture,
+                    Rectangle source, Vector2 pos, Color tint) {
+    Rectangle dest = {pos.x, pos.y, fabsf(source.width), fabsf(source.height)};
+    PushTexturePro(queue, layer, shader, texture, source, dest, {0, 0}, tint);
+}
+
+// Draws the whole sprite, which for anything in the atlas is just its 
+// region and not the whole texture.
+void PushSpriteV(Render_Queue *queue, Render_Layer layer, Shader *shader, Texture_Handle sprite,
+                 Vector2 pos, Color tint) {
+    PushTextureRec(queue, layer, shader, TextureGet(sprite), TextureRegion(sprite), pos, tint);
+}
+
+// Sends everything queued so far out to rlgl. Anything drawn straight after 
+// this (text and so on) goes on top of it.
+void RenderQueueFlush(Render_Queue *queue) {
+    PROFILE_ZONE("RenderQueueFlush");
+    qsort(queue->keys, queue->count, sizeof(u64), CompareRenderKeys);
+
+    b32 in_world  = false;
+    u32 shader_id = 0;
+    for (u32 entry = 0; entry < queue->count; entry++) {
+        Render_Command *command = &queue->commands[queue->keys[entry] & 0xFFFFFFFF];
+        u32             layer   = (u32)(queue->keys[entry] >> 60);
+
+        b32 world = RenderLayerInWorld(layer);
+        if (world != in_world) {
+            if (world) BeginMode2D(queue->camera);
+            else       EndMode2D();
+            in_world = world;
+        }
+        if (command->shader.id != shader_id) {
+            if (shader_id)          EndShaderMode();
+            if (command->shader.id) BeginShaderMode(command->shader);
+            shader_id = command->shader.id;
+            queue->shader_switches++;
+        }
+        DrawTexturePro(command->texture, command->source, command->dest, command->origin, 0.0f, command->tint);
+    }
+    if (shader_id) EndShaderMode();
+    if (in_world)  EndMode2D();
+
+    queue->draws += queue->count;
+    queue->flushes++;
+    queue->count  = 0;
+}
+
+void AnimatorInit(Animation *animator, const char *path, u32 sprite_width, b32 looping) {
+    animator->texture       = TextureAcquire(path);
+    Rectangle region        = TextureRegion(animator->texture);
+    animator->max_frames    = region.width / sprite_width;
+    animator->frame_rec     = {region.x, region.y,
+                               region.width / animator->max_frames,
+                               region.height};
+    animator->current_frame = 0;
+    animator->looping       = looping;
+}
+
+void TilemapInit(Tilemap *tilemap) {
+    tilemap->tile_size   = TILE_SIZE;
+    b32 animation_looping = true;
+    AnimatorInit(&tilemap->fire_animation, "../assets/sprites/fire.png", SPRITE_WIDTH, animation_looping); 
+
+    f32 amplitude = 0.015, frequency = 15.0f, speed = 32.0f;
+    WobbleShaderInit(&tilemap->wobble, amplitude, frequency, speed); 
 }
 
+
 void PlayerAnimatorInit(Player *player) {
     b32 looping = true;
     AnimatorInit(&player->animators[PlayerAnimator_down], "../assets/sprites/hat_down.png", 
@@ -158,21 +637,21 @@ void TitleScreenManagerInit(Title_Screen_Manager *manager) {
     // TODO: Clean this up so that everything initialises into 
     // their direct destination and not into a temporary variable 
     // that is then coppied across.
-    manager->title.texture    = LoadTextureWebSafe("../assets/titles/anunnaki.png");
+    manager->title.texture    = TextureAcquire("../assets/titles/anunnaki.png");
     manager->title.scale      = 2;
     manager->title.pos.x      = (base_screen_width * 0.5) - 
-                                 ((manager->title.texture.width * manager->title.scale) * 0.5);
+                                 ((TextureRegion(manager->title.texture).width * manager->title.scale) * 0.5);
     manager->title.pos.y      = base_screen_height * 0.25;
     manager->title.bob        = 0.0f;
 
-    manager->layer[0].texture = LoadTextureWebSafe("../assets/tiles/layer_1.png");
-    manager->layer[1].texture = LoadTextureWebSafe("../assets/tiles/layer_2.png");
-    manager->layer[2].texture = LoadTextureWebSafe("../assets/tiles/layer_3.png");
-    manager->layer[3].texture = LoadTextureWebSafe("../assets/tiles/layer_4.png");
-    manager->layer[4].texture = LoadTextureWebSafe("../assets/tiles/layer_5.png");
-    manager->layer[5].texture = LoadTextureWebSafe("../assets/tiles/layer_6.png");
-    manager->layer[6].texture = LoadTextureWebSafe("../assets/tiles/layer_7.png");
-    manager->layer[7].texture = LoadTextureWebSafe("../assets/tiles/layer_8.png");
+    manager->layer[0].texture = TextureAcquire("../assets/tiles/layer_1.png");
+    manager->layer[1].texture = TextureAcquire("../assets/tiles/layer_2.png");
+    manager->layer[2].texture = TextureAcquire("../assets/tiles/layer_3.png");
+    manager->layer[3].texture = TextureAcquire("../assets/tiles/layer_4.png");
+    manager->layer[4].texture = TextureAcquire("../assets/tiles/layer_5.png");
+    manager->layer[5].texture = TextureAcquire("../assets/tiles/layer_6.png");
+    manager->layer[6].texture = TextureAcquire("../assets/tiles/layer_7.png");
+    manager->layer[7].texture = TextureAcquire("../assets/tiles/layer_8.png");
 
     f32 pos_y = 0.0f;
     for (u32 index = 0; index < BG_LAYERS; index++) {
@@ -183,14 +662,11 @@ void TitleScreenManagerInit(Title_Screen_Manager *manager) {
         layer->dir              = (index & 1) ? 1 : -1;
         layer->should_wobble    = (index & 1) ? true : false;
         layer->pos              = {0.0f, pos_y};
-        pos_y                  += (f32)layer->texture.height;
+        pos_y                  += TextureRegion(layer->texture).height;
     }
 
     f32 amplitude = 0.06f, frequency = 1.25f, speed = 2.0f;
     WobbleShaderInit(&manager->wobble, amplitude, frequency, speed); 
-    SetShaderValue(manager->wobble.shader, manager->wobble.amplitude_location, &manager->wobble.amplitude, SHADER_UNIFORM_FLOAT);
-    SetShaderValue(manager->wobble.shader, manager->wobble.frequency_location, &manager->wobble.frequency, SHADER_UNIFORM_FLOAT);
-    SetShaderValue(manager->wobble.shader, manager->wobble.speed_location,     &manager->wobble.speed,     SHADER_UNIFORM_FLOAT);
 
     manager->play_text.text      = "Spacebar Begins Ritual";
     manager->play_text.font_size = 14;
@@ -201,8 +677,8 @@ void TitleScreenManagerInit(Title_Screen_Manager *manager) {
 }
 
 void EndScreenInit(End_Screen *screen) {
-    screen->textures[EndLayer_sky]   = LoadTextureWebSafe("../assets/sprites/win_sky.png"); 
-    screen->textures[EndLayer_trees] = LoadTextureWebSafe("../assets/sprites/win_trees.png"); 
+    screen->textures[EndLayer_sky]   = TextureAcquire("../assets/sprites/win_sky.png"); 
+    screen->textures[EndLayer_trees] = TextureAcquire("../assets/sprites/win_trees.png"); 
 
     u32 texture_width     = base_screen_width;
     b32 animation_looping = false;
@@ -217,46 +693,23 @@ void EndScreenInit(End_Screen *screen) {
     f32 amplitude = 0.6f; f32 frequency = 12.0f; f32 speed = 0.05f;
     WobbleShaderInit(&screen->shaders[EndLayer_sky], amplitude, frequency, speed);
     }
-    SetShaderValue(screen->shaders[EndLayer_sky].shader, screen->shaders[EndLayer_sky].amplitude_location, 
-                   &screen->shaders[EndLayer_sky].amplitude, SHADER_UNIFORM_FLOAT);
-    SetShaderValue(screen->shaders[EndLayer_sky].shader, screen->shaders[EndLayer_sky].frequency_location, 
-                   &screen->shaders[EndLayer_sky].frequency, SHADER_UNIFORM_FLOAT);
-    SetShaderValue(screen->shaders[EndLayer_sky].shader, screen->shaders[EndLayer_sky].speed_location,     
-                   &screen->shaders[EndLayer_sky].speed, SHADER_UNIFORM_FLOAT);
 
     {
     f32 amplitude = 0.01f; f32 frequency = 0.7f; f32 speed = 1.0f;
     WobbleShaderInit(&screen->shaders[EndLayer_trees], amplitude, frequency, speed);
     }
-    SetShaderValue(screen->shaders[EndLayer_trees].shader, screen->shaders[EndLayer_trees].amplitude_location, 
-                   &screen->shaders[EndLayer_trees].amplitude, SHADER_UNIFORM_FLOAT);
-    SetShaderValue(screen->shaders[EndLayer_trees].shader, screen->shaders[EndLayer_trees].frequency_location, 
-                   &screen->shaders[EndLayer_trees].frequency, SHADER_UNIFORM_FLOAT);
-    SetShaderValue(screen->shaders[EndLayer_trees].shader, screen->shaders[EndLayer_trees].speed_location,     
-                   &screen->shaders[EndLayer_trees].speed, SHADER_UNIFORM_FLOAT);
 }
 
 void LoadSoundBuffer(Sound *sound) {
-    sound[SoundEffect_powerup]         = LoadSound("../assets/sounds/powerup.wav");
-    sound[SoundEffect_powerup_end]     = LoadSound("../assets/sounds/powerup_end.wav");
-    sound[SoundEffect_powerup_collect] = LoadSound("../assets/sounds/powerup_collect.wav");
-    sound[SoundEffect_powerup_appear]  = LoadSound("../assets/sounds/powerup_appear.wav");
-    sound[SoundEffect_spacebar]        = LoadSound("../assets/sounds/start.wav");
+    for (u32 index = 0; index < SoundEffect_count; index++) {
+        sound[index] = LoadSoundAsset(g_sfx_paths[index]);
+    }
 }
 
 void LoadHypeSoundBuffer(Sound *sound) {
-    sound[0]  = LoadSound("../assets/sounds/hype_1.wav");
-    sound[1]  = LoadSound("../assets/sounds/hype_2.wav");
-    sound[2]  = LoadSound("../assets/sounds/hype_3.wav");
-    sound[3]  = LoadSound("../assets/sounds/hype_4.wav");
-    sound[4]  = LoadSound("../assets/sounds/hype_5.wav");
-    sound[5]  = LoadSound("../assets/sounds/hype_6.wav");
-    sound[6]  = LoadSound("../assets/sounds/hype_7.wav");
-    sound[7]  = LoadSound("../assets/sounds/hype_8.wav");
-    sound[8]  = LoadSound("../assets/sounds/hype_9.wav");
-    sound[9]  = LoadSound("../assets/sounds/hype_10.wav");
-    sound[10] = LoadSound("../assets/sounds/hype_11.wav");
-    sound[11] = LoadSound("../assets/sounds/hype_12.wav");
+    for (u32 index = 0; index < HYPE_WORD_COUNT; index++) {
+        sound[index] = LoadSoundAsset(g_hype_paths[index]);
+    }
 }
 
 void StopSoundBuffer(Sound *sounds) {
@@ -297,6 +750,26 @@ void UnloadAllSoundBuffers(Game_Manager *manager) {
     }
 }
 
+// Swaps a fresh copy of path off the disk in for whichever sound effect was
+// loaded from it. The old one gets stopped if it was playing.
+b32 SoundReload(Game_Manager *manager, const char *path) {
+    Sound *sound = NULL;
+    for (u32 index = 0; index < SoundEffect_count; index++) {
+        if (TextIsEqual(g_sfx_paths[index], path)) sound = &manager->sounds[index];
+    }
+    for (u32 index = 0; index < HYPE_WORD_COUNT; index++) {
+        if (TextIsEqual(g_hype_paths[index], path)) sound = &manager->hype_sounds[index];
+    }
+    if (!sound) return false;
+
+    Sound loaded = LoadSound(path);
+    if (!IsSoundReady(loaded)) return false;
+    StopSound(*sound);
+    UnloadSound(*sound);
+    *sound = loaded;
+    return true;
+}
+
 void SpacebarTextInit(Spacebar_Text *text) {
     text->text = "Press Spacebar";
     text->size = 7;
@@ -310,12 +783,13 @@ void GameManagerInit(Game_Manager *manager) {
     manager->happy_score            = 10000;
     manager->satisfied_score        = 2500;
     manager->score_multiplier       = 1;
-    manager->frame_counter          = 0;
+    manager->anim_timer             = 0;
+    manager->anim_steps             = 0;
     manager->fire_cleared           = false;
 
-    manager->atlas[Atlas_tile]      = LoadTextureWebSafe("../assets/tiles/tile_row.png");
-    manager->atlas[Atlas_wall]      = LoadTextureWebSafe("../assets/tiles/wall_tiles.png");
-    manager->gui.bar                = LoadTextureWebSafe("../assets/tiles/bar.png");
+    manager->atlas[Atlas_tile]      = TextureAcquire("../assets/tiles/tile_row.png");
+    manager->atlas[Atlas_wall]      = TextureAcquire("../assets/tiles/wall_tiles.png");
+    manager->gui.bar                = TextureAcquire("../assets/tiles/bar.png");
     manager->gui.anim_timer         = 0;
     manager->gui.anim_duration      = 4.0f;
     manager->gui.step               = 0.0f;
@@ -331,22 +805,27 @@ void GameManagerInit(Game_Manager *manager) {
 
     manager->state                   = GameState_title;
 
-    manager->enemy_spawn_duration    = 510.0f; // TODO: This should be in seconds.
-    manager->enemy_move_duration     = 250.0f; // TODO: This should be in seconds.
+    manager->enemy_spawn_duration    = 8.5f;
+    manager->enemy_move_duration     = 4.2f;
     manager->spawn_timer             = manager->enemy_spawn_duration;
     manager->enemy_move_timer        = manager->enemy_move_duration;
 
 #if !defined(PLATFORM_WEB)
-    manager->song[Song_play]         = LoadMusicStream("../assets/sounds/music.wav");
-    manager->song[Song_play_muted]   = LoadMusicStream("../assets/sounds/music_muted.wav");
-    manager->song[Song_tutorial]     = LoadMusicStream("../assets/sounds/tutorial_track.wav");
-    manager->song[Song_intro]        = LoadMusicStream("../assets/sounds/intro_music.wav");
-    manager->song[Song_win]          = LoadMusicStream("../assets/sounds/win_track.wav");
-
-    SetMusicVolume(manager->song[Song_play], manager->play_song_volume);
-    SetMusicVolume(manager->song[Song_play_muted], manager->play_muted_song_volume);
+    // NOTE: The play music and its muted version are stems of one group so
+    // they stay locked together through the crossfade. They're added in
+    // song order so Song_play and Song_play_muted are their stem indices.
+    for (u32 index = Song_play; index <= Song_play_muted; index++) {
+        s32 size   = 0;
+        u8 *data   = LoadFileAsset(g_song_paths[index], &size);
+        b32 added  = StemGroupAdd(&manager->play_stems, g_song_paths[index], data, size,
+                                  index == Song_play ? 1.0f : 0.0f);
+        ASSERT(added);
+    }
+
     // Set all the songs in the song buffer to loop
     for (u32 index = 0; index < Song_count; index++) {
+        if (index == Song_play || index == Song_play_muted) continue;
+        manager->song[index]         = LoadMusicAsset(g_song_paths[index]);
         ASSERT(IsMusicReady(manager->song[index]));
         manager->song[index].looping = true;
     }
@@ -358,12 +837,11 @@ void GameManagerInit(Game_Manager *manager) {
     manager->hype_prev_index         = 0;
 #else
     WebAudioSfxInit();
+    WebAudioPreloadSfxAssets();
     for (int i = 0; i < (int)SoundEffect_count; i++) {
-        WebAudioSfxPreload(i, g_sfx_paths[i]);
         WebAudioSfxSetVolume(i, 1.0f);
     }
     for (int i = 0; i < (int)HYPE_WORD_COUNT; i++) {
-        WebAudioSfxPreload(HYPE_SFX_BASE + i, g_hype_paths[i]);
         WebAudioSfxSetVolume(HYPE_SFX_BASE + i, 2.5f);
     }
 #endif
@@ -383,6 +861,12 @@ void GameManagerInit(Game_Manager *manager) {
     manager->powerup_sentinel.next   = &manager->powerup_sentinel;
     manager->powerup_sentinel.prev   = &manager->powerup_sentinel;
 
+    AnimatorInit(&manager->enemy_animators[EnemyAnimator_idle], "../assets/sprites/demon.png", 
+                 SPRITE_WIDTH, true);
+    AnimatorInit(&manager->enemy_animators[EnemyAnimator_destroy], "../assets/sprites/disappear.png", 
+                 SPRITE_WIDTH, false);
+    AnimatorInit(&manager->powerup_animator, "../assets/sprites/bowl.png", SPRITE_WIDTH, true);
+
     manager->screen_shake.intensity  = 0;
     manager->screen_shake.duration   = 0;
     manager->screen_shake.decay      = 0;
@@ -392,160 +876,265 @@ void GameManagerInit(Game_Manager *manager) {
     SpacebarTextInit(&manager->spacebar_text);
 }
 
-void PowerupInit(Powerup *powerup, Powerup *sentinel, Tile *tile) {
-    powerup->tile       = tile;
-    powerup->next       = sentinel->next;
-    powerup->prev       = sentinel;
-    powerup->next->prev = powerup;
-    powerup->prev->next = powerup;
-    AnimatorInit(&powerup->animator, "../assets/sprites/bowl.png", SPRITE_WIDTH, true);
-}
-
-void EnemyInit(Enemy *enemy, Enemy *sentinel, u32 tile_index) {
-    enemy->tile_index = tile_index;
-    enemy->next       = sentinel->next;
-    enemy->prev       = sentinel;
-    enemy->next->prev = enemy;
-    enemy->prev->next = enemy;
-    AnimatorInit(&enemy->animators[EnemyAnimator_idle], "../assets/sprites/demon.png", SPRITE_WIDTH, true);
-    AnimatorInit(&enemy->animators[EnemyAnimator_destroy], "../assets/sprites/disappear.png", SPRITE_WIDTH, false);
-}
-
 void TutorialAnimationInit(Tutorial_Entities *entities) {
     AnimatorInit(&entities->enemy,   "../assets/sprites/demon.png", SPRITE_WIDTH, true);
     AnimatorInit(&entities->powerup, "../assets/sprites/bowl.png",  SPRITE_WIDTH, true);
     AnimatorInit(&entities->fire,    "../assets/sprites/fire.png",  SPRITE_WIDTH, true);
 }
 
-void ResetEvents(Event_Manager *manager) {
-    manager->sequence[Sequence_epilogue] = manager->original_sequence[Sequence_epilogue];
-    manager->sequence[Sequence_win]      = manager->original_sequence[Sequence_win];
-    manager->sequence[Sequence_tutorial] = manager->original_sequence[Sequence_tutorial];
-    manager->sequence[Sequence_begin]    = manager->original_sequence[Sequence_begin];
+static const char *g_sequence_names[Sequence_count] = {
+    "win",      // Sequence_win
+    "tutorial", // Sequence_tutorial
+    "begin",    // Sequence_begin
+    "epilogue", // Sequence_epilogue
 };
 
-void SetupEventSequences(Event_Manager *manager) {
-    // All of this initialisation is for the original base sequences 
-    // so that the actual sequence copies that will ultimately have their  
-    // values changed can reset back to these defaults at the end. 
-    // The final ResetEvent() call at the end of this sets the actual 
-    // events to their base value at the end of this initialisation.
-    
-    // The epilogue press spacebar sequence.
-    manager->original_sequence[Sequence_epilogue].events[0]          = {EventType_wait, 6.0f, 0, 0, 0};
-    manager->original_sequence[Sequence_epilogue].events[1].type     = EventType_fade_in;
-    manager->original_sequence[Sequence_epilogue].events[1].duration = 2.0f;
-    manager->original_sequence[Sequence_epilogue].events[1].fadeable = {};
-    manager->original_sequence[Sequence_epilogue].count              = 2;
-    manager->original_sequence[Sequence_epilogue].active             = false;
-
-    // Setup the winning event sequence.
-    manager->original_sequence[Sequence_win].events[1].type           = EventType_fade_in;
-    manager->original_sequence[Sequence_win].events[1].duration       = 1.0f;
-    manager->original_sequence[Sequence_win].events[1].fadeable       = {};
-    manager->original_sequence[Sequence_win].events[2]                = {EventType_wait, 2.0f, 0, 0, 0};
-    manager->original_sequence[Sequence_win].events[2].fadeable.alpha = 1.0f;
-    manager->original_sequence[Sequence_win].events[3].type           = EventType_fade_in;
-    manager->original_sequence[Sequence_win].events[3].duration       = 2.0f;
-    manager->original_sequence[Sequence_win].events[3].fadeable       = {};
-    manager->original_sequence[Sequence_win].count                    = 4;
-    manager->original_sequence[Sequence_win].active                   = false;
-
-    // The tutorial screen sequence.
-    manager->original_sequence[Sequence_tutorial].events[0].type     = EventType_fade_in;
-    manager->original_sequence[Sequence_tutorial].events[0].duration = 2.0f;
-    manager->original_sequence[Sequence_tutorial].events[0].fadeable = {};
-    manager->original_sequence[Sequence_tutorial].events[1].type     = EventType_fade_in;
-    manager->original_sequence[Sequence_tutorial].events[1].duration = 2.5f;
-    manager->original_sequence[Sequence_tutorial].events[1].fadeable = {};
-    manager->original_sequence[Sequence_tutorial].events[2].type     = EventType_fade_in;
-    manager->original_sequence[Sequence_tutorial].events[2].duration = 2.5f;
-    manager->original_sequence[Sequence_tutorial].events[2].fadeable = {};
-    manager->original_sequence[Sequence_tutorial].events[3]          = {EventType_wait, 2.5f, 0, 0, 0};
-    manager->original_sequence[Sequence_tutorial].events[4].type     = EventType_fade_in;
-    manager->original_sequence[Sequence_tutorial].events[4].duration = 2.0f;
-    manager->original_sequence[Sequence_tutorial].events[4].fadeable = {};
-    manager->original_sequence[Sequence_tutorial].count              = 5;
-    manager->original_sequence[Sequence_tutorial].active             = false;
-
-    // The sequence when the spacebar is pressed at the title screen 
-    // to begin the game.
-    manager->original_sequence[Sequence_begin].events[0] = {EventType_wait, 1.0f};
-    manager->original_sequence[Sequence_begin].events[1] = {EventType_state_change, 0, GameState_tutorial};
-    manager->original_sequence[Sequence_begin].count     = 2;
-    manager->original_sequence[Sequence_begin].active    = false;
-
-    // I need to call this function here to make sure that the 
-    // actual event sequences that get used are set to the base 
-    // values that have just been set up above.
-    ResetEvents(manager);
-}
+static const char *g_game_state_names[] = {
+    "play",     // GameState_play
+    "lose",     // GameState_lose
+    "win",      // GameState_win
+    "title",    // GameState_title
+    "win_text", // GameState_win_text
+    "epilogue", // GameState_epilogue
+    "tutorial", // GameState_tutorial
+};
 
-Enemy *FindEnemyAtTile(Enemy *sentinel, u32 index)
-{
-    Enemy *result = NULL;
-    for (Enemy *enemy_to_find = sentinel->next; 
-         enemy_to_find != sentinel; 
-         enemy_to_find = enemy_to_find->next) {
-        if (enemy_to_find->tile_index == index) {
-            result = enemy_to_find;
-            break;
+// The fades each screen draws with, asked for by name in UpdateAndDrawFrame().
+// A file that leaves one out doesn't compile, the prompt would never show.
+static const char *g_screen_fades[Sequence_count][TIMELINE_MAX_FADES] = {
+    {"message", "spacebar"},                  // Sequence_win
+    {"demon", "powerup", "fire", "spacebar"}, // Sequence_tutorial
+    {},                                       // Sequence_begin
+    {"spacebar"},                             // Sequence_epilogue
+};
+
+// NOTE: What the game falls back on when EVENTS_PATH is missing or doesn't
+// compile. It isn't a copy of the file and shouldn't be kept in step with
+// it, it's the least that gets every screen working: the title goes 
+// straight to the tutorial and the prompts all come in quickly one after
+// the other.
+static const char g_default_events[] =
+    "sequence begin\n state tutorial\n"
+    "sequence tutorial\n fade_in demon 0.5\n fade_in powerup 0.5\n fade_in fire 0.5\n fade_in spacebar 0.5\n"
+    "sequence win\n fade_in message 0.5\n fade_in spacebar 0.5\n"
+    "sequence epilogue\n fade_in spacebar 0.5\n";
+
+s32 FindName(const char **names, u32 count, const char *name) {
+    for (u32 index = 0; index < count; index++) {
+        if (strcmp(names[index], name) == 0) return (s32)index;
+    }
+    return -1;
+}
+
+// Turns the text of an events file into a timeline, see assets/events.txt
+// for what goes in one. Each sequence's events end up next to each other so
+// a sequence is just a range. Anything wrong gets logged with its line and
+// the timeline is left half built, so compile into a spare one. On top of 
+// parsing, every sequence has to be there with the fades its screen draws,
+// and begin has to end in a state change since it's the only way off the 
+// title screen.
+b32 EventTimelineCompile(Timeline *timeline, const char *text, size_t size) {
+    *timeline = {};
+    Timeline_Sequence *sequence             = NULL;
+    b32                seen[Sequence_count] = {};
+    const char        *at                   = text;
+    const char        *end                  = text + size;
+    u32                line_number          = 0;
+    while (at < end) {
+        char line[256];
+        u32  length = 0;
+        while (at < end && *at != '\n') {
+            if (length + 1 < sizeof(line)) line[length++] = *at;
+            at++;
+        }
+        line[length] = 0;
+        at++;
+        line_number++;
+
+        char *comment = strchr(line, '#');
+        if (comment) *comment = 0;
+
+        char command[TIMELINE_NAME_MAX], name[TIMELINE_NAME_MAX];
+        f32  duration = 0.0f;
+        if (sscanf(line, "%15s", command) != 1) continue;
+
+        if (strcmp(command, "sequence") == 0) {
+            s32 found = sscanf(line, "%*s %15s", name) == 1 ? FindName(g_sequence_names, Sequence_count, name) : -1;
+            if (found < 0 || seen[found]) {
+                TraceLog(LOG_WARNING, "EVENTS: Line %u names a sequence that isn't one or already came up", line_number);
+                return false;
+            }
+            seen[found]     = true;
+            sequence        = &timeline->sequences[found];
+            sequence->first = timeline->event_count;
+            continue;
+        }
+        if (!sequence) {
+            TraceLog(LOG_WARNING, "EVENTS: Line %u comes before any sequence", line_number);
+            return false;
+        }
+        if (timeline->event_count == TIMELINE_MAX_EVENTS) {
+            TraceLog(LOG_WARNING, "EVENTS: Line %u is past the %d events a timeline holds", line_number, TIMELINE_MAX_EVENTS);
+            return false;
+        }
+
+        Timeline_Event event = {};
+        if (strcmp(command, "wait") == 0) {
+            if (sscanf(line, "%*s %f", &duration) != 1 || duration < 0.0f) {
+                TraceLog(LOG_WARNING, "EVENTS: Line %u needs a wait time", line_number);
+                return false;
+            }
+            event = {EventType_wait, duration, 0};
+        } else if (strcmp(command, "fade_in") == 0 || strcmp(command, "fade_out") == 0) {
+            if (sscanf(line, "%*s %15s %f", name, &duration) != 2 || duration <= 0.0f) {
+                TraceLog(LOG_WARNING, "EVENTS: Line %u needs a fade name and a time above zero", line_number);
+                return false;
+            }
+            s32 fade = -1;
+            for (u32 index = 0; index < sequence->fade_count; index++) {
+                if (strcmp(sequence->fade_names[index], name) == 0) fade = (s32)index;
+            }
+            if (fade < 0) {
+                if (sequence->fade_count == TIMELINE_MAX_FADES) {
+                    TraceLog(LOG_WARNING, "EVENTS: Line %u is past the %d fades a sequence can have", line_number, TIMELINE_MAX_FADES);
+                    return false;
+                }
+                fade = (s32)sequence->fade_count++;
+                snprintf(sequence->fade_names[fade], TIMELINE_NAME_MAX, "%s", name);
+            }
+            event = {command[5] == 'i' ? EventType_fade_in : EventType_fade_out, duration, (u32)fade};
+        } else if (strcmp(command, "state") == 0) {
+            s32 state = sscanf(line, "%*s %15s", name) == 1 ? 
+                        FindName(g_game_state_names, ARRAY_COUNT(g_game_state_names), name) : -1;
+            if (state < 0) {
+                TraceLog(LOG_WARNING, "EVENTS: Line %u needs a game state", line_number);
+                return false;
+            }
+            event = {EventType_state_change, 0.0f, (u32)state};
+        } else {
+            TraceLog(LOG_WARNING, "EVENTS: Line %u has %s, which isn't a command", line_number, command);
+            return false;
+        }
+        timeline->events[timeline->event_count++] = event;
+        sequence->count++;
+    }
+
+    for (u32 index = 0; index < Sequence_count; index++) {
+        if (!seen[index]) {
+            TraceLog(LOG_WARNING, "EVENTS: There's no %s sequence", g_sequence_names[index]);
+            return false;
+        }
+        Timeline_Sequence *checked = &timeline->sequences[index];
+        for (u32 wanted = 0; wanted < TIMELINE_MAX_FADES && g_screen_fades[index][wanted]; wanted++) {
+            b32 found = false;
+            for (u32 fade = 0; fade < checked->fade_count; fade++) {
+                if (strcmp(checked->fade_names[fade], g_screen_fades[index][wanted]) == 0) found = true;
+            }
+            if (!found) {
+                TraceLog(LOG_WARNING, "EVENTS: The %s sequence needs a %s fade", 
+                         g_sequence_names[index], g_screen_fades[index][wanted]);
+                return false;
+            }
         }
     }
+    Timeline_Sequence *begin = &timeline->sequences[Sequence_begin];
+    if (!begin->count || timeline->events[begin->first + begin->count - 1].type != EventType_state_change) {
+        TraceLog(LOG_WARNING, "EVENTS: The begin sequence has to end in a state change");
+        return false;
+    }
+    return true;
+}
+
+// NOTE: A loose file wins over the one in the pack so there's something to
+// edit on desktop, the web build only has the pack.
+b32 EventTimelineLoad(Event_Manager *manager, Timeline *timeline) {
+    b32   result = false;
+    s32   size   = 0;
+    b32   loose  = FileExists(EVENTS_PATH);
+    void *data   = NULL;
+    if (loose) {
+        data = LoadFileData(EVENTS_PATH, &size);
+        manager->mod_time = GetFileModTime(EVENTS_PATH);
+    } else {
+        Asset_Pack_Entry *entry = AssetLibraryFind(&g_asset_library, EVENTS_PATH, AssetKind_file, &data);
+        if (entry) size = (s32)entry->size;
+    }
+    if (data) {
+        result = EventTimelineCompile(timeline, (const char *)data, (size_t)size);
+        if (loose) UnloadFileData((u8 *)data);
+    } else {
+        TraceLog(LOG_WARNING, "EVENTS: Couldn't find %s", EVENTS_PATH);
+    }
     return result;
 }
 
-Powerup *FindPowerupInList(Powerup *sentinel, Tile *tile)
-{
-    Powerup *powerup_to_find = sentinel->next;
-    bool powerup_found = false;
-    while (powerup_to_find != sentinel) {
-        if (powerup_to_find->tile == tile) {
-            powerup_found = true;
-            break;
-        } else {
-            powerup_to_find = powerup_to_find->next;
-        }
+void ResetEvents(Event_Manager *manager) {
+    for (u32 index = 0; index < Sequence_count; index++) {
+        Event_Cursor *cursor = &manager->cursors[index];
+        // NOTE: Zeroing the fades clears their fade_slot too, so any that 
+        // are still running get dropped by UpdateAlphaFade().
+        *cursor          = {};
+        cursor->sequence = (Event_Sequence)index;
+        cursor->timeline = &manager->timeline;
     }
+}
 
-    if (!powerup_found) {
-        powerup_to_find = NULL;
+void SetupEventSequences(Event_Manager *manager) {
+    if (!EventTimelineLoad(manager, &manager->timeline)) {
+        TraceLog(LOG_WARNING, "EVENTS: Using the built in sequences instead");
+        EventTimelineCompile(&manager->timeline, g_default_events, sizeof(g_default_events) - 1);
     }
-    return powerup_to_find;
+    ResetEvents(manager);
 }
 
-void DeleteEnemyInList(Enemy *sentinel, u32 index)
-{
-    Enemy *enemy_to_delete = sentinel->next;
-    bool enemy_found = false;
-    while (enemy_to_delete != sentinel) {
-        if (enemy_to_delete->tile_index == index) {
-            enemy_to_delete->prev->next = enemy_to_delete->next;
-            enemy_to_delete->next->prev = enemy_to_delete->prev;
-            enemy_found = true;
-            break;
+#if !defined(PLATFORM_WEB)
+// Every so often looks at whether EVENTS_PATH changed and compiles it again
+// if it did. The running sequences keep their place, clamped to the new 
+// lengths, and an edit that doesn't compile leaves the old timeline alone.
+// NOTE: A cursor's fades go by where the name first came up in the 
+// sequence, so if the edit changed which fades a sequence has or their 
+// order that sequence starts over instead of carrying an alpha across to 
+// something else.
+void EventTimelineReload(Event_Manager *manager, f32 delta_t) {
+    manager->reload_timer += delta_t;
+    if (manager->reload_timer < TIMELINE_RELOAD_INTERVAL) return;
+    manager->reload_timer = 0.0f;
+
+    if (!FileExists(EVENTS_PATH) || GetFileModTime(EVENTS_PATH) == manager->mod_time) return;
+
+    Timeline timeline = {};
+    if (!EventTimelineLoad(manager, &timeline)) {
+        TraceLog(LOG_WARNING, "EVENTS: Keeping the sequences from before the edit");
+        return;
+    }
+    for (u32 index = 0; index < Sequence_count; index++) {
+        Event_Cursor      *cursor   = &manager->cursors[index];
+        Timeline_Sequence *old      = &manager->timeline.sequences[index];
+        Timeline_Sequence *sequence = &timeline.sequences[index];
+        b32 same_fades = old->fade_count == sequence->fade_count &&
+                         memcmp(old->fade_names, sequence->fade_names, sizeof(old->fade_names)) == 0;
+        if (same_fades) {
+            if (cursor->index > sequence->count) cursor->index = sequence->count;
         } else {
-            enemy_to_delete = enemy_to_delete->next;
+            // NOTE: Zeroed fades lose their fade_slot, see ResetEvents().
+            *cursor          = {};
+            cursor->sequence = (Event_Sequence)index;
+            cursor->timeline = &manager->timeline;
         }
     }
-    ASSERT(enemy_found);
+    manager->timeline = timeline;
+    TraceLog(LOG_INFO, "EVENTS: Reloaded %s, %u events", EVENTS_PATH, timeline.event_count);
 }
+#endif
 
-void DeletePowerupInList(Powerup *sentinel, Tile *tile)
-{
-    Powerup *powerup_to_delete = sentinel->next;
-    bool powerup_found         = false;
-    while (powerup_to_delete != sentinel) {
-        if (powerup_to_delete->tile == tile) {
-            powerup_to_delete->prev->next = powerup_to_delete->next;
-            powerup_to_delete->next->prev = powerup_to_delete->prev;
-            powerup_found = true;
-            break;
-        } else { 
-            powerup_to_delete = powerup_to_delete->next;
-        }
+// The alpha of one of the sequence's fades. EventTimelineCompile() makes sure
+// the ones in g_screen_fades are there, anything else comes back zero.
+f32 EventFadeAlpha(Event_Cursor *cursor, const char *name) {
+    const Timeline_Sequence *sequence = &cursor->timeline->sequences[cursor->sequence];
+    for (u32 index = 0; index < sequence->fade_count; index++) {
+        if (strcmp(sequence->fade_names[index], name) == 0) return cursor->fades[index].alpha;
     }
-    ASSERT(powerup_found);
+    return 0.0f;
 }
 
 void UpdateScreenShake(Screen_Shake *shake, f32 delta_t)
@@ -562,24 +1151,18 @@ void UpdateScreenShake(Screen_Shake *shake, f32 delta_t)
     }
 }
 
-Vector2 GetScreenShakeOffset(Screen_Shake *shake)
+Vector2 GetScreenShakeOffset(Screen_Shake *shake, Random_Series *random)
 {
     Vector2 result = {0.0f, 0.0f};
     if (shake->duration > 0.0f)
     {
-        f32 offset_x = (GetRandomValue(-100, 100) / 100.0f) * shake->intensity;
-        f32 offset_y = (GetRandomValue(-100, 100) / 100.0f) * shake->intensity;
+        f32 offset_x = (RandomRange(random, -100, 100) / 100.0f) * shake->intensity;
+        f32 offset_y = (RandomRange(random, -100, 100) / 100.0f) * shake->intensity;
         result = {offset_x, offset_y};
     }
     return result;
 }
 
-void BeginScreenShake(Screen_Shake *shake, f32 intensity, f32 duration, f32 decay) {
-    shake->intensity = intensity;
-    shake->duration  = duration;
-    shake->decay     = decay;
-}
-
 void TriggerTitleBob(Game_Title *title, f32 impulse) {
     title->bob_velocity += impulse;
 }
@@ -601,341 +1184,82 @@ void StopAllTextBursts(Game_Manager *manager) {
     }
 }
 
-void GameOver(Player *player, Tilemap *tilemap,  Game_Manager *manager) {
-    PlayerInit(player);
-    manager->state            = GameState_play;
-    manager->score            = 0;
-    manager->score_multiplier = 0;
-
-    StopSoundBuffer(manager->sounds);
-
-    // Delete all enemies and powerups from the enemy/powerup linked lists.
-    manager->enemy_sentinel.next = &manager->enemy_sentinel;
-    manager->enemy_sentinel.prev = &manager->enemy_sentinel;
-    manager->powerup_sentinel.next = &manager->powerup_sentinel;
-    manager->powerup_sentinel.prev = &manager->powerup_sentinel;
-    manager->fade_count = 0;
-
-    // Reset the tilemap back to it's original orientation
-    TileInit(tilemap);
+Rectangle SetAtlasFrameRec(Texture_Handle atlas, Tile_Type type, u32 seed) {
+    Rectangle region    = TextureRegion(atlas);
+    Rectangle frame_rec = {region.x, region.y, TILE_SIZE, TILE_SIZE};
+    switch (type) {
+        case TileType_wall:
+        case TileType_floor: {
+            frame_rec.x = region.x + seed * TILE_SIZE;
+            frame_rec.y = region.y;
+        } break;
+        default: {
+        } break;
+    }
+    return frame_rec;
 }
 
-inline void AddFlag(Tile *tile, u32 flag) {
-    tile->flags |= flag;
-}
+// anim_steps is how many animation frames have elapsed since the last
+// time this got called, see the animation clock in UpdateAndDrawFrame().
+void Animate(Animation *animator, u32 anim_steps) {
+    animator->current_frame += anim_steps;
+        
+    if (animator->current_frame >= animator->max_frames) {
+        if (animator->looping) {
+            animator->current_frame %= animator->max_frames;
+        } else { 
+            animator->current_frame = animator->max_frames - 1;
+        }
+    }
 
-inline void ClearFlag(Tile *tile, u32 flag) {
-    tile->flags &= ~flag;
+    // NOTE: Frames run left to right from the start of the sprite's 
+    // region, which is only at zero when it isn't in the atlas. The region
+    // can move if TextureReload() takes the sprite off the atlas.
+    Rectangle region      = TextureRegion(animator->texture);
+    animator->frame_rec.x = region.x + (f32)animator->current_frame * animator->frame_rec.width;
+    animator->frame_rec.y = region.y;
 }
 
-b32 IsFlagSet(Tile *tile, u32 flag) {
-    b32 result = tile->flags & flag;
+Direction_Facing KeyToDirection(s32 key) {
+    Direction_Facing result;
+    switch(key) {
+        case KEY_UP:    case KEY_W: result = DirectionFacing_up;    break;
+        case KEY_DOWN:  case KEY_S: result = DirectionFacing_down;  break;
+        case KEY_LEFT:  case KEY_A: result = DirectionFacing_left;  break;
+        case KEY_RIGHT: case KEY_D: result = DirectionFacing_right; break;
+        default:                    result = DirectionFacing_none;  break;
+    }
     return result;
 }
 
-void CheckEnclosedAreasFromPlayerPosition(Tilemap *tilemap, u32 start_x, u32 start_y) {
-    StackU32 nodes;
-    StackInit(&nodes);
-
-    StackPush(&nodes, start_x, start_y);
-
-    u32 x, y;
-
-    // Flood fill from players position
-    while(StackPop(&nodes, &x, &y)) {
-        if (x >= (u32)tilemap->width || y >= tilemap->height) continue;
-
-        u32 index = TilemapIndex(x, y, tilemap->width);
-        Tile *tile = &tilemap->tiles[index];
-
-        if (IsFlagSet(tile, TileFlag_visited)) continue;
-        if (tile->type != TileType_floor)      continue;
-        if (IsFlagSet(tile, TileFlag_fire))    continue;
-        //if (x == start_x && y == start_y) continue;
-
-        AddFlag(tile, TileFlag_visited);
+void GatherInputFrame(Input_Frame *input) {
+    *input = {};
+    s32 key;
+    while ((key = GetKeyPressed()) != 0) {
+        Direction_Facing dir = KeyToDirection(key);
+        if (dir == DirectionFacing_none) continue;
 
-        // Add adjacent tiles 
-        StackPush(&nodes, x+1, y);
-        StackPush(&nodes, x-1, y);
-        StackPush(&nodes, x, y+1);
-        StackPush(&nodes, x, y-1);
+        if (input->direction_count < INPUT_FRAME_MAX) {
+            input->directions[input->direction_count] = dir;
+            input->direction_count++;
+        }
     }
-} 
-
-u32 GetRandomEmptyTileIndex(Tilemap *tilemap) {
-    bool found_empty_tile = false;
-    u32 index             = 0;
-    u32 attempts          = 10;
-
-    // TODO: Right now it just randomly picks from all tiles 
-    // it doesn't take into account whether the tile has fire or is 
-    // eligible in any way. It randomly chooses and then checks to see 
-    // if the tile is empty. It will try this 10 times before giving up. 
-    // However if the board is majoritively willed with fire there's a solid 
-    // chance that no tile will ever be picked. Perhaps a better way to do this 
-    // is do a pass over all the tiles, and store the eligible tile indexes 
-    // into an array and then randomly choose an index from there. That way I 
-    // can ensure that if a tile can be chosen it always will be.
-    while (!found_empty_tile && attempts != 0) {
-        u32 random_x = GetRandomValue(1, tilemap->width - 2);
-        u32 random_y = GetRandomValue(2, tilemap->height - 2);
-
-        index = TilemapIndex(random_x, random_y, tilemap->width);
-        Tile *tile = &tilemap->tiles[index];
+    input->space_pressed = IsKeyPressed(KEY_SPACE);
+}
 
-        if (!IsFlagSet(tile, TileFlag_fire) && !IsFlagSet(tile, TileFlag_powerup) && 
-            !IsFlagSet(tile, TileFlag_enemy)) {
-            found_empty_tile = true;
-        } else {
-            attempts--;
-            index = 0;
+// Folds a frame's worth of input into input that hasn't been handed to 
+// the sim yet, so nothing gets dropped on frames where no sim step runs.
+void MergeInputFrame(Input_Frame *pending, Input_Frame *input) {
+    for (u32 index = 0; index < input->direction_count; index++) {
+        if (pending->direction_count < INPUT_FRAME_MAX) {
+            pending->directions[pending->direction_count] = input->directions[index];
+            pending->direction_count++;
         }
     }
-
-    return index;
+    pending->space_pressed |= input->space_pressed;
 }
 
-u32 GetRandomEmptyTileIndex(Tilemap *tilemap, u32 tile_index) {
-    bool found_empty_tile = false;
-    u32 index             = 0;
-    u32 attempts          = 10;
-
-    u32 right_tile  = tile_index + 1;
-    u32 left_tile   = tile_index - 1;
-    u32 bottom_tile = tile_index + tilemap->width;
-    u32 top_tile    = tile_index - tilemap->width;
-
-    while (!found_empty_tile && attempts != 0) {
-        u32 random_x = GetRandomValue(1, tilemap->width - 2);
-        u32 random_y = GetRandomValue(2, tilemap->height - 2);
-
-        index = TilemapIndex(random_x, random_y, tilemap->width);
-        Tile *tile = &tilemap->tiles[index];
-
-        if (!IsFlagSet(tile, TileFlag_fire) && !IsFlagSet(tile, TileFlag_powerup) && 
-            !IsFlagSet(tile, TileFlag_enemy)) {
-            if (index != right_tile  && index != left_tile &&
-                index != bottom_tile && index != top_tile) {
-                found_empty_tile = true;
-            } else {
-                attempts--;
-                index = 0;
-            }
-        }
-    }
-
-    return index;
-}
-
-u32 FindEligibleTileIndexForEnemyMove(Tilemap *tilemap, u32 index) {
-    u32 right_tile   = index + 1;
-    u32 left_tile    = index - 1;
-    u32 bottom_tile  = index + tilemap->width;
-    u32 top_tile     = index - tilemap->width;
-
-    const u32 adjacent_count = 4;
-    u32 adjacent_tile_indexes[adjacent_count] = {right_tile, left_tile, bottom_tile, top_tile};
-    u32 eligible_tiles[adjacent_count] = {};
-    u32 eligible_count = 0;
-    u32 result = 0;
-
-    for (int adjacent_index = 0; adjacent_index < ARRAY_COUNT(adjacent_tile_indexes); adjacent_index++) {
-        Tile *tile = &tilemap->tiles[adjacent_tile_indexes[adjacent_index]];
-
-        if(tile->type == TileType_floor) {
-            if (!IsFlagSet(tile, TileFlag_fire) && !IsFlagSet(tile, TileFlag_powerup) && 
-                !IsFlagSet(tile, TileFlag_enemy)) {
-                eligible_tiles[eligible_count] = adjacent_tile_indexes[adjacent_index];
-                eligible_count++;
-            }
-        }
-    }
-
-    if (eligible_count) {
-        u32 eligible_index = eligible_count - 1;
-        u32 random_index = GetRandomValue(0, eligible_index);
-        result = eligible_tiles[random_index];
-    }
-
-    return result;
-}
-
-void FillEnclosedAreas(Memory_Arena *arena, Tilemap *tilemap, Player *player, Game_Manager *manager, 
-                       u32 current_x, u32 current_y) {
-    // Mark all reachable areas from the player with a visited flag on the tile. 
-    // All areas not marked are enclosed areas.
-    CheckEnclosedAreasFromPlayerPosition(tilemap, current_x, current_y);
-    bool has_flood_fill_happened = false;
-    u32 enemy_slain              = 0;
-    // Any floor tiles not marked as visited are enclosed
-    for (u32 y = 0; y < (u32)tilemap->height; y++) {
-        for (u32 x = 0; x < (u32)tilemap->width; x++) {
-            u32 index   = TilemapIndex(x, y, tilemap->width);
-            Tile *tile  = &tilemap->tiles[index];
-
-            if ((tile->type == TileType_floor) && !IsFlagSet(tile, TileFlag_fire)) {
-                if (!IsFlagSet(tile, TileFlag_visited)) {
-                    AddFlag(tile, TileFlag_fire);
-                    has_flood_fill_happened = true;
-                    
-                    if (IsFlagSet(tile, TileFlag_powerup)) {
-                        ClearFlag(tile, TileFlag_powerup);
-                        DeletePowerupInList(&manager->powerup_sentinel, tile);
-                    }
-                    if (IsFlagSet(tile, TileFlag_enemy)) {
-                        DeleteEnemyInList(&manager->enemy_sentinel, index);
-                        ClearFlag(tile, TileFlag_enemy);
-                        enemy_slain++;
-                        f32 speed_increase = 10.0f;
-                        player->speed += speed_increase;
-                    }
-                } 
-            } 
-
-            ClearFlag(tile, TileFlag_visited);
-        }
-    }
-
-    if (has_flood_fill_happened) {
-        if (enemy_slain) {
-#if defined(PLATFORM_WEB)
-            WebAudioSfxSetVolume(SoundEffect_powerup_appear, 1.0f);
-            WebAudioSfxPlay(SoundEffect_powerup_appear);
-#else
-            PlaySound(manager->sounds[SoundEffect_powerup_appear]);
-#endif
-            BeginScreenShake(&manager->screen_shake, 2.0f*enemy_slain, 0.6f, 10.0f);
-            manager->score_multiplier = enemy_slain;
-        }
-        while (enemy_slain) {
-            u32 tile_index = GetRandomEmptyTileIndex(tilemap);
-            if (tile_index) {
-                Tile *tile = &tilemap->tiles[tile_index];
-                AddFlag(tile, TileFlag_powerup);
-                Powerup *new_powerup = (Powerup *)ArenaAlloc(arena, sizeof(Powerup));
-                PowerupInit(new_powerup, &manager->powerup_sentinel, tile);
-            }
-            enemy_slain--;
-        }
-        has_flood_fill_happened = false;
-    }
-}
-
-Rectangle SetAtlasFrameRec(Tile_Type type, u32 seed) {
-    Rectangle frame_rec = {0, 0, TILE_SIZE, TILE_SIZE};
-    switch (type) {
-        case TileType_wall:
-        case TileType_floor: {
-            frame_rec.x = seed * TILE_SIZE;
-            frame_rec.y = 0;
-        } break;
-        default: {
-        } break;
-    }
-    return frame_rec;
-}
-
-void Animate(Animation *animator, u32 frame_counter) {
-    if (frame_counter % (60/FRAME_SPEED) == 0) {
-        animator->current_frame++;
-    }
-        
-    if (animator->current_frame >= animator->max_frames) {
-        if (animator->looping) {
-            animator->current_frame = 0;
-        } else { 
-            animator->current_frame = animator->max_frames - 1;
-        }
-    }
-
-    animator->frame_rec.x = (f32)animator->current_frame *
-                           ((f32)animator->texture.width /
-                           animator->max_frames);
-}
-
-// TODO: Maybe make these functions take the input buffer as the argument 
-// instead of the player
-inline bool InputBufferEmpty(Player *player) {
-    bool result = player->input_buffer.start == player->input_buffer.end;
-    return result;
-}
-
-inline bool InputBufferFull(Player *player) {
-    bool result = ((player->input_buffer.end + 1) % INPUT_MAX) == player->input_buffer.start;
-    return result;
-}
-
-void InputBufferPush(Player *player, Direction_Facing dir) {
-    if (!InputBufferFull(player)) {
-
-        player->input_buffer.inputs[player->input_buffer.end] = dir;
-        player->input_buffer.end = (player->input_buffer.end + 1) % INPUT_MAX;
-    }
-}
-
-Direction_Facing InputBufferPop(Player *player) {
-    Direction_Facing result = DirectionFacing_none;
-    if(!InputBufferEmpty(player)) {
-        result = player->input_buffer.inputs[player->input_buffer.start];
-        player->input_buffer.start = (player->input_buffer.start + 1) % INPUT_MAX;
-    }
-    return result;
-}
-
-Direction_Facing KeyToDirection(s32 key) {
-    Direction_Facing result;
-    switch(key) {
-        case KEY_UP:    case KEY_W: result = DirectionFacing_up;    break;
-        case KEY_DOWN:  case KEY_S: result = DirectionFacing_down;  break;
-        case KEY_LEFT:  case KEY_A: result = DirectionFacing_left;  break;
-        case KEY_RIGHT: case KEY_D: result = DirectionFacing_right; break;
-        default:                    result = DirectionFacing_none;  break;
-    }
-    return result;
-}
-
-void StorePlayerDirectionsInBuffer(Player *player) {
-    s32 key;
-    while ((key = GetKeyPressed()) != 0) {
-        Direction_Facing dir = KeyToDirection(key);
-        if (dir == DirectionFacing_none) continue;
-
-        if (InputBufferEmpty(player)) {
-            if ((player->facing == DirectionFacing_up    && dir == DirectionFacing_down) ||
-                (player->facing == DirectionFacing_down  && dir == DirectionFacing_up)   ||
-                (player->facing == DirectionFacing_left  && dir == DirectionFacing_right)||
-                (player->facing == DirectionFacing_right && dir == DirectionFacing_left)) {
-                continue;
-            }
-        }
-
-        if (!InputBufferEmpty(player)) {
-            if (player->input_buffer.inputs[player->input_buffer.end] == dir) 
-                continue;
-        }
-
-        InputBufferPush(player, dir);
-    }
-}
-
-Text_Burst CreateTextBurst(const char *text) {
-    Text_Burst burst =  {};
-    burst.text       =  text;
-    burst.pos        =  {(f32)GetRandomValue(0+TILE_SIZE, base_screen_width-TILE_SIZE), 
-                         (f32)GetRandomValue(0+TILE_SIZE, base_screen_height-TILE_SIZE)};
-    burst.alpha      =  0.0f;
-    burst.scale      =  0.25f;
-    burst.max_scale  =  0.75f + (float)(rand() % 100) / 100.0f;
-    burst.drift.x    = -1.25f + (float)(rand() % 2);
-    burst.drift.y    = -1.25f + (float)(rand() % 2);
-    burst.lifetime   =  1.0f;
-    burst.age        =  0.0f;
-    burst.active     =  true;
-    return burst;
-}
-
-void DrawTextTripleEffect (const char *text, Vector2 pos, u32 size, f32 alpha = 1.0f) {
+void DrawTextTripleEffect (const char *text, Vector2 pos, u32 size, f32 alpha = 1.0f) {
 
     DrawText(text, (u32)pos.x+2.0f, (u32)pos.y+2.0f, size, Fade(BLACK,  alpha));
     DrawText(text, (u32)pos.x+1.0f, (u32)pos.y+1.0f, size, Fade(MAROON, alpha));
@@ -973,55 +1297,83 @@ void DrawTextBurst(Text_Burst *burst) {
     DrawTextDoubleEffect(burst->text, burst->pos, font_size, burst->alpha);
 }
 
-void UpdateAndDrawAllTextBursts(Game_Manager *manager, f32 delta_t) {
+void UpdateAllTextBursts(Game_Manager *manager, f32 delta_t) {
     for(int index = 0; index < MAX_BURSTS; index++) {
         UpdateTextBurst(&manager->bursts[index], delta_t);
+    }
+}
+
+void DrawAllTextBursts(Game_Manager *manager) {
+    for(int index = 0; index < MAX_BURSTS; index++) {
         if (manager->bursts[index].active) {
             DrawTextBurst(&manager->bursts[index]);
         }
     }
 }
 
-void AlphaFadeIn(Game_Manager *manager, Fade_Object *object, f32 duration) {
-    object->alpha     = 0.0f;
+inline b32 AlphaFadeIsRunning(Game_Manager *manager, Fade_Object *object) {
+    b32 result = object->fade_slot && object->fade_slot <= manager->fade_count &&
+                 manager->fadeables[object->fade_slot - 1] == object;
+    return result;
+}
+
+// Starting a fade on something that's already fading just restarts it in 
+// the slot it has. If every slot is taken it jumps straight to the end.
+void AlphaFadeStart(Game_Manager *manager, Fade_Object *object, f32 duration, Fade_Type fade_type) {
+    object->alpha     = fade_type == FadeType_in ? 0.0f : 1.0f;
     object->duration  = duration;
     object->timer     = 0.0f;
-    object->fade_type = FadeType_in;
+    object->fade_type = fade_type;
+    if (AlphaFadeIsRunning(manager, object)) return;
+
+    if (manager->fade_count == MAX_FADEABLES) {
+        TraceLog(LOG_WARNING, "FADE: All %u fadeables are running, this one skips to the end", MAX_FADEABLES);
+        object->alpha     = 1.0f - object->alpha;
+        object->fade_type = FadeType_none;
+        return;
+    }
     manager->fadeables[manager->fade_count] = object;
     manager->fade_count++;
+    object->fade_slot = manager->fade_count;
+}
+
+void AlphaFadeIn(Game_Manager *manager, Fade_Object *object, f32 duration) {
+    AlphaFadeStart(manager, object, duration, FadeType_in);
 }
 
 void AlphaFadeOut(Game_Manager *manager, Fade_Object *object, f32 duration) {
-    object->alpha     = 1.0f;
-    object->duration  = duration;
-    object->timer     = 0.0f;
-    object->fade_type = FadeType_out;
-    manager->fadeables[manager->fade_count] = object;
-    manager->fade_count++;
+    AlphaFadeStart(manager, object, duration, FadeType_out);
 }
 
 void UpdateAlphaFade(Game_Manager *manager, f32 delta_t) {
-    for (u32 index = 0; index < manager->fade_count; index++) {
+    u32 index = 0;
+    while (index < manager->fade_count) {
         Fade_Object *fadeable = manager->fadeables[index];
-        if (fadeable->fade_type) {
+        // NOTE: ResetEvents() zeroes event fades that might still be 
+        // running. Those don't point back at their slot any more, so they
+        // get dropped along with the finished ones.
+        b32 owned = fadeable->fade_slot == index + 1;
+        if (owned && fadeable->fade_type) {
             fadeable->timer += delta_t;
             if (fadeable->timer > fadeable->duration) {
                 fadeable->timer = fadeable->duration;
             }
             ASSERT(fadeable->duration > 0);
             f32 step = fadeable->timer / fadeable->duration;
-            if (fadeable->fade_type == FadeType_in) {
-                fadeable->alpha = step;
-                if (step >= 1.0f) {
-                    fadeable->fade_type = FadeType_none;
-                }
-            } else if (fadeable->fade_type == FadeType_out) {
-                fadeable->alpha = 1.0f - step;
-                if (step >= 1.0f) {
-                    fadeable->fade_type = FadeType_none;
-                }
+            fadeable->alpha = fadeable->fade_type == FadeType_in ? step : 1.0f - step;
+            if (step < 1.0f) {
+                index++;
+                continue;
             }
+            fadeable->fade_type = FadeType_none;
         }
+
+        // Swap the last one into this slot, it gets its turn straight away.
+        if (owned) fadeable->fade_slot = 0;
+        manager->fade_count--;
+        Fade_Object *last         = manager->fadeables[manager->fade_count];
+        manager->fadeables[index] = last;
+        if (last->fade_slot == manager->fade_count + 1) last->fade_slot = index + 1;
     }
 }
 
@@ -1032,63 +1384,66 @@ void DrawScreenFadeCol(Fade_Object *object, u32 screen_width, u32 screen_height,
     }
 }
 
-void UpdateEventQueue(Event_Queue *queue, Game_Manager *manager, f32 delta_t) {
-    if (queue->active) {
-        if (queue->index < queue->count) {
-            Event *event = &queue->events[queue->index];
+void UpdateEventQueue(Event_Cursor *cursor, Game_Manager *manager, f32 delta_t) {
+    const Timeline_Sequence *sequence = &cursor->timeline->sequences[cursor->sequence];
+    if (cursor->active) {
+        if (cursor->index < sequence->count) {
+            const Timeline_Event *event = &cursor->timeline->events[sequence->first + cursor->index];
 
             switch (event->type) {
                 case EventType_wait: {
-                    queue->timer += delta_t;
-                    if (queue->timer >= event->duration) {
-                        queue->timer = 0.0f;
-                        queue->index++;
+                    cursor->timer += delta_t;
+                    if (cursor->timer >= event->duration) {
+                        cursor->timer = 0.0f;
+                        cursor->index++;
                     }
                 } break;
                 case EventType_fade_out: {
-                    if (event->fadeable.fade_type == FadeType_none && queue->timer == 0.0f) {
-                        AlphaFadeOut(manager, &event->fadeable, event->duration);
+                    Fade_Object *fade = &cursor->fades[event->value];
+                    if (fade->fade_type == FadeType_none && cursor->timer == 0.0f) {
+                        AlphaFadeOut(manager, fade, event->duration);
                     }
-                    queue->timer += delta_t;
-                    if (event->fadeable.alpha == 0.0f) {
-                        queue->timer = 0.0f;
-                        queue->index++;
+                    cursor->timer += delta_t;
+                    if (fade->alpha == 0.0f) {
+                        cursor->timer = 0.0f;
+                        cursor->index++;
                     }
                 } break;
                 case EventType_fade_in: {
-                    if (event->fadeable.fade_type == FadeType_none && queue->timer == 0.0f) {
-                        AlphaFadeIn(manager, &event->fadeable, event->duration);
+                    Fade_Object *fade = &cursor->fades[event->value];
+                    if (fade->fade_type == FadeType_none && cursor->timer == 0.0f) {
+                        AlphaFadeIn(manager, fade, event->duration);
                     }
-                    queue->timer += delta_t;
-                    if (event->fadeable.alpha == 1.0f) {
-                        queue->timer = 0.0f;
-                        queue->index++;
+                    cursor->timer += delta_t;
+                    if (fade->alpha == 1.0f) {
+                        cursor->timer = 0.0f;
+                        cursor->index++;
                     }
                 } break;
                 case EventType_state_change: {
-                    manager->state = (Game_State)event->new_state;
-                    queue->timer = 0.0f;
-                    queue->index++;
-                    queue->active = false;
+                    manager->state = (Game_State)event->value;
+                    cursor->timer  = 0.0f;
+                    cursor->index++;
+                    cursor->active = false;
                 } break;
 
-                default: queue->index++; break;
+                default: cursor->index++; break;
             }
         }
     }
 }
 
-void StartEventSequence(Event_Queue *queue) {
-    queue->index  = 0;
-    queue->timer  = 0.0f;
-    queue->active = true;
+void StartEventSequence(Event_Cursor *cursor) {
+    cursor->index  = 0;
+    cursor->timer  = 0.0f;
+    cursor->active = true;
 }
  
 void UpdateGodFaceAnimation(Game_Manager *manager, f32 delta_t) {
     manager->gui.anim_timer += delta_t;
     if (manager->gui.anim_timer > manager->gui.anim_duration) {
         manager->gui.anim_timer = 0;
-        manager->gui.anim_duration = GetRandomValue(1.0f, 4.0f);
+        manager->gui.anim_duration = (f32)RandomRange(&manager->cosmetic, 1, 4);
         manager->gui.animators[manager->gui.face_type].current_frame = 0;
     }
 }
@@ -1099,80 +1454,241 @@ void SetGodFaceType(Game_Manager *manager) {
                                                                          GodAnimator_angry;
 }
 
-void DrawGodFace(Game_Manager *manager, f32 delta_t) {
+void DrawGodFace(Render_Queue *queue, Render_Layer layer, Game_Manager *manager, f32 delta_t) {
     SetGodFaceType(manager);
-    manager->gui.face_pos = {(f32)(manager->gui.bar.width*0.5) - 
+    manager->gui.face_pos = {(f32)(TextureRegion(manager->gui.bar).width*0.5) - 
                         (f32)(manager->gui.animators[0].frame_rec.width*0.5), 0};
 
     UpdateGodFaceAnimation(manager, delta_t);
-    Animate(&manager->gui.animators[manager->gui.face_type], manager->frame_counter);
-    DrawTextureRec(manager->gui.animators[manager->gui.face_type].texture, 
+    Animate(&manager->gui.animators[manager->gui.face_type], manager->anim_steps);
+    PushTextureRec(queue, layer, NULL, TextureGet(manager->gui.animators[manager->gui.face_type].texture), 
                    manager->gui.animators[manager->gui.face_type].frame_rec, manager->gui.face_pos, WHITE);
 }
 
-void DrawGame(Tilemap *map, Game_Manager *manager, Player *player, f32 delta_t)
+Vector2 TileIndexToPos(Tilemap *map, u32 index) {
+    Vector2 result = {(f32)(index % map->width) * map->tile_size, 
+                      (f32)(index / map->width) * map->tile_size};
+    return result;
+}
+
+// Follows the focus point around maps that are bigger than the screen, 
+// keeping the edge of the map pinned to the edge of the screen. On a map 
+// that fits this never moves off the origin.
+Camera2D MapCamera(Tilemap *map, Vector2 focus) {
+    f32 map_width  = (f32)map->width  * map->tile_size;
+    f32 map_height = (f32)map->height * map->tile_size;
+
+    Camera2D result = {};
+    result.zoom     = 1.0f;
+    if (map_width > base_screen_width) {
+        result.target.x = CLAMP(focus.x - base_screen_width*0.5f, 0.0f, map_width - base_screen_width);
+    }
+    if (map_height > base_screen_height) {
+        result.target.y = CLAMP(focus.y - base_screen_height*0.5f, 0.0f, map_height - base_screen_height);
+    }
+    return result;
+}
+
+void TileCacheInit(Tile_Cache *cache, u32 tile_size) {
+    // Enough tiles to cover the screen from any camera position, same as 
+    // the range DrawGame() draws.
+    cache->width       = (base_screen_width  / tile_size) + 2;
+    cache->height      = (base_screen_height / tile_size) + 2;
+    cache->target      = LoadRenderTextureWebSafe(cache->width*tile_size, cache->height*tile_size);
+    cache->valid       = false;
+}
+
+// Redraws the tiles from x0, y0 up to but not including x1, y1 into 
+// wherever they wrap to in the texture. Has to be called in texture mode.
+void TileCacheDrawRect(Tile_Cache *cache, Tilemap *map, Game_Manager *manager,
+                       u32 x0, u32 y0, u32 x1, u32 y1) {
+    for (u32 y = y0; y < y1; y++) {
+        for (u32 x = x0; x < x1; x++) {
+            Vector2 slot_pos = {(f32)((x % cache->width)  * map->tile_size),
+                                (f32)((y % cache->height) * map->tile_size)};
+
+            Tile_Type type = TileType_none;
+            u32       seed = 0;
+            if (x < map->width && y < map->height) {
+                Tile tile = TileAt(map, x, y);
+                type      = GetTileType(tile);
+                seed      = GetTileSeed(tile);
+            }
+
+            if (type == TileType_floor) {
+                Rectangle atlas_frame_rec = SetAtlasFrameRec(manager->atlas[Atlas_tile], type, seed);
+                DrawTextureRec(TextureGet(manager->atlas[Atlas_tile]), atlas_frame_rec, slot_pos, WHITE);
+            } else if (type == TileType_wall && cache->walls_baked) {
+                Rectangle atlas_frame_rec = SetAtlasFrameRec(manager->atlas[Atlas_wall], type, seed);
+                DrawTextureRec(TextureGet(manager->atlas[Atlas_wall]), atlas_frame_rec, slot_pos, WHITE);
+            } else {
+                DrawRectangle(slot_pos.x, slot_pos.y, map->tile_size, map->tile_size, BLANK);
+            }
+            cache->tiles_drawn++;
+        }
+    }
+}
+
+// Brings the cache up to date for this frame. Everything gets redrawn after 
+// a reset or when the walls start or stop wobbling, otherwise only the tiles 
+// that scrolled into view do. Must be called outside of texture mode.
+void TileCacheUpdate(Tile_Cache *cache, Tilemap *map, Game_Manager *manager, 
+                     Camera2D camera, b32 walls_baked) {
+    cache->tiles_drawn = 0;
+
+    u32 origin_x = (u32)(camera.target.x / map->tile_size);
+    u32 origin_y = (u32)(camera.target.y / map->tile_size);
+    s32 dx       = (s32)origin_x - (s32)cache->origin_x;
+    s32 dy       = (s32)origin_y - (s32)cache->origin_y;
+
+    b32 redraw_all = !cache->valid || cache->reset_count != map->reset_count ||
+                     cache->walls_baked != walls_baked ||
+                     abs(dx) >= (s32)cache->width || abs(dy) >= (s32)cache->height;
+    if (!redraw_all && dx == 0 && dy == 0) return;
+
+    u32 old_x = cache->origin_x;
+    u32 old_y = cache->origin_y;
+    cache->origin_x    = origin_x;
+    cache->origin_y    = origin_y;
+    cache->walls_baked = walls_baked;
+    cache->reset_count = map->reset_count;
+    cache->valid       = true;
+
+    u32 end_x = origin_x + cache->width;
+    u32 end_y = origin_y + cache->height;
+
+    // NOTE: The tiles replace whatever was in their slot rather than blending 
+    // over it, otherwise a wall slot that's now empty would keep the old wall.
+    BeginTextureMode(cache->target);
+    rlSetBlendFactors(RL_ONE, RL_ZERO, RL_FUNC_ADD);
+    BeginBlendMode(BLEND_CUSTOM);
+    if (redraw_all) {
+        TileCacheDrawRect(cache, map, manager, origin_x, origin_y, end_x, end_y);
+    } else {
+        // The columns that came into view, then the rows.
+        if (dx > 0) TileCacheDrawRect(cache, map, manager, old_x + cache->width, origin_y, end_x, end_y);
+        if (dx < 0) TileCacheDrawRect(cache, map, manager, origin_x, origin_y, old_x, end_y);
+        if (dy > 0) TileCacheDrawRect(cache, map, manager, origin_x, old_y + cache->height, end_x, end_y);
+        if (dy < 0) TileCacheDrawRect(cache, map, manager, origin_x, origin_y, end_x, old_y);
+    }
+    EndBlendMode();
+    EndTextureMode();
+}
+
+// Copies the cached window out into the world. Because the tiles wrap around 
+// in the texture that's up to four pieces, split wherever the wrap falls.
+void TileCacheDraw(Render_Queue *queue, Tile_Cache *cache, u32 tile_size) {
+    u32 slot_x[2] = {cache->origin_x % cache->width,  0};
+    u32 slot_y[2] = {cache->origin_y % cache->height, 0};
+    u32 span_x[2] = {cache->width  - slot_x[0], slot_x[0]};
+    u32 span_y[2] = {cache->height - slot_y[0], slot_y[0]};
+    f32 texture_height = (f32)cache->target.texture.height;
+
+    f32 world_y = (f32)(cache->origin_y*tile_size);
+    for (u32 row = 0; row < 2; row++) {
+        f32 world_x = (f32)(cache->origin_x*tile_size);
+        for (u32 column = 0; column < 2; column++) {
+            if (span_x[column] && span_y[row]) {
+                f32 width  = (f32)(span_x[column]*tile_size);
+                f32 height = (f32)(span_y[row]*tile_size);
+                // Render textures come out upside down, hence the flip.
+                Rectangle source = {(f32)(slot_x[column]*tile_size), 
+                                    texture_height - (f32)(slot_y[row]*tile_size) - height,
+                                    width, -height};
+                Rectangle dest   = {world_x, world_y, width, height};
+                PushTexturePro(queue, RenderLayer_ground, NULL, cache->target.texture, 
+                               source, dest, {0, 0}, WHITE);
+            }
+            world_x += span_x[column]*tile_size;
+        }
+        world_y += span_y[row]*tile_size;
+    }
+}
+
+// Pushes whatever's on top of the tiles under the camera: fire, pickups, 
+// enemies, and the walls too while they're wobbling. The bench times this 
+// on its own so it mustn't touch GL.
+void PushTileContents(Render_Queue *queue, Tile_Cache *cache, Tilemap *map, Game_Manager *manager, 
+                      Player *player, f32 alpha)
 {
-    DrawTextureV(manager->gui.bar, {0, 0}, WHITE);
-    DrawGodFace(manager, delta_t);
-    
-    // Draw tiles in background
-    for (u32 y = 0; y < map->height; y++) {
-        for (u32 x = 0; x < map->width; x++) {
-            u32 index  = TilemapIndex(x, y, map->width);
-            Tile *tile = &map->tiles[index];
-            tile->pos  = {(float)x * map->tile_size, (float)y * map->tile_size};
-
-            Rectangle atlas_frame_rec = SetAtlasFrameRec(tile->type, tile->seed);
-            if (tile->type == TileType_floor) {
-                DrawTextureRec(manager->atlas[Atlas_tile], atlas_frame_rec, tile->pos, WHITE);
-            } else if (tile->type == TileType_wall) {  
-                if (player->powered_up) {
-                    BeginShaderMode(map->wobble.shader);
-                    DrawTextureRec(manager->atlas[Atlas_wall], atlas_frame_rec, tile->pos, WHITE);
-                    EndShaderMode();
-                } else {
-                    DrawTextureRec(manager->atlas[Atlas_wall], atlas_frame_rec, tile->pos, WHITE);
-                }
+    // Only the tiles under the camera get drawn. Enemies get drawn one tile 
+    // up so the range reaches a row further down to catch those.
+    Camera2D camera = queue->camera;
+    u32 min_x = (u32)(camera.target.x / map->tile_size);
+    u32 min_y = (u32)(camera.target.y / map->tile_size);
+    u32 max_x = min_x + (base_screen_width  / map->tile_size) + 2;
+    u32 max_y = min_y + (base_screen_height / map->tile_size) + 2;
+    if (max_x > map->width)  max_x = map->width;
+    if (max_y > map->height) max_y = map->height;
+
+    // Every fire tile is on the same frame so there's only one animation to advance.
+    Animation *fire_animation = &map->fire_animation;
+    Texture2D  fire_texture   = TextureGet(fire_animation->texture);
+    Animate(fire_animation, manager->anim_steps);
+
+    Color fire_col = player->powered_up ? PURPLE : WHITE;
+
+    for (u32 y = min_y; y < max_y; y++) {
+        for (u32 x = min_x; x < max_x; x++) {
+            u32       index = TilemapIndex(x, y, map->width);
+            Tile      tile  = TileAt(map, x, y);
+            Tile_Type type  = GetTileType(tile);
+            Vector2   pos   = {(f32)x * map->tile_size, (f32)y * map->tile_size};
+
+            if (type == TileType_wall && !cache->walls_baked) {  
+                Rectangle atlas_frame_rec = SetAtlasFrameRec(manager->atlas[Atlas_wall], type, GetTileSeed(tile));
+                PushTextureRec(queue, RenderLayer_floor, &map->wobble.shader, TextureGet(manager->atlas[Atlas_wall]), 
+                               atlas_frame_rec, pos, WHITE);
             } 
             if (IsFlagSet(tile, TileFlag_fire)) {
-                Color tile_col = player->powered_up ? PURPLE : WHITE;
-                manager->fire_cleared = false;
-                Animate(&tile->animator, manager->frame_counter);
-                BeginShaderMode(map->wobble.shader);
-                DrawTextureRec(tile->animator.texture, 
-                               tile->animator.frame_rec, tile->pos, tile_col);
-                EndShaderMode();
+                PushTextureRec(queue, RenderLayer_fire, &map->wobble.shader, fire_texture, 
+                               fire_animation->frame_rec, pos, fire_col);
             }
             if (IsFlagSet(tile, TileFlag_powerup)) {
-                Powerup *found_powerup = FindPowerupInList(&manager->powerup_sentinel, tile);
+                Powerup *found_powerup = FindPowerupAtTile(map, &manager->powerup_pool, index);
                 if (found_powerup) {
-                    Animate(&found_powerup->animator, manager->frame_counter);
-                    DrawTextureRec(found_powerup->animator.texture, 
-                                   found_powerup->animator.frame_rec, tile->pos, WHITE);
+                    Animate(&found_powerup->animator, manager->anim_steps);
+                    PushTextureRec(queue, RenderLayer_pickups, NULL, TextureGet(found_powerup->animator.texture), 
+                                   found_powerup->animator.frame_rec, pos, WHITE);
                 }
             }
             if (IsFlagSet(tile, TileFlag_enemy)) {
-                Enemy *found_enemy = FindEnemyAtTile(&manager->enemy_sentinel, index);
+                Enemy *found_enemy = FindEnemyAtTile(map, &manager->enemy_pool, index);
                 if (found_enemy) {
                     // If the game has been won then change the enemy animation to thier 
                     // destroyed one.
                     Animation *enemy_animation = (manager->state == GameState_win) ? 
                                                  &found_enemy->animators[EnemyAnimator_destroy] : 
                                                  &found_enemy->animators[EnemyAnimator_idle];
-                    Vector2 draw_pos = {tile->pos.x, tile->pos.y - 20.f};
-                    Animate(enemy_animation, manager->frame_counter);
-                    DrawTextureRec(enemy_animation->texture,
+                    Vector2 prev_pos = TileIndexToPos(map, found_enemy->prev_tile_index);
+                    Vector2 draw_pos = LerpV2(prev_pos, pos, alpha);
+                    draw_pos.y      -= 20.f;
+                    Animate(enemy_animation, manager->anim_steps);
+                    PushTextureRec(queue, RenderLayer_enemies, NULL, TextureGet(enemy_animation->texture),
                                    enemy_animation->frame_rec, 
                                    draw_pos, WHITE);
                 }
             }
-            if (IsFlagSet(tile, TileFlag_moved)) {
-                ClearFlag(tile, TileFlag_moved);
-            }
         }
     }
 }
 
+// Pushes the map and everything on it, it all gets drawn on the next flush.
+void DrawGame(Render_Queue *queue, Tile_Cache *cache, Tilemap *map, Game_Manager *manager, 
+              Player *player, f32 delta_t, f32 alpha)
+{
+    PROFILE_ZONE("DrawGame");
+    PushSpriteV(queue, RenderLayer_back, NULL, manager->gui.bar, {0, 0}, WHITE);
+    DrawGodFace(queue, RenderLayer_back, manager, delta_t);
+
+    // The floor comes out of the cache, along with the walls unless they're 
+    // wobbling in which case they get drawn one by one through the shader.
+    TileCacheDraw(queue, cache, map->tile_size);
+
+    // Then whatever's on top of the tiles
+    PushTileContents(queue, cache, map, manager, player, alpha);
+}
+
 void UpdateSpacebarBob(Spacebar_Text *text, f32 delta_t) {
     text->pos.y += 0.1f*sinf(8.0f*text->bob);
     text->bob   += delta_t;
@@ -1183,6 +1699,7 @@ u32 SongBit(u32 SongId) {
 }
 
 void PlayAllMusicForGameCorrectly(Game_Manager *manager) {
+    PROFILE_ZONE("PlayAllMusicForGameCorrectly");
     u32 wanted_song_bit = 0;
     switch (manager->state) {
         case GameState_play: {
@@ -1204,12 +1721,13 @@ void PlayAllMusicForGameCorrectly(Game_Manager *manager) {
 
     if (wanted_song_bit != manager->last_song_bit) {
         for (u32 index = 0; index < Song_count; index++) {
+            if (index == Song_play || index == Song_play_muted) continue;
             b32 should_play = (wanted_song_bit & SongBit(index)) != 0;
 
 #if defined(PLATFORM_WEB) 
             const bool is_playing = WebAudioIsPlaying((int)index);
             if (should_play && !is_playing) {
-                WebAudioPlaySlot((int)index, g_song_paths[index], true);
+                WebAudioPlaySongAsset((int)index, g_song_paths[index], true);
                 WebAudioSetVol((int)index, 1.0f);
             } else if (!should_play && is_playing) {
                 WebAudioStopSlot((int)index);
@@ -1224,6 +1742,25 @@ void PlayAllMusicForGameCorrectly(Game_Manager *manager) {
             }
 #endif
         }
+
+        b32 should_play_stems   = (wanted_song_bit & (SongBit(Song_play) | SongBit(Song_play_muted))) != 0;
+#if defined(PLATFORM_WEB)
+        b32 stems_playing       = WebAudioIsPlaying(Song_play) && WebAudioIsPlaying(Song_play_muted);
+        if (should_play_stems && !stems_playing) {
+            WebAudioPlaySongStems(Song_play, 2, true);
+        } else if (!should_play_stems) {
+            WebAudioStopSlot(Song_play);
+            WebAudioStopSlot(Song_play_muted);
+        }
+#else
+        Stem_Group *stems       = &manager->play_stems;
+        b32 stems_playing       = StemGroupIsPlaying(stems);
+        if (should_play_stems && !stems_playing) {
+            StemGroupPlay(stems);
+        } else if (!should_play_stems && stems_playing) {
+            StemGroupStop(stems);
+        }
+#endif
         manager->last_song_bit = wanted_song_bit;
     }
 
@@ -1235,6 +1772,99 @@ void PlayAllMusicForGameCorrectly(Game_Manager *manager) {
             UpdateMusicStream(manager->song[index]);
         }
     }
+    StemGroupUpdate(&manager->play_stems);
+#endif
+}
+
+// Plays whatever the last sim step asked for and keeps the powerup
+// sounds and the music crossfade in line with the sim state.
+void PlayGameAudio(Game_Manager *manager, Player *player, Game_Sim *sim) {
+    Sim_Events *events = &sim->events;
+
+    if (events->flags & SimEvent_game_over) {
+        StopSoundBuffer(manager->sounds);
+    }
+
+    if (events->flags & SimEvent_enemy_slain) {
+#if defined(PLATFORM_WEB)
+        WebAudioSfxSetVolume(SoundEffect_powerup_appear, 1.0f);
+        WebAudioSfxPlay(SoundEffect_powerup_appear);
+#else
+        PlaySound(manager->sounds[SoundEffect_powerup_appear]);
+#endif
+    }
+
+    if (events->flags & SimEvent_powerup_collect) {
+#if defined(PLATFORM_WEB)
+        if (WebAudioSfxIsPlaying(SoundEffect_powerup_end)) {
+            WebAudioSfxStop(SoundEffect_powerup_end);
+        }
+        WebAudioSfxSetVolume(SoundEffect_powerup_collect, 1.0f);
+        WebAudioSfxPlay(SoundEffect_powerup_collect);
+#else
+        if (IsSoundPlaying(manager->sounds[SoundEffect_powerup_end])) {
+            StopSound(manager->sounds[SoundEffect_powerup_end]);
+        }
+        PlaySound(manager->sounds[SoundEffect_powerup_collect]);
+#endif
+    }
+
+    if (events->flags & SimEvent_hype) {
+        u32 index = events->hype_index;
+        ASSERT(index < HYPE_WORD_COUNT);
+#if defined(PLATFORM_WEB)
+        // For the web the id is the base + the index.
+        int hype_id = (int)(HYPE_SFX_BASE + index);
+        WebAudioSfxPlay(hype_id);
+#else
+        Sound hype_sound = manager->hype_sounds[index];
+        f32 sound_boost  = 3.0f;
+        SetSoundVolume(hype_sound, sound_boost);
+        PlaySound(hype_sound);
+#endif
+    }
+
+    Sound powerup_effect     = manager->sounds[SoundEffect_powerup];
+    Sound powerup_end_effect = manager->sounds[SoundEffect_powerup_end];
+    if (events->flags & SimEvent_powerup_over) {
+#if defined(PLATFORM_WEB)
+        WebAudioSfxStop(SoundEffect_powerup);
+        WebAudioSfxStop(SoundEffect_powerup_end);
+#else
+        StopSound(powerup_effect);
+        StopSound(powerup_end_effect);
+#endif
+    } else if (player->powered_up) {
+#if defined(PLATFORM_WEB)
+        if (!WebAudioSfxIsPlaying(SoundEffect_powerup) && !WebAudioSfxIsPlaying(SoundEffect_powerup_end)) {
+            WebAudioSfxSetVolume(SoundEffect_powerup, 1.5f);
+            WebAudioSfxPlay(SoundEffect_powerup);
+        }
+        if (IsPowerupEnding(player, sim->time) && !WebAudioSfxIsPlaying(SoundEffect_powerup_end)) {
+            WebAudioSfxStop(SoundEffect_powerup);
+            WebAudioSfxSetVolume(SoundEffect_powerup_end, 2.0f);
+            WebAudioSfxPlay(SoundEffect_powerup_end);
+        }
+#else
+        if (!IsSoundPlaying(powerup_effect) && !IsSoundPlaying(powerup_end_effect))
+        {
+            PlaySound(powerup_effect);
+            SetSoundVolume(powerup_effect, 1.5f);
+        }
+        if (IsPowerupEnding(player, sim->time) && !IsSoundPlaying(powerup_end_effect)) {
+            StopSound(powerup_effect);
+            PlaySound(powerup_end_effect);
+            SetSoundVolume(powerup_end_effect, 2.0f);
+        }
+#endif
+    }
+
+#if defined(PLATFORM_WEB)
+    WebAudioSetVol(Song_play,       manager->play_song_volume);
+    WebAudioSetVol(Song_play_muted, manager->play_muted_song_volume);
+#else 
+    StemGroupSetGain(&manager->play_stems, Song_play,       manager->play_song_volume);
+    StemGroupSetGain(&manager->play_stems, Song_play_muted, manager->play_muted_song_volume);
 #endif
 }
 
@@ -1242,16 +1872,16 @@ void SetTimeValueForWobbleShader(Wobble_Shader *shader, f32 time) {
     SetShaderValue(shader->shader, shader->time_location, &time, SHADER_UNIFORM_FLOAT);
 }
 
-void AnimateAndDrawPlayer(Player *player, u32 frame_counter) {
+void AnimateAndDrawPlayer(Render_Queue *queue, Player *player, u32 anim_steps, f32 alpha) {
 #if 0
     Animation* anim = &player->animators[player->facing];
 
     // Advance first so the src reflects the frame that will be drawn.
-    Animate(anim, frame_counter);
+    Animate(anim, anim_steps);
 
     Rectangle source_rect = anim->frame_rec;
     f32 width = source_rect.width;
-    f32 height = (f32)anim->texture.height;
+    f32 height = anim->frame_rec.height;
 
     Rectangle dest_rect = {player->pos.x, player->pos.y, width, height};
     Vector2 origin = {0.0f, 20.0f};
@@ -1261,7 +1891,7 @@ void AnimateAndDrawPlayer(Player *player, u32 frame_counter) {
         origin.x = width;
     }
 
-    DrawTexturePro(anim->texture, source_rect, dest_rect, origin, 0.0f, player->col);
+    DrawTexturePro(TextureGet(anim->texture), source_rect, dest_rect, origin, 0.0f, player->col);
 #else
     Rectangle src = player->animators[player->facing].frame_rec;
 #if 0
@@ -1274,123 +1904,357 @@ void AnimateAndDrawPlayer(Player *player, u32 frame_counter) {
 #endif
     
     f32 frame_width     = (f32)player->animators[player->facing].frame_rec.width;
-    f32 frame_height    = (f32)player->animators[player->facing].texture.height;
-    Rectangle dest_rect = {player->pos.x, player->pos.y, 
+    f32 frame_height    = player->animators[player->facing].frame_rec.height;
+    Vector2 draw_pos    = LerpV2(player->prev_pos, player->pos, alpha);
+    Rectangle dest_rect = {draw_pos.x, draw_pos.y, 
                            frame_width, frame_height}; 
     Vector2 texture_offset = {0.0f, 20.0f};
-    Animate(&player->animators[player->facing], frame_counter);
-    DrawTexturePro(player->animators[player->facing].texture, src,
-                   dest_rect, texture_offset, 0.0f, player->col);
+    Animate(&player->animators[player->facing], anim_steps);
+    PushTexturePro(queue, RenderLayer_player, NULL, TextureGet(player->animators[player->facing].texture), src,
+                   dest_rect, texture_offset, player->col);
+#endif
+}
+
+void UpdateWinScreen(Game_Manager *manager, Win_Screen *screen, f32 delta_t) {
+    SetGodFaceType(manager);
+    switch (manager->gui.face_type) {
+        case GodAnimator_happy:     screen->message = "The Gods are Pleased!";            break;
+        case GodAnimator_satisfied: screen->message = "The Gods are Satisfied... Barely"; break;
+        case GodAnimator_angry:     screen->message = "The Gods are Unsatisfied...";      break;
+        default:                                                                          break;
+    }
+
+    u32 scaling_duration = 3.0f;
+    manager->gui.step = Clamp01(manager->gui.step + delta_t / scaling_duration);
+    
+    screen->font_size = 14;
+    f32 frame_w   = (f32)manager->gui.animators[manager->gui.face_type].frame_rec.width;
+    f32 frame_h   = manager->gui.animators[manager->gui.face_type].frame_rec.height;
+
+    f32 start_scale = 1.0f;
+    f32 end_scale   = 2.0f;
+    f32 current_scale       = Lerp(start_scale, end_scale, manager->gui.step);
+    manager->gui.face_scale = current_scale;
+
+    screen->text_pos = {(base_screen_width * 0.5f) - (MeasureText(screen->message, screen->font_size) * 0.5f),
+                        base_screen_height * 0.5f};
+
+    screen->start_pos     = {(f32)(TextureRegion(manager->gui.bar).width * 0.5f) - (frame_w * current_scale * 0.5f), 0.0f};
+    screen->end_pos       = {screen->start_pos.x, screen->text_pos.y - (frame_h * current_scale)};
+    manager->gui.face_pos = LerpV2(screen->start_pos, screen->end_pos, manager->gui.step);
+
+    UpdateGodFaceAnimation(manager, delta_t);
+    Animate(&manager->gui.animators[manager->gui.face_type], manager->anim_steps);
+}
+
+void DrawWinScreenGodFace(Render_Queue *queue, Game_Manager *manager) {
+    Animation *animation = &manager->gui.animators[manager->gui.face_type];
+
+    Rectangle src_rec = animation->frame_rec;
+    Rectangle dest_rec = {manager->gui.face_pos.x, manager->gui.face_pos.y, 
+                          animation->frame_rec.width * manager->gui.face_scale,
+                          animation->frame_rec.height * manager->gui.face_scale};
+    PushTexturePro(queue, RenderLayer_front, NULL, TextureGet(animation->texture), src_rec, dest_rec, {0,0}, WHITE);
+}
+
+f32 WrapMod(f32 pos_x, f32 period) {
+    f32 result = fmodf(pos_x, period);
+    result     = (result < 0.0f) ? result + period : result;
+    return result;
+}
+
+void UpdateBackgroundLayer(Background_Layer *layer, f32 delta_t) {
+    layer->pos.x += layer->dir * layer->scroll_speed * delta_t;
+    f32 width = TextureRegion(layer->texture).width;
+
+    if (layer->dir < 0) {
+        layer->pos.x = -WrapMod(-layer->pos.x, width);
+    } else {
+        layer->pos.x = WrapMod(layer->pos.x, width);
+    }
+}
+
+void DrawBackgroundLayer(Render_Queue *queue, Background_Layer *layer, Shader *shader) {
+    f32 width = TextureRegion(layer->texture).width;
+    f32 x0 = (layer->dir < 0) ? layer->pos.x : layer->pos.x - width;
+    f32 x1 = x0 + width;
+
+    PushSpriteV(queue, RenderLayer_back, shader, layer->texture, {x0, layer->pos.y}, WHITE);
+    PushSpriteV(queue, RenderLayer_back, shader, layer->texture, {x1, layer->pos.y}, WHITE);
+}
+
+void UpdateTitleScreenBackground(Title_Screen_Manager *bg, f32 delta_t) {
+    for (u32 index = 0; index < BG_LAYERS; index++) {
+        UpdateBackgroundLayer(&bg->layer[index], delta_t);
+    }
+}
+
+// The queue groups the wobbling layers together so the shader only gets 
+// switched on once, same as drawing all the flat layers first by hand did.
+void DrawTitleScreenBackground(Render_Queue *queue, Title_Screen_Manager *bg, float current_time) {
+#if (PLATFORM_WEB)
+    for (u32 index = 0; index < BG_LAYERS; index++) {
+        DrawBackgroundLayer(queue, &bg->layer[index], NULL);
+    }
+#else
+    SetShaderValue(bg->wobble.shader, bg->wobble.time_location, &current_time, SHADER_UNIFORM_FLOAT);
+    for (u32 index = 0; index < BG_LAYERS; index++) {
+        Shader *shader = bg->layer[index].should_wobble ? &bg->wobble.shader : NULL;
+        DrawBackgroundLayer(queue, &bg->layer[index], shader);
+    }
+#endif
+}
+
+
+// Everything the game loads gets queued here up front so the loader can 
+// have it decoded by the time GameInit() asks for it. The end screen art 
+// isn't needed for minutes so it comes in behind everything else.
+void QueueGameAssets(Asset_Loader *loader) {
+    if (AssetExists(ATLAS_PATH)) {
+        AssetLoaderQueue(loader, AssetKind_image, ATLAS_PATH, AssetPriority_startup);
+    } else {
+        for (u32 index = 0; index < AtlasRegion_count; index++) {
+            AssetLoaderQueue(loader, AssetKind_image, g_atlas_regions[index].path, AssetPriority_startup);
+        }
+    }
+
+    const char *textures[] = {
+        "../assets/sprites/fire.png",
+        "../assets/tiles/wall_tiles.png",
+        "../assets/tiles/layer_2.png",
+        "../assets/tiles/layer_4.png",
+        "../assets/tiles/layer_6.png",
+        "../assets/tiles/layer_8.png",
+    };
+    for (u32 index = 0; index < ARRAY_COUNT(textures); index++) {
+        AssetLoaderQueue(loader, AssetKind_image, textures[index], AssetPriority_startup);
+    }
+
+    // NOTE: The web build plays sound through WebAudio so it doesn't need 
+    // raylib to load any of it.
+#if !defined(PLATFORM_WEB)
+    for (u32 index = 0; index < Song_count; index++) {
+        AssetLoaderQueue(loader, AssetKind_file, g_song_paths[index], AssetPriority_startup);
+    }
+    for (u32 index = 0; index < SoundEffect_count; index++) {
+        AssetLoaderQueue(loader, AssetKind_wave, g_sfx_paths[index], AssetPriority_startup);
+    }
+    for (u32 index = 0; index < HYPE_WORD_COUNT; index++) {
+        AssetLoaderQueue(loader, AssetKind_wave, g_hype_paths[index], AssetPriority_startup);
+    }
 #endif
+
+    AssetLoaderQueue(loader, AssetKind_image, "../assets/sprites/win_sky.png",   AssetPriority_background);
+    AssetLoaderQueue(loader, AssetKind_image, "../assets/sprites/win_trees.png", AssetPriority_background);
+}
+
+void DrawLoadingScreen(f32 progress) {
+    BeginDrawing();
+    ClearBackground(BLACK);
+
+    const char *text      = "Loading";
+    u32         font_size = 38;
+    Rectangle   bar       = {WINDOW_WIDTH*0.25f, WINDOW_HEIGHT*0.5f, WINDOW_WIDTH*0.5f, 16.0f};
+    DrawText(text, (WINDOW_WIDTH - MeasureText(text, font_size))/2, (s32)bar.y - font_size*2, font_size, WHITE);
+    DrawRectangleLinesEx(bar, 2.0f, WHITE);
+    DrawRectangleRec({bar.x, bar.y, bar.width*progress, bar.height}, WHITE);
+
+    EndDrawing();
 }
 
-void UpdateWinScreen(Game_Manager *manager, Win_Screen *screen, f32 delta_t) {
-    SetGodFaceType(manager);
-    switch (manager->gui.face_type) {
-        case GodAnimator_happy:     screen->message = "The Gods are Pleased!";            break;
-        case GodAnimator_satisfied: screen->message = "The Gods are Satisfied... Barely"; break;
-        case GodAnimator_angry:     screen->message = "The Gods are Unsatisfied...";      break;
-        default:                                                                          break;
+// Everything that loads assets lives in here, it runs once the loader 
+// has all the startup assets in so nothing in here waits on the disk.
+void GameInit(u32 map_width, u32 map_height, u32 seed) {
+    // TODO: I don't really know how I feel about this living here. At least if it's 
+    // here I can initialise it how I want it straight away. If I put it into the 
+    // game manager struct then it's more annoying to initialise this array. I'd 
+    // probably have to loop over the array... so I guess for now it can live here 
+    // until I can come up with a clearly better solution.
+    static const char *hype_text[HYPE_WORD_COUNT] = {"WOW",      "YEAH",   "AMAZING",      "SANCTIFY", 
+                                                     "HOLY COW", "DIVINE", "UNBELIEVABLE", "WOAH",
+                                                     "AWESOME",  "COSMIC", "RITUALISTIC",  "LEGENDARY"};
+
+    u32 tilemap[TILEMAP_HEIGHT][TILEMAP_WIDTH] = {
+        { 1, 1, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 1, 1, },
+        { 1, 1, 1, 1, 1, 1, 1, 0, 0, 1, 1, 1, 1, 1, 1, 1, },
+        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
+        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
+        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
+        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
+        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
+        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
+        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
+        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
+        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
+        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
+        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
+        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
+        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
+        { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, },
+
+    };
+
+    size_t arena_size = MB(1) + TilemapMemorySize(map_width, map_height);
+    ArenaInit(&g_arena, arena_size); 
+
+    TilemapInit(&g_map);
+    TilemapAlloc(&g_map, &g_arena, map_width, map_height);
+    if (map_width == TILEMAP_WIDTH && map_height == TILEMAP_HEIGHT) {
+        for (u32 index = 0; index < TILEMAP_WIDTH*TILEMAP_HEIGHT; index++) {
+            g_map.original_map[index] = (&tilemap[0][0])[index];
+        }
+    } else {
+        TilemapGenerateArena(&g_map);
     }
 
-    u32 scaling_duration = 3.0f;
-    manager->gui.step = Clamp01(manager->gui.step + delta_t / scaling_duration);
-    
-    screen->font_size = 14;
-    f32 frame_w   = (f32)manager->gui.animators[manager->gui.face_type].frame_rec.width;
-    f32 frame_h   = (f32)manager->gui.animators[manager->gui.face_type].texture.height;
+    // There can only ever be one enemy or powerup per tile so the map 
+    // size is a hard cap on how many of either can be alive at once.
+    u32 tile_count = map_width*map_height;
+    PoolInit(&g_manager.enemy_pool,   &g_arena, sizeof(Enemy),   tile_count);
+    PoolInit(&g_manager.powerup_pool, &g_arena, sizeof(Powerup), tile_count);
+    EnclosureTrackerInit(&g_map.enclosure, &g_arena, tile_count);
+    g_map.random = RandomSeed(seed, RandomStream_tiles);
+    TileInit(&g_map);
 
-    f32 start_scale = 1.0f;
-    f32 end_scale   = 2.0f;
-    f32 current_scale       = Lerp(start_scale, end_scale, manager->gui.step);
-    manager->gui.face_scale = current_scale;
+    PlayerInit(&g_player);
+    // I'm seperating initialising the player animators from 
+    // the rest of the initialisation because I re-init the player
+    // on a game over to set the player back to default values. I 
+    // do not need to re-init the player animators at game over though.
+    PlayerAnimatorInit(&g_player);
 
-    screen->text_pos = {(base_screen_width * 0.5f) - (MeasureText(screen->message, screen->font_size) * 0.5f),
-                        base_screen_height * 0.5f};
+    GameManagerInit(&g_manager);
+    g_manager.hype_text = hype_text;
+    g_manager.cosmetic  = RandomSeed(seed, RandomStream_cosmetic);
 
-    screen->start_pos     = {(f32)(manager->gui.bar.width * 0.5f) - (frame_w * current_scale * 0.5f), 0.0f};
-    screen->end_pos       = {screen->start_pos.x, screen->text_pos.y - (frame_h * current_scale)};
-    manager->gui.face_pos = LerpV2(screen->start_pos, screen->end_pos, manager->gui.step);
+    TitleScreenManagerInit(&g_title_screen_manager);
 
-    UpdateGodFaceAnimation(manager, delta_t);
-    Animate(&manager->gui.animators[manager->gui.face_type], manager->frame_counter);
-}
+    EndScreenInit(&g_end_screen);
 
-void DrawWinScreenGodFace(Game_Manager *manager) {
-    Animation *animation = &manager->gui.animators[manager->gui.face_type];
+    SetupEventSequences(&g_event_manager);
 
-    Rectangle src_rec = animation->frame_rec;
-    Rectangle dest_rec = {manager->gui.face_pos.x, manager->gui.face_pos.y, 
-                          animation->frame_rec.width * manager->gui.face_scale,
-                          animation->texture.height  * manager->gui.face_scale};
-    DrawTexturePro(animation->texture, src_rec, dest_rec, {0,0}, 0.0f, WHITE);
-}
+    TutorialAnimationInit(&g_tutorial_entities);
 
-f32 WrapMod(f32 pos_x, f32 period) {
-    f32 result = fmodf(pos_x, period);
-    result     = (result < 0.0f) ? result + period : result;
-    return result;
-}
+    g_sim.arena   = &g_arena;
+    g_sim.map     = &g_map;
+    g_sim.player  = &g_player;
+    g_sim.manager = &g_manager;
+    g_sim.time    = 0.0;
+    g_sim.random  = RandomSeed(seed, RandomStream_gameplay);
+    g_sim.effects = RandomSeed(seed, RandomStream_effects);
 
-void UpdateBackgroundLayer(Background_Layer *layer, f32 delta_t) {
-    layer->pos.x += layer->dir * layer->scroll_speed * delta_t;
-    f32 width = (f32)layer->texture.width;
+    g_target = LoadRenderTextureWebSafe(base_screen_width, base_screen_height); 
+    TileCacheInit(&g_tile_cache, g_map.tile_size);
+}
 
-    if (layer->dir < 0) {
-        layer->pos.x = -WrapMod(-layer->pos.x, width);
-    } else {
-        layer->pos.x = WrapMod(layer->pos.x, width);
+#if !defined(PLATFORM_WEB)
+// Reloads whatever hot_reload.cpp saw get saved since last frame. Textures 
+// and sounds are swapped in wherever they're used, the wobble shader gets 
+// rebuilt for everything using it.
+void HotReloadAssets() {
+    char paths[HOT_RELOAD_MAX_CHANGES][TEXTURE_PATH_MAX];
+    u32  count = HotReloadPoll(&g_hot_reload, paths, HOT_RELOAD_MAX_CHANGES);
+    for (u32 index = 0; index < count; index++) {
+        const char *path     = paths[index];
+        b32         reloaded = false;
+        if (IsFileExtension(path, ".png")) {
+            reloaded = TextureReload(path);
+            // NOTE: The tile cache has the old tiles drawn into it.
+            if (reloaded) g_tile_cache.valid = false;
+        } else if (IsFileExtension(path, ".wav")) {
+            reloaded = SoundReload(&g_manager, path);
+        } else if (TextIsEqual(path, WOBBLE_FS_PATH)) {
+            reloaded = WobbleShaderReload();
+        }
+        if (reloaded) TraceLog(LOG_INFO, "RELOAD: Swapped in %s", path);
     }
 }
+#endif
 
-void DrawBackgroundLayer(Background_Layer *layer) {
-    f32 width = (f32)layer->texture.width;
-    f32 x0 = (layer->dir < 0) ? layer->pos.x : layer->pos.x - width;
-    f32 x1 = x0 + width;
-
-    DrawTextureV(layer->texture, {x0, layer->pos.y}, WHITE);
-    DrawTextureV(layer->texture, {x1, layer->pos.y}, WHITE);
-}
+void UpdateAndDrawFrame() {
+    // NOTE: Until the startup assets are in, all a frame does is upload 
+    // the next few of them and draw the loading screen.
+    if (!g_game_initialised) {
+#if defined(PLATFORM_WEB)
+        // NOTE: Only the title screen's group has to be in, the rest keep 
+        // coming in behind it.
+        if (AssetLibraryFirstGroupPending(&g_asset_library)) {
+            DrawLoadingScreen(0.0f);
+            return;
+        }
+#endif
+        if (!g_loader.thread_count) {
+            AssetLoaderInit(&g_loader, &g_asset_library);
+            QueueGameAssets(&g_loader);
+            AssetLoaderStart(&g_loader);
+        }
 
-void UpdateTitleScreenBackground(Title_Screen_Manager *bg, f32 delta_t) {
-    for (u32 index = 0; index < BG_LAYERS; index++) {
-        UpdateBackgroundLayer(&bg->layer[index], delta_t);
+        AssetLoaderUpdate(&g_loader, ASSET_LOADER_UPLOAD_BUDGET);
+        if (!AssetLoaderReached(&g_loader, AssetPriority_startup)) {
+            DrawLoadingScreen((f32)g_loader.done_count / g_loader.job_count);
+            return;
+        }
+        u32 seed = ReplayStart(&g_replay, (u32)time(NULL), g_map_width, g_map_height);
+        GameInit(g_map_width, g_map_height, seed);
+        BotStart(&g_bot, seed, g_map_width*g_map_height, &g_textures);
+        g_game_initialised = true;
     }
-}
 
-void DrawTitleScreenBackground(Title_Screen_Manager *bg, float current_time) {
-#if (PLATFORM_WEB)
-    for (u32 index = 0; index < BG_LAYERS; index++) {
-        DrawBackgroundLayer(&bg->layer[index]);
+    // NOTE: F3 shows the profiler overlay, F4 writes out the frames it has 
+    // as a Chrome trace.
+    ProfilerBeginFrame(&g_profiler);
+    if (IsKeyPressed(KEY_F3)) g_profiler.show_overlay = !g_profiler.show_overlay;
+    if (IsKeyPressed(KEY_F4)) ProfilerExportTrace(&g_profiler, PROFILER_TRACE_PATH);
+
+    if (g_loader.done_count < g_loader.job_count) {
+        u32 assets_zone = ProfilerBeginZone(&g_profiler, "assets");
+        AssetLoaderUpdate(&g_loader, ASSET_LOADER_UPLOAD_BUDGET);
+        TextureRegistryResolve();
+        ProfilerEndZone(&g_profiler, assets_zone);
     }
-#else
-    // Draw the non-wobbling layers first to minimise the shader mode switching.
-    for (u32 index = 0; index < BG_LAYERS; index++) {
-        if (!bg->layer[index].should_wobble) {
-            DrawBackgroundLayer(&bg->layer[index]);
-        }
+
+#if defined(PLATFORM_WEB)
+    // NOTE: Sound that got asked for before its pack was in gets another go
+    // whenever one arrives, clearing the song bit makes the songs recheck.
+    if (g_web_arrivals_seen != g_asset_library.arrival_count) {
+        g_web_arrivals_seen     = g_asset_library.arrival_count;
+        WebAudioPreloadSfxAssets();
+        g_manager.last_song_bit = 0xFFFFFFFF;
+        g_web_songs_wanted      = (1u << Song_count) - 1;
     }
 
-    // Then draw the wobble shader layers in a single block
-    SetShaderValue(bg->wobble.shader, bg->wobble.time_location, &current_time, SHADER_UNIFORM_FLOAT);
-    BeginShaderMode(bg->wobble.shader);
-    for (u32 index = 0; index < BG_LAYERS; index++) {
-        if (bg->layer[index].should_wobble) {
-            DrawBackgroundLayer(&bg->layer[index]);
-        }
+    if (g_web_song_decode.qoa || g_web_songs_asked || g_web_songs_wanted) {
+        u32 songs_zone = ProfilerBeginZone(&g_profiler, "song decode");
+        if (WebAudioSongDecodeUpdate(&g_web_song_decode, WEB_SONG_DECODE_BUDGET)) g_manager.last_song_bit = 0xFFFFFFFF;
+        ProfilerEndZone(&g_profiler, songs_zone);
     }
-    EndShaderMode();
 #endif
-}
-
 
-void UpdateAndDrawFrame() {
     // -----------------------------------
     // Update
     // -----------------------------------
     f32 delta_t      = GetFrameTime();
     f32 current_time = GetTime();
 
+    // The bot swaps in its own input, then a replay either records it or 
+    // hands back the recorded frame instead.
+    Input_Frame input;
+    GatherInputFrame(&input);
+    BotFrame(&g_bot, &g_sim, &input, &delta_t, &current_time);
+    ReplayFrame(&g_replay, &g_sim, &input, &delta_t, &current_time);
+
+#if !defined(PLATFORM_WEB)
+    // NOTE: Desktop reads the loose files, so edits to the events, the 
+    // sprites, the sound effects and the wobble shader show up without a
+    // restart. Not while recording or playing back though, the event 
+    // timings decide when the screen changes and the replay file has no 
+    // record of an edit.
+    if (g_replay.mode == ReplayMode_off) {
+        EventTimelineReload(&g_event_manager, delta_t);
+        HotReloadAssets();
+    }
+#endif
+
 /*#if defined(PLATFORM_WEB)
     if (!g_audio_initiated) {
         if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) || 
@@ -1402,7 +2266,7 @@ void UpdateAndDrawFrame() {
 
             WebAudioUnlockOnGesture();
             if (g_manager.state == GameState_title) {
-                WebAudioPlaySlot(Song_intro, "../assets/sounds/intro_music.wav", true);
+                WebAudioPlaySongAsset(Song_intro, g_song_paths[Song_intro], true);
                 WebAudioSetVol(Song_intro, 1.0f);
             }
 
@@ -1415,211 +2279,62 @@ void UpdateAndDrawFrame() {
     UpdateScreenShake(&g_manager.screen_shake, delta_t);
     UpdateAlphaFade(&g_manager, delta_t);
 
-    // NOTE: reset the counter back to zero after everything to not mess up 
-    // the individual animations
-    if (g_manager.frame_counter >= 60/FRAME_SPEED) {
-        g_manager.frame_counter = 0;
+    // Animations advance FRAME_SPEED frames a second no matter how fast 
+    // we're actually rendering.
+    f32 anim_step_duration = 1.0f / FRAME_SPEED;
+    g_manager.anim_timer  += delta_t;
+    g_manager.anim_steps   = 0;
+    while (g_manager.anim_timer >= anim_step_duration) {
+        g_manager.anim_timer -= anim_step_duration;
+        g_manager.anim_steps++;
+    }
+
+    MergeInputFrame(&g_pending_input, &input);
+
+    // The game rules get stepped at a fixed rate before anything is drawn, 
+    // however many steps fit into the time that has passed. Input collects up 
+    // until a step actually consumes it. The sim doesn't touch the audio device 
+    // so whatever it wants played is handled straight after each step.
+    u32 sim_zone       = ProfilerBeginZone(&g_profiler, "sim");
+    g_sim_accumulator += (delta_t > SIM_MAX_FRAME_TIME) ? SIM_MAX_FRAME_TIME : delta_t;
+    while (g_sim_accumulator >= SIM_DT) {
+        b32 was_playing = g_manager.state == GameState_play;
+        SimStep(&g_sim, &g_pending_input, SIM_DT);
+        g_pending_input    = {};
+        g_sim_accumulator -= SIM_DT;
+        BotAfterStep(&g_bot, &g_sim, was_playing);
+
+        if (was_playing) {
+            PlayGameAudio(&g_manager, &g_player, &g_sim);
+        }
+    }
+    ProfilerEndZone(&g_profiler, sim_zone);
+    // How far we are between the last sim step and the next one.
+    f32 alpha = g_sim_accumulator / SIM_DT;
+    Camera2D camera = MapCamera(&g_map, LerpV2(g_player.prev_pos, g_player.pos, alpha));
+
+    if (g_manager.state == GameState_play) {
+        UpdateAllTextBursts(&g_manager, delta_t);
+    }
+
+    if (g_manager.state == GameState_play || g_manager.state == GameState_win) {
+        u32 tile_cache_zone = ProfilerBeginZone(&g_profiler, "TileCacheUpdate");
+        TileCacheUpdate(&g_tile_cache, &g_map, &g_manager, camera, !g_player.powered_up);
+        ProfilerEndZone(&g_profiler, tile_cache_zone);
     }
-    g_manager.frame_counter++;
 
     // Draw to render texture
+    u32 scene_zone = ProfilerBeginZone(&g_profiler, "scene");
     BeginTextureMode(g_target);
     ClearBackground(BLACK);
+    Render_Queue *queue = &g_render_queue;
+    RenderQueueBegin(queue, camera);
         
     if (g_manager.state == GameState_play) {
-        g_manager.fire_cleared = true;
-
         SetTimeValueForWobbleShader(&g_map.wobble, current_time);
-        DrawGame(&g_map, &g_manager, &g_player, delta_t);
-
-        // TODO: My unchecked/unsubstantiated theory of why the player movement 
-        // feel off and why buttons pressed in quick successsion aren't logged 
-        // is because of the is_moving flag. I think maybe while the player is moving 
-        // it ignores directions inputs. But as you can see the directions are stored 
-        // inside the buffer before is is_moving flag is checked. So i'm not 100% sure, 
-        // because I don't see how that could happen. But it definitely feels like inputs  
-        // get ignored while the player is moving. But I guess only if the buttons are pressed 
-        // in quick succession. Also strangely I feel like when the player picks up speed 
-        // and starts to move a lot faster things feel a bit more tighter. This I guess 
-        // is also why I think it's related to is_moving because the window where that 
-        // bool switches is so much shorter and the late game when the character is moving 
-        // really fast.
-        StorePlayerDirectionsInBuffer(&g_player);
-        if (!g_player.is_moving) {
-            Direction_Facing dir = InputBufferPop(&g_player);
-            if (dir == DirectionFacing_none) dir = g_player.facing;
-
-            Vector2 input_axis = {0, 0};
-            switch (dir) {
-                case DirectionFacing_up:    input_axis = { 0,-1}; break;
-                case DirectionFacing_down:  input_axis = { 0, 1}; break;
-                case DirectionFacing_left:  input_axis = {-1, 0}; break;
-                case DirectionFacing_right: input_axis = { 1, 0}; break;
-                default: break;
-            }
-            
-
-            if (input_axis.x || input_axis.y) {
-#if 0
-                // NOTE: Calculate the next tile position
-                u32 current_tile_x = (u32)g_player.pos.x / g_map.tile_size;
-                u32 current_tile_y = (u32)g_player.pos.y / g_map.tile_size;
-                u32 target_tile_x  = current_tile_x + input_axis.x;
-                u32 target_tile_y  = current_tile_y + input_axis.y;
-                u32 target_tile_index = TilemapIndex(target_tile_x, target_tile_y, g_map.width);
-                Tile *target_tile     = &g_map.tiles[target_tile_index];
-
-                if (target_tile_x > 0 && target_tile_x < g_map.width-1 &&
-                    target_tile_y > 0 && target_tile_y < g_map.height-1) {
-
-                    if (target_tile->type != TileType_wall  && 
-                        target_tile->type != TileType_none) {
-                        
-                        // Start moving
-                        g_player.facing     = dir;
-                        g_player.target_pos = {(float)target_tile_x * g_map.tile_size, (float)target_tile_y * g_map.tile_size};
-                        g_player.is_moving  = true;
-
-                        u32 current_tile_index = TilemapIndex(current_tile_x, current_tile_y, g_map.width);
-                        Tile *current_tile     = &g_map.tiles[current_tile_index];
-                        if (!g_player.powered_up) {
-                            AddFlag(current_tile, TileFlag_fire);
-                        }
-                    } else {
-                        GameOver(&g_player, &g_map, &g_manager);
-                    }
-                } else {
-                    // Out of bounds
-                    GameOver(&g_player, &g_map, &g_manager);
-                }
-#else
-                s32 current_tile_x = (s32)floorf(g_player.pos.x / g_map.tile_size);
-                s32 current_tile_y = (s32)floorf(g_player.pos.y / g_map.tile_size);
-
-                s32 direction_x = (s32)input_axis.x;
-                s32 direction_y = (s32)input_axis.y;
-
-                s32 target_tile_x = current_tile_x + direction_x;
-                s32 target_tile_y = current_tile_y + direction_y;
-
-                u32 target_tile_index = TilemapIndex((u32)target_tile_x, (u32)target_tile_y, g_map.width);
-                Tile *target_tile = &g_map.tiles[target_tile_index];
-
-                if (target_tile_x > 0 && target_tile_x < (s32)g_map.width - 1 && 
-                    target_tile_y > 0 && target_tile_y < (s32)g_map.height - 1) {
-
-                    if (target_tile->type != TileType_wall && target_tile->type != TileType_none) { 
-                        g_player.facing = dir;
-                        g_player.target_pos = {(float)target_tile_x * g_map.tile_size, (float)target_tile_y * g_map.tile_size};
-                        g_player.is_moving = true;
-
-                        u32 current_tile_index = TilemapIndex((u32)current_tile_x, (u32)current_tile_y, g_map.width);
-                        Tile *current_tile = &g_map.tiles[current_tile_index];
-                        if (!g_player.powered_up) {
-                            AddFlag(current_tile, TileFlag_fire);
-                        }
-                    } else {
-                        GameOver(&g_player, &g_map, &g_manager);
-                    }
-                } else {
-                    // Out of bounds
-                    GameOver(&g_player, &g_map, &g_manager);
-                }
-#endif
-
-                if (IsFlagSet(target_tile, TileFlag_powerup)) {
-                    f32 powerup_duration        = 10.0f;
-                    g_player.powerup_timer       = current_time + powerup_duration;
-                    g_player.powered_up          = true;
-                    g_player.blink_speed         = 5.0f;
-                    g_player.blinking_duration   = g_player.blink_speed;
-                    ClearFlag(target_tile, TileFlag_powerup);
-#if defined(PLATFORM_WEB)
-                    if (WebAudioSfxIsPlaying(SoundEffect_powerup_end)) {
-                        WebAudioSfxStop(SoundEffect_powerup_end);
-                    }
-#else
-                    if (IsSoundPlaying(g_manager.sounds[SoundEffect_powerup_end])) {
-                        StopSound(g_manager.sounds[SoundEffect_powerup_end]);
-                    }
-#endif
-
-#if defined(PLATFORM_WEB)
-                    WebAudioSfxSetVolume(SoundEffect_powerup_collect, 1.0f);
-                    WebAudioSfxPlay(SoundEffect_powerup_collect);
-#else
-                    PlaySound(g_manager.sounds[SoundEffect_powerup_collect]);
-#endif
-                    g_manager.hype_sound_timer   = 0;
-                }
-
-                if (g_player.powered_up) {
-                    //manager.hype_sound_timer += delta_t;
-                    if (IsFlagSet(target_tile, TileFlag_fire)) {
-                        ClearFlag(target_tile, TileFlag_fire);
-                        g_manager.score += (10 * g_manager.score_multiplier);
-                        BeginScreenShake(&g_manager.screen_shake, 1.5f, 0.6f, 10.0f); 
-                        // Create the text bursts
-                        for (int index = 0; index < MAX_BURSTS; index++) {
-                            if (!g_manager.bursts[index].active) {
-                                u32 random_index      = GetRandomValue(0, HYPE_WORD_COUNT - 1);
-                                const char *word      = g_manager.hype_text[random_index];
-                                // TODO: Settle on what kind of positioning I want to have the create 
-                                // text burst appear at.
-                                g_manager.bursts[index] = CreateTextBurst(word);
-                                break;
-                            }
-                        }
-                        // Play the hype sounds
-                        if (g_manager.hype_sound_timer <= current_time) {
-                            u32 index = GetRandomValue(0, HYPE_WORD_COUNT - 1);
-                            while (index == g_manager.hype_prev_index) {
-                                index = GetRandomValue(0, HYPE_WORD_COUNT -1);
-                            }
-                            ASSERT(index < HYPE_WORD_COUNT);
-#if defined(PLATFORM_WEB)
-                            // For the web the id is the base + the index.
-                            int hype_id = (int)(HYPE_SFX_BASE + index);
-                            WebAudioSfxPlay(hype_id);
-#else
-                            Sound hype_sound = g_manager.hype_sounds[index];
-                            f32 sound_boost  = 3.0f;
-                            SetSoundVolume(hype_sound, sound_boost);
-                            PlaySound(hype_sound);
-#endif
-
-                            g_manager.hype_prev_index  = index;
-                            f32 sound_duration        = current_time + 0.90f;
-                            g_manager.hype_sound_timer = sound_duration;
-                        }
-                    }
-                }
-
-                if (IsFlagSet(target_tile, TileFlag_fire) || IsFlagSet(target_tile, TileFlag_enemy)) {
-                    GameOver(&g_player, &g_map, &g_manager);
-                }
-            }
-        } else {
-            // Move towards target position
-            Vector2 direction = VectorSub(g_player.target_pos, g_player.pos);
-            float distance    = Length(direction);
-            if (distance <= g_player.speed * delta_t) {
-                g_player.pos       = g_player.target_pos;
-                g_player.is_moving = false;
-
-                u32 current_tile_x = (u32)g_player.pos.x / g_map.tile_size;
-                u32 current_tile_y = (u32)g_player.pos.y / g_map.tile_size;
-
-                FillEnclosedAreas(&g_arena, &g_map, &g_player, &g_manager, current_tile_x, current_tile_y);
-            } else {
-                direction        = VectorNorm(direction);
-                Vector2 movement = VectorScale(direction, g_player.speed * delta_t);
-                g_player.pos       = VectorAdd(g_player.pos, movement);
-            }
-        }
+        DrawGame(queue, &g_tile_cache, &g_map, &g_manager, &g_player, delta_t, alpha);
 
         if (g_player.powered_up) {
-            f32 end_duration_signal  = 3.0f;
             // TODO: I've set up a seperate frame counter here for the water that I can double 
             // or halve to speed the animation up or slow it down. Perhaps a better implementation 
             // in the future would be to have the animate function take a speed multiplier that can 
@@ -1627,150 +2342,19 @@ void UpdateAndDrawFrame() {
             // than each animation that wants a speed change to have it's own counter. Right now 
             // only this animation in the game that wants to change it's speed so 
             // this current implemenation is fine for now.
-            u32 water_frame_counter  = g_manager.frame_counter;
-
-            // TODO: I'm moving the volume value by a set amount which isn't very frame independant. 
-            // I should actually increment and decrement by some rate * delta_t.
-            g_manager.play_song_volume       -= 0.02f;
-            g_manager.play_muted_song_volume += 0.02f;
-
-            Sound powerup_effect     = g_manager.sounds[SoundEffect_powerup];
-            Sound powerup_end_effect = g_manager.sounds[SoundEffect_powerup_end];
-
-#if defined(PLATFORM_WEB)
-            if (!WebAudioSfxIsPlaying(SoundEffect_powerup) && !WebAudioSfxIsPlaying(SoundEffect_powerup_end)) {
-                WebAudioSfxSetVolume(SoundEffect_powerup, 1.5f);
-                WebAudioSfxPlay(SoundEffect_powerup);
-            }
-#else
-            if (!IsSoundPlaying(powerup_effect) && !IsSoundPlaying(powerup_end_effect))
-            {
-                PlaySound(powerup_effect);
-                SetSoundVolume(powerup_effect, 1.5f);
-            }
-#endif
-
-            if (g_player.powerup_timer < current_time) { // Powerup is over.
-                g_player.powered_up = false;
-                g_player.col_bool   = false;
-                g_manager.score_multiplier = 1;
-#if defined(PLATFORM_WEB)
-                WebAudioSfxStop(SoundEffect_powerup);
-                WebAudioSfxStop(SoundEffect_powerup_end);
-#else
-                StopSound(powerup_effect);
-                StopSound(powerup_end_effect);
-#endif
-            } else {
-                if ((g_player.powerup_timer - end_duration_signal) < current_time) { // Powerup over soon warning.
-                    g_player.blink_speed   = 2.0f; 
-                    water_frame_counter *= 2;
-
-#if defined(PLATFORM_WEB)
-                    if (!WebAudioSfxIsPlaying(SoundEffect_powerup_end)) {
-                        WebAudioSfxStop(SoundEffect_powerup);
-                        WebAudioSfxSetVolume(SoundEffect_powerup_end, 2.0f);
-                        WebAudioSfxPlay(SoundEffect_powerup_end);
-                    }
-#else
-                    if (!IsSoundPlaying(powerup_end_effect)) {
-                        StopSound(powerup_effect);
-                        PlaySound(powerup_end_effect);
-                        SetSoundVolume(powerup_end_effect, 2.0f);
-                    }
-#endif
-                }
-
-                if (g_player.blinking_duration > 0) {
-                g_player.blinking_duration -= 1.0f;
-                } else {
-                    g_player.blinking_duration = g_player.blink_speed;
-                    g_player.col_bool          = !g_player.col_bool;
-                }
+            u32 water_anim_steps = g_manager.anim_steps;
+            if (IsPowerupEnding(&g_player, g_sim.time)) {
+                water_anim_steps *= 2;
             }
 
-            Animate(&g_player.animators[PlayerAnimator_water], water_frame_counter);
-            DrawTextureRec(g_player.animators[PlayerAnimator_water].texture, 
+            Animate(&g_player.animators[PlayerAnimator_water], water_anim_steps);
+            PushTextureRec(queue, RenderLayer_water, NULL, TextureGet(g_player.animators[PlayerAnimator_water].texture), 
                            g_player.animators[PlayerAnimator_water].frame_rec, g_player.target_pos, WHITE);
-            if (g_player.col_bool) {
-                g_player.col = BLUE;
-            } else {
-                g_player.col = WHITE;
-            }
-        } else {
-            g_manager.play_song_volume       += 0.02f;
-            g_manager.play_muted_song_volume -= 0.02f;
-        }
-
-        // TODO: I need to set up a better way to crossfade these tracks. Right not this is the 
-        // only track I fade so it's probably fine 
-        g_manager.play_song_volume       = CLAMP(g_manager.play_song_volume,  0.0f, 1.0f);
-        g_manager.play_muted_song_volume = CLAMP(g_manager.play_muted_song_volume, 0.0f, 1.0f);
-#if defined(PLATFORM_WEB)
-        WebAudioSetVol(Song_play,       g_manager.play_song_volume);
-        WebAudioSetVol(Song_play_muted, g_manager.play_muted_song_volume);
-#else 
-        SetMusicVolume(g_manager.song[Song_play],       g_manager.play_song_volume);
-        SetMusicVolume(g_manager.song[Song_play_muted], g_manager.play_muted_song_volume);
-#endif
-
-        // Enemy spawning
-        if (g_manager.spawn_timer > 0) {
-            // TODO: This right now is frame dependant. I should decrement by delta_t 
-            // and set the enemy_spawn_duration to reflect the real world seconds I 
-            // want to wait.
-            g_manager.spawn_timer -= 1.0f;
-        } else {
-            g_manager.spawn_timer = g_manager.enemy_spawn_duration;
-
-            s32 player_tile_x     = (u32)g_player.pos.x / g_map.tile_size; 
-            s32 player_tile_y     = (u32)g_player.pos.y / g_map.tile_size; 
-            u32 player_tile_index = TilemapIndex(player_tile_x, player_tile_y, g_map.width);
-
-            u32 tile_index = GetRandomEmptyTileIndex(&g_map, player_tile_index);
-            if (tile_index) {
-                Tile *tile = &g_map.tiles[tile_index];
-                AddFlag(tile, TileFlag_enemy);
-
-                // Add enemy
-                Enemy *new_enemy = (Enemy *)ArenaAlloc(&g_arena, sizeof(Enemy));
-                EnemyInit(new_enemy, &g_manager.enemy_sentinel, tile_index);
-            }
-        }
-
-        // Enemy movement
-        if (g_manager.enemy_move_timer > 0) {
-            // TODO: Again this timer is frame dependant. Needs to decrement by delta_t 
-            g_manager.enemy_move_timer -= 1.0f;
-        } else {
-            for (u32 y = 0; y < g_map.height; y++) {
-                for (u32 x = 0; x < g_map.width; x++) {
-                    u32 tile_index = TilemapIndex(x, y, g_map.width); 
-                    Tile *tile     = &g_map.tiles[tile_index];
-
-                    // The moved flag is necessary so that enemies don't end up moving multiple times.
-                    if (IsFlagSet(tile, TileFlag_enemy) && !IsFlagSet(tile, TileFlag_moved)) {
-                        u32 eligible_tile_index = FindEligibleTileIndexForEnemyMove(&g_map, tile_index); 
-                        if (eligible_tile_index) {
-                            Tile *eligible_tile = &g_map.tiles[eligible_tile_index];
-                            Enemy *found_enemy = FindEnemyAtTile(&g_manager.enemy_sentinel, tile_index);
-                            if (found_enemy) {
-                                found_enemy->tile_index = eligible_tile_index;
-                            }
-                            ClearFlag(tile, TileFlag_enemy);
-                            AddFlag(eligible_tile, TileFlag_enemy);
-                            AddFlag(eligible_tile, TileFlag_moved);
-                        }
-                    }
-                }
-            }
-            // TODO: Need to make move duration happen in seconds and decrement the timer 
-            // by delta_t;
-            g_manager.enemy_move_timer = g_manager.enemy_move_duration;
         }
 
-        AnimateAndDrawPlayer(&g_player, g_manager.frame_counter);
-        UpdateAndDrawAllTextBursts(&g_manager, delta_t);
+        AnimateAndDrawPlayer(queue, &g_player, g_manager.anim_steps, alpha);
+        RenderQueueFlush(queue);
+        DrawAllTextBursts(&g_manager);
 
 #if 0
         // TODO: Take this out of the game before shipping.
@@ -1781,15 +2365,18 @@ void UpdateAndDrawFrame() {
 
     } else if (g_manager.state == GameState_win) {
         SetTimeValueForWobbleShader(&g_map.wobble, current_time);
-        DrawGame(&g_map, &g_manager, &g_player, delta_t);
+        DrawGame(queue, &g_tile_cache, &g_map, &g_manager, &g_player, delta_t, alpha);
+        RenderQueueFlush(queue);
 
-        UpdateAndDrawAllTextBursts(&g_manager, delta_t);
+        UpdateAllTextBursts(&g_manager, delta_t);
+        DrawAllTextBursts(&g_manager);
         StopSoundBuffer(g_manager.sounds);
         BeginScreenShake(&g_manager.screen_shake, 4.0f, 5.0f, 10.0f);
         // Hard coding the facing direction here so constantly play 
         // the win celebration animation.
         g_player.facing = DirectionFacing_celebration;
-        AnimateAndDrawPlayer(&g_player, g_manager.frame_counter);
+        AnimateAndDrawPlayer(queue, &g_player, g_manager.anim_steps, alpha);
+        RenderQueueFlush(queue);
 
         if (g_win_screen.white_screen.alpha == 0.0f) {
             AlphaFadeIn(&g_manager, &g_win_screen.white_screen, 5.0f);
@@ -1797,26 +2384,28 @@ void UpdateAndDrawFrame() {
             g_manager.state = GameState_win_text;
         }
         DrawScreenFadeCol(&g_win_screen.white_screen, base_screen_width, base_screen_height, WHITE);
-        DrawGodFace(&g_manager, delta_t);
+        DrawGodFace(queue, RenderLayer_overlay, &g_manager, delta_t);
+        RenderQueueFlush(queue);
 
     } else if (g_manager.state == GameState_win_text) {
-        Event_Queue *win_sequence = &g_event_manager.sequence[Sequence_win];
+        Event_Cursor *win_sequence = &g_event_manager.cursors[Sequence_win];
         UpdateEventQueue(win_sequence, &g_manager, delta_t);
 
         DrawScreenFadeCol(&g_win_screen.white_screen, base_screen_width, base_screen_height, WHITE);
 
         UpdateWinScreen(&g_manager, &g_win_screen, delta_t);
-        DrawWinScreenGodFace(&g_manager);
+        DrawWinScreenGodFace(queue, &g_manager);
+        RenderQueueFlush(queue);
 
         if (!win_sequence->active) StartEventSequence(win_sequence);
-        Event event = win_sequence->events[1];
-        DrawTextTripleEffect(g_win_screen.message, g_win_screen.text_pos, g_win_screen.font_size, event.fadeable.alpha); 
+        DrawTextTripleEffect(g_win_screen.message, g_win_screen.text_pos, g_win_screen.font_size, 
+                             EventFadeAlpha(win_sequence, "message")); 
 
         UpdateSpacebarBob(&g_manager.spacebar_text, delta_t);
         DrawTextTripleEffect(g_manager.spacebar_text.text, g_manager.spacebar_text.pos, g_manager.spacebar_text.size, 
-                             win_sequence->events[3].fadeable.alpha); 
+                             EventFadeAlpha(win_sequence, "spacebar")); 
 
-        if (IsKeyPressed(KEY_SPACE)) {
+        if (input.space_pressed) {
             win_sequence->active = false;
             ResetEvents(&g_event_manager);
             g_manager.gui.step = 0.0f;
@@ -1835,17 +2424,16 @@ void UpdateAndDrawFrame() {
             AlphaFadeOut(&g_manager, &g_win_screen.white_screen, 5.0f);
         }
         g_end_screen.timer += delta_t;
-        BeginShaderMode(g_end_screen.shaders[EndLayer_sky].shader);
         SetTimeValueForWobbleShader(&g_end_screen.shaders[EndLayer_sky], current_time);
-        DrawTextureV(g_end_screen.textures[EndLayer_sky], {0, 0}, WHITE);
-        EndShaderMode();
+        PushSpriteV(queue, RenderLayer_back, &g_end_screen.shaders[EndLayer_sky].shader, 
+                    g_end_screen.textures[EndLayer_sky], {0, 0}, WHITE);
         SetTimeValueForWobbleShader(&g_end_screen.shaders[EndLayer_trees], current_time);
-        BeginShaderMode(g_end_screen.shaders[EndLayer_trees].shader);
-        DrawTextureV(g_end_screen.textures[EndLayer_trees], {-30.0f, 0}, WHITE);
-        EndShaderMode();
-        Animate(&g_end_screen.animator, g_manager.frame_counter);
-        DrawTextureRec(g_end_screen.animator.texture, 
+        PushSpriteV(queue, RenderLayer_middle, &g_end_screen.shaders[EndLayer_trees].shader, 
+                    g_end_screen.textures[EndLayer_trees], {-30.0f, 0}, WHITE);
+        Animate(&g_end_screen.animator, g_manager.anim_steps);
+        PushTextureRec(queue, RenderLayer_front, NULL, TextureGet(g_end_screen.animator.texture), 
                        g_end_screen.animator.frame_rec, {0, 0}, WHITE);
+        RenderQueueFlush(queue);
         // TODO: I could probably make this random duration animation code 
         // a function because the god face uses the exact same code. I don't 
         // think anyone else uses this at the moment so it's perhaps unecessary
@@ -1853,29 +2441,33 @@ void UpdateAndDrawFrame() {
         if (g_end_screen.timer > g_end_screen.blink_duration) {
             g_end_screen.animator.current_frame = 0;
             g_end_screen.timer = 0;
-            g_end_screen.blink_duration = GetRandomValue(1, 4);
+            g_end_screen.blink_duration = RandomRange(&g_manager.cosmetic, 1, 4);
         }
 
-        Event_Queue *epilogue_sequence = &g_event_manager.sequence[Sequence_epilogue];
+        Event_Cursor *epilogue_sequence = &g_event_manager.cursors[Sequence_epilogue];
         UpdateEventQueue(epilogue_sequence, &g_manager, delta_t);
 
         if (!epilogue_sequence->active) StartEventSequence(epilogue_sequence);
         UpdateSpacebarBob(&g_manager.spacebar_text, delta_t);
         DrawTextTripleEffect(g_manager.spacebar_text.text, {g_manager.spacebar_text.pos.x, g_manager.spacebar_text.pos.y + 20.0f}, 
-                             g_manager.spacebar_text.size*2, epilogue_sequence->events[1].fadeable.alpha); 
+                             g_manager.spacebar_text.size*2, EventFadeAlpha(epilogue_sequence, "spacebar")); 
 
         DrawScreenFadeCol(&g_win_screen.white_screen, base_screen_width, base_screen_height, WHITE);
-        if (IsKeyPressed(KEY_SPACE)) {
+        if (input.space_pressed) {
             ResetEvents(&g_event_manager);
             g_win_screen.white_screen.alpha = 0.0f;
             g_manager.state = GameState_title;
         }
 
     } else if (g_manager.state == GameState_tutorial) {
-        Event_Queue *tutorial    = &g_event_manager.sequence[Sequence_tutorial];
+        Event_Cursor *tutorial   = &g_event_manager.cursors[Sequence_tutorial];
         UpdateEventQueue(tutorial, &g_manager, delta_t);
         DrawRectangle(0, 0, base_screen_width, base_screen_height, BLACK);
         if (!tutorial->active) StartEventSequence(tutorial);
+        f32 demon_alpha    = EventFadeAlpha(tutorial, "demon");
+        f32 powerup_alpha  = EventFadeAlpha(tutorial, "powerup");
+        f32 fire_alpha     = EventFadeAlpha(tutorial, "fire");
+        f32 spacebar_alpha = EventFadeAlpha(tutorial, "spacebar");
 
         const char *sacred_fire  = "Clear all of the fire to complete the ritual";
         const char *powerup      = "Collect powerups to clear the fire";
@@ -1887,39 +2479,39 @@ void UpdateAndDrawFrame() {
         Vector2 powerup_text_pos = {text_pos_x, (base_screen_height*0.5f) - font_size};
         Vector2 demon_text_pos   = {text_pos_x, powerup_text_pos.y - font_size*4};
         Vector2 fire_text_pos    = {text_pos_x, powerup_text_pos.y + font_size*4};
-        DrawTextTripleEffect(demon,       demon_text_pos,   font_size, tutorial->events[0].fadeable.alpha);
-        DrawTextTripleEffect(powerup,     powerup_text_pos, font_size, tutorial->events[1].fadeable.alpha);
-        DrawTextTripleEffect(sacred_fire, fire_text_pos,    font_size, tutorial->events[2].fadeable.alpha);
+        DrawTextTripleEffect(demon,       demon_text_pos,   font_size, demon_alpha);
+        DrawTextTripleEffect(powerup,     powerup_text_pos, font_size, powerup_alpha);
+        DrawTextTripleEffect(sacred_fire, fire_text_pos,    font_size, fire_alpha);
 
         UpdateSpacebarBob(&g_manager.spacebar_text, delta_t);
         DrawTextTripleEffect(g_manager.spacebar_text.text, g_manager.spacebar_text.pos, font_size, 
-                             tutorial->events[4].fadeable.alpha);
+                             spacebar_alpha);
         Vector2 demon_pos   = {(f32)demon_text_pos.x - g_tutorial_entities.enemy.frame_rec.width - icon_padding, 
                                (f32)demon_text_pos.y - (g_tutorial_entities.enemy.frame_rec.height*0.5f)-font_size};
         Vector2 powerup_pos = {(f32)powerup_text_pos.x - g_tutorial_entities.powerup.frame_rec.width - icon_padding, 
                                (f32)powerup_text_pos.y - font_size};
         Vector2 fire_pos    = {(f32)fire_text_pos.x - g_tutorial_entities.fire.frame_rec.width - icon_padding, 
                                (f32)fire_text_pos.y - font_size};
-        Animate(&g_tutorial_entities.enemy, g_manager.frame_counter);
-        DrawTextureRec(g_tutorial_entities.enemy.texture, g_tutorial_entities.enemy.frame_rec, 
-                       demon_pos, Fade(WHITE, tutorial->events[0].fadeable.alpha)); 
-        Animate(&g_tutorial_entities.powerup, g_manager.frame_counter);
-        DrawTextureRec(g_tutorial_entities.powerup.texture, g_tutorial_entities.powerup.frame_rec, 
-                       powerup_pos, Fade(WHITE, tutorial->events[1].fadeable.alpha)); 
+        Animate(&g_tutorial_entities.enemy, g_manager.anim_steps);
+        PushTextureRec(queue, RenderLayer_front, NULL, TextureGet(g_tutorial_entities.enemy.texture), 
+                       g_tutorial_entities.enemy.frame_rec, demon_pos, Fade(WHITE, demon_alpha)); 
+        Animate(&g_tutorial_entities.powerup, g_manager.anim_steps);
+        PushTextureRec(queue, RenderLayer_front, NULL, TextureGet(g_tutorial_entities.powerup.texture), 
+                       g_tutorial_entities.powerup.frame_rec, powerup_pos, Fade(WHITE, powerup_alpha)); 
         SetTimeValueForWobbleShader(&g_map.wobble, current_time);
-        BeginShaderMode(g_map.wobble.shader);
-        Animate(&g_tutorial_entities.fire, g_manager.frame_counter);
-        DrawTextureRec(g_tutorial_entities.fire.texture, g_tutorial_entities.fire.frame_rec, 
-                       fire_pos, Fade(WHITE, tutorial->events[2].fadeable.alpha)); 
-        EndShaderMode();
+        Animate(&g_tutorial_entities.fire, g_manager.anim_steps);
+        PushTextureRec(queue, RenderLayer_front, &g_map.wobble.shader, TextureGet(g_tutorial_entities.fire.texture), 
+                       g_tutorial_entities.fire.frame_rec, fire_pos, Fade(WHITE, fire_alpha)); 
+        RenderQueueFlush(queue);
 
-        if (IsKeyPressed(KEY_SPACE)) {
+        if (input.space_pressed) {
             tutorial->active = false;
             GameOver(&g_player, &g_map, &g_manager);
+            StopSoundBuffer(g_manager.sounds);
         }
 
     } else if (g_manager.state == GameState_title) {
-        Event_Queue *title_press = &g_event_manager.sequence[Sequence_begin];
+        Event_Cursor *title_press = &g_event_manager.cursors[Sequence_begin];
         UpdateEventQueue(title_press, &g_manager, delta_t);
         Game_Title *title = &g_title_screen_manager.title;
         UpdateTitleBob(title, delta_t);
@@ -1935,14 +2527,20 @@ void UpdateAndDrawFrame() {
         if (IsKeyPressed(KEY_P)) TriggerTitleBob(title, 150.0f);
 
         UpdateTitleScreenBackground(&g_title_screen_manager, delta_t);
-        DrawTitleScreenBackground(&g_title_screen_manager, current_time);
+        DrawTitleScreenBackground(queue, &g_title_screen_manager, current_time);
 
         Vector2 draw_pos = {title->pos.x, title->pos.y += title->bob};
         if (title->pos.y > base_screen_height) {
-            title->pos.y = 0.0f - title->texture.height;
+            title->pos.y = 0.0f - TextureRegion(title->texture).height;
         }
-        DrawTextureEx(title->texture, {draw_pos.x-4.0f, draw_pos.y+4.0f}, 0.0f, title->scale, BLACK);
-        DrawTextureEx(title->texture, draw_pos, 0.0f, title->scale, WHITE);
+        Rectangle title_source = TextureRegion(title->texture);
+        Rectangle title_dest   = {draw_pos.x, draw_pos.y, 
+                                  title_source.width*title->scale, title_source.height*title->scale};
+        Rectangle shadow_dest  = {title_dest.x - 4.0f, title_dest.y + 4.0f, title_dest.width, title_dest.height};
+        Texture2D title_texture = TextureGet(title->texture);
+        PushTexturePro(queue, RenderLayer_front, NULL, title_texture, title_source, shadow_dest, {0, 0}, BLACK);
+        PushTexturePro(queue, RenderLayer_front, NULL, title_texture, title_source, title_dest,  {0, 0}, WHITE);
+        RenderQueueFlush(queue);
 
         Play_Text *play_text = &g_title_screen_manager.play_text;
         play_text->pos.y     = draw_pos.y + 80.0f;
@@ -1950,7 +2548,7 @@ void UpdateAndDrawFrame() {
         play_text->bob      += delta_t;
         DrawTextTripleEffect(play_text->text, play_text->pos, play_text->font_size);
         
-        if (IsKeyPressed(KEY_SPACE)) {
+        if (input.space_pressed) {
             if (!title_press->active) {
                 StartEventSequence(title_press);
             }
@@ -1973,6 +2571,8 @@ void UpdateAndDrawFrame() {
         }
     }
 
+    ProfilerEndZone(&g_profiler, scene_zone);
+
     // TODO: Play the music here after the game logic has occured to make 
     // sure that all the tracks are playing correctly on thier exact frames 
     // they are supposed to and not a frame behind.
@@ -1984,12 +2584,13 @@ void UpdateAndDrawFrame() {
     // -----------------------------------
 
     // NOTE: Draw the render texture to the screen, scaling it with window size
+    u32 upscale_zone = ProfilerBeginZone(&g_profiler, "upscale");
     BeginDrawing();
     ClearBackground(DARKGRAY);
 
     f32 scale_x = (f32)WINDOW_WIDTH  / base_screen_width;
     f32 scale_y = (f32)WINDOW_HEIGHT / base_screen_height;
-    Vector2 shake_offset = GetScreenShakeOffset(&g_manager.screen_shake);
+    Vector2 shake_offset = GetScreenShakeOffset(&g_manager.screen_shake, &g_manager.cosmetic);
 
     Rectangle dest_rect = {((WINDOW_WIDTH  - (base_screen_width  * scale_x)) * 0.5f) + shake_offset.x,
                            ((WINDOW_HEIGHT - (base_screen_height * scale_y)) * 0.5f) + shake_offset.y,
@@ -2020,22 +2621,77 @@ void UpdateAndDrawFrame() {
                      text_pos_y, font_size, WHITE);
         }
     };
+    ProfilerEndZone(&g_profiler, upscale_zone);
 
-    if (g_manager.fire_cleared && g_player.powered_up) {
-        if (g_manager.state == GameState_play) {
-            g_manager.state = GameState_win;
-        }
-    }
+    u32 overlay_zone = ProfilerBeginZone(&g_profiler, "profiler overlay");
+    ProfilerDrawOverlay(&g_profiler, 12, 64);
+    ProfilerEndZone(&g_profiler, overlay_zone);
 
+    u32 present_zone = ProfilerBeginZone(&g_profiler, "EndDrawing");
     EndDrawing();
+    ProfilerEndZone(&g_profiler, present_zone);
+
+    // NOTE: rlgl's counters only go up, so a frame's share is the 
+    // difference. EndDrawing() flushes the last batch so it's all in by now.
+    rlDrawCounters   draw_totals = rlGetDrawCounters();
+    Profile_Counters counters    = {};
+    counters.draw_calls          = draw_totals.drawCalls    - g_draw_totals.drawCalls;
+    counters.batch_flushes       = draw_totals.batchFlushes - g_draw_totals.batchFlushes;
+    counters.vertices            = draw_totals.vertices     - g_draw_totals.vertices;
+    counters.texture_binds       = draw_totals.textureBinds - g_draw_totals.textureBinds;
+    counters.queue_draws         = g_render_queue.draws;
+    counters.queue_flushes       = g_render_queue.flushes;
+    counters.shader_switches     = g_render_queue.shader_switches;
+    counters.tiles_drawn         = g_tile_cache.tiles_drawn;
+    counters.enemies             = g_manager.enemy_pool.in_use;
+    counters.powerups            = g_manager.powerup_pool.in_use;
+    g_draw_totals                = draw_totals;
+    g_tile_cache.tiles_drawn     = 0;
+    ProfilerEndFrame(&g_profiler, &counters);
+
+    // NOTE: GetTime() counts from InitWindow() so this is how long it took 
+    // to load everything and get the first frame out.
+    if (g_first_frame_time == 0.0) {
+        g_first_frame_time = GetTime();
+        TraceLog(LOG_INFO, "GARDEN: First frame after %.1f ms (%s)", g_first_frame_time*1000.0,
+                 g_asset_library.pack_count ? "asset packs" : "loose files");
+    }
     // -----------------------------------
 }
 
-int main() {
+// NOTE: The bench pulls this whole file in for the draw code and brings its 
+// own main.
+#if !defined(GARDEN_NO_MAIN)
+int main(int argc, char **argv) {
     // -------------------------------------
     // Initialisation
     // -------------------------------------
 
+    // -record <file> writes out the seed and every frame's input as it gets
+    // played, -replay <file> plays one back instead of reading the keyboard.
+    // With -fast it plays back as quickly as it can in a hidden window and
+    // closes at the end, -trace <frame> also writes out the profiler's
+    // frames around that one.
+    //
+    // -bot <rounds> lets the autopilot play that many rounds and then close,
+    // 0 for as long as it's left running, logging each one to BOT_LOG_PATH.
+    // With -fast it runs fixed steps as quickly as it can in a hidden window.
+    b32 fast = false;
+    for (s32 arg = 1; arg < argc; arg++) {
+        if (TextIsEqual(argv[arg], "-fast")) fast = true;
+    }
+    for (s32 arg = 1; arg + 1 < argc; arg++) {
+        if (TextIsEqual(argv[arg], "-record")) ReplayOpenRecording(&g_replay, argv[arg + 1]);
+        if (TextIsEqual(argv[arg], "-replay")) ReplayOpenPlayback(&g_replay, argv[arg + 1], fast);
+        if (TextIsEqual(argv[arg], "-bot"))    BotOpen(&g_bot, (u32)atoi(argv[arg + 1]), fast);
+        if (TextIsEqual(argv[arg], "-trace")) {
+            g_replay.trace_frame  = (u32)atoi(argv[arg + 1]);
+            g_replay.trace_wanted = true;
+        }
+    }
+    b32 run_fast = g_replay.mode == ReplayMode_play_fast || g_bot.fast;
+    if (run_fast) SetConfigFlags(FLAG_WINDOW_HIDDEN);
+
     InitWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "Anunnaki");
 #if defined(PLATFORM_WEB)
     WebAudioInit();
@@ -2058,65 +2714,35 @@ int main() {
     );
 #else
     InitAudioDevice();
+    if (run_fast) SetMasterVolume(0.0f);
 #endif
 
-    // TODO: I don't really know how I feel about this living here. At least if it's 
-    // here I can initialise it how I want it straight away. If I put it into the 
-    // game manager struct then it's more annoying to initialise this array. I'd 
-    // probably have to loop over the array... so I guess for now it can live here 
-    // until I can come up with a clearly better solution.
-    const char *hype_text[HYPE_WORD_COUNT] = {"WOW",      "YEAH",   "AMAZING",      "SANCTIFY", 
-                                              "HOLY COW", "DIVINE", "UNBELIEVABLE", "WOAH",
-                                              "AWESOME",  "COSMIC", "RITUALISTIC",  "LEGENDARY"};
-
-    TilemapInit(&g_map);
-    u32 tilemap[TILEMAP_HEIGHT][TILEMAP_WIDTH] = {
-        { 1, 1, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 1, 1, },
-        { 1, 1, 1, 1, 1, 1, 1, 0, 0, 1, 1, 1, 1, 1, 1, 1, },
-        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
-        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
-        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
-        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
-        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
-        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
-        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
-        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
-        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
-        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
-        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
-        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
-        { 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, },
-        { 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, },
-
-    };
-    Tile tiles[TILEMAP_HEIGHT][TILEMAP_WIDTH];
-
-    g_map.original_map = &tilemap[0][0];
-    g_map.tiles        = &tiles[0][0];
-    TileInit(&g_map);
-
-    PlayerInit(&g_player);
-    // I'm seperating initialising the player animators from 
-    // the rest of the initialisation because I re-init the player
-    // on a game over to set the player back to default values. I 
-    // do not need to re-init the player animators at game over though.
-    PlayerAnimatorInit(&g_player);
-
-    GameManagerInit(&g_manager);
-    g_manager.hype_text = hype_text;
-
-    TitleScreenManagerInit(&g_title_screen_manager);
-
-    EndScreenInit(&g_end_screen);
-
-    SetupEventSequences(&g_event_manager);
-
-    TutorialAnimationInit(&g_tutorial_entities);
+#if defined(PLATFORM_WEB)
+    // NOTE: The packs are fetched in the background and the loader doesn't 
+    // start until the first one has landed.
+    AssetLibraryFetch(&g_asset_library, ASSET_PACK_INDEX_PATH);
+#else
+    AssetLibraryOpen(&g_asset_library, ASSET_PACK_INDEX_PATH);
+    const char *watched[] = {"../assets", "../shaders"};
+    HotReloadOpen(&g_hot_reload, watched, ARRAY_COUNT(watched));
+#endif
 
-    size_t arena_size = 1024*1024;
-    ArenaInit(&g_arena, arena_size); 
+    // Passing -map <size> swaps the hand made map for a big square arena.
+    g_map_width  = TILEMAP_WIDTH;
+    g_map_height = TILEMAP_HEIGHT;
+    for (s32 arg = 1; arg + 1 < argc; arg++) {
+        if (TextIsEqual(argv[arg], "-map")) {
+            g_map_width  = CLAMP((u32)atoi(argv[arg + 1]), TILEMAP_WIDTH, TILEMAP_MAX_SIZE);
+            g_map_height = g_map_width;
+        }
+    }
+    if (g_replay.data) {
+        g_map_width  = g_replay.header.map_width;
+        g_map_height = g_replay.header.map_height;
+    }
 
-    g_target = LoadRenderTextureWebSafe(base_screen_width, base_screen_height); 
+    // NOTE: GameInit() gets run by UpdateAndDrawFrame() once the loader 
+    // has everything it needs, the window is live from the first frame.
 
     // -------------------------------------
     // Main Game Loop
@@ -2124,8 +2750,10 @@ int main() {
 #if defined(PLATFORM_WEB)
     emscripten_set_main_loop(UpdateAndDrawFrame, 0, 1);
 #else
-    SetTargetFPS(60);
-    while (!WindowShouldClose()) {
+    // NOTE: This only caps how often we render. The sim steps at SIM_HZ
+    // whatever this is set to, so it can be removed or swapped for vsync.
+    SetTargetFPS(run_fast ? 0 : 60);
+    while (!WindowShouldClose() && !g_replay.quit && !g_bot.quit) {
         UpdateAndDrawFrame();
     }
 #endif
@@ -2134,11 +2762,17 @@ int main() {
     // -------------------------------------
     // TODO: Need to make sure I unload the music and probably the textures.
 #if !defined(PLATFORM_WEB)
+    ReplayClose(&g_replay);
+    BotClose(&g_bot);
+    HotReloadClose(&g_hot_reload);
     UnloadAllSoundBuffers(&g_manager);
+    TextureRegistryUnloadAll();
+    UnloadRenderTexture(g_tile_cache.target);
     CloseAudioDevice();
+    AssetLibraryClose(&g_asset_library);
     CloseWindow();
 #endif
     // -------------------------------------
     return 0;
 }
-
+#endif
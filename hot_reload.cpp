@@ -0,0 +1,101 @@
+
+// NOTE: Watches the asset and shader folders so a file that gets saved
+// while the game is running can be swapped in without a restart, see
+// HotReloadAssets() in garden.cpp for what happens to each kind. This only
+// says which paths changed, it doesn't know anything about what they are.
+// inotify isn't recursive so every folder under the roots gets a watch of
+// its own. Only Linux has it, everywhere else these do nothing.
+
+#if defined(__linux__) && !defined(PLATFORM_WEB)
+#include <sys/inotify.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+void HotReloadWatchTree(Hot_Reload *reload, const char *dir) {
+    if (reload->watch_count == HOT_RELOAD_MAX_WATCHES) {
+        TraceLog(LOG_WARNING, "RELOAD: Only the first %d folders get watched", HOT_RELOAD_MAX_WATCHES);
+        return;
+    }
+    // NOTE: Saves usually either write the file and close it or write a
+    // temporary one and move it over the top, those two catch both.
+    s32 watch = inotify_add_watch(reload->fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (watch < 0) return;
+
+    u32 slot = reload->watch_count++;
+    reload->watches[slot] = watch;
+    snprintf(reload->dirs[slot], TEXTURE_PATH_MAX, "%s", dir);
+
+    DIR *handle = opendir(dir);
+    if (!handle) return;
+    while (struct dirent *entry = readdir(handle)) {
+        if (entry->d_type != DT_DIR || entry->d_name[0] == '.') continue;
+        char child[TEXTURE_PATH_MAX];
+        if (snprintf(child, sizeof(child), "%s/%s", dir, entry->d_name) < (s32)sizeof(child)) {
+            HotReloadWatchTree(reload, child);
+        }
+    }
+    closedir(handle);
+}
+
+void HotReloadOpen(Hot_Reload *reload, const char **roots, u32 root_count) {
+    *reload    = {};
+    reload->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (reload->fd < 0) {
+        TraceLog(LOG_WARNING, "RELOAD: Couldn't start watching for changes");
+        return;
+    }
+    for (u32 index = 0; index < root_count; index++) HotReloadWatchTree(reload, roots[index]);
+    TraceLog(LOG_INFO, "RELOAD: Watching %u folders for changes", reload->watch_count);
+}
+
+// Fills paths with whatever changed since the last call, each one only
+// once however many times it got written, and returns how many. Never
+// blocks. Anything past max_paths is dropped.
+u32 HotReloadPoll(Hot_Reload *reload, char (*paths)[TEXTURE_PATH_MAX], u32 max_paths) {
+    u32 count = 0;
+    if (reload->fd <= 0) return count;
+
+    alignas(struct inotify_event) char buffer[4096];
+    for (;;) {
+        ssize_t size = read(reload->fd, buffer, sizeof(buffer));
+        if (size <= 0) break;
+
+        for (char *at = buffer; at < buffer + size; at += sizeof(struct inotify_event) + ((struct inotify_event *)at)->len) {
+            struct inotify_event *event = (struct inotify_event *)at;
+            if (!event->len || count == max_paths) continue;
+
+            const char *dir = NULL;
+            for (u32 index = 0; index < reload->watch_count; index++) {
+                if (reload->watches[index] == event->wd) dir = reload->dirs[index];
+            }
+            if (!dir) continue;
+
+            char path[TEXTURE_PATH_MAX];
+            if (snprintf(path, sizeof(path), "%s/%s", dir, event->name) >= (s32)sizeof(path)) continue;
+            b32 seen = false;
+            for (u32 index = 0; index < count; index++) {
+                if (strcmp(paths[index], path) == 0) seen = true;
+            }
+            if (!seen) memcpy(paths[count++], path, sizeof(path));
+        }
+    }
+    return count;
+}
+
+void HotReloadClose(Hot_Reload *reload) {
+    if (reload->fd > 0) close(reload->fd);
+    *reload = {};
+}
+
+#else
+void HotReloadOpen(Hot_Reload *reload, const char **roots, u32 root_count) {
+    *reload = {};
+}
+
+u32 HotReloadPoll(Hot_Reload *reload, char (*paths)[TEXTURE_PATH_MAX], u32 max_paths) {
+    return 0;
+}
+
+void HotReloadClose(Hot_Reload *reload) {}
+#endif
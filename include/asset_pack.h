@@ -0,0 +1,83 @@
+
+// NOTE: The asset pack is every texture and sound the game loads baked into
+// one file by pack_builder.cpp, see build_pack.bat. Textures are already
+// decoded to RGBA8 and sound effects to 16 bit PCM so loading them is just
+// handing raylib a pointer into the pack, nothing gets decoded or copied on
+// the CPU. Music is kept the way it is on disk since it gets streamed.
+//
+// Layout is the header, then the entries, then the data with every blob
+// starting on an ASSET_PACK_ALIGN boundary. Everything is little endian
+// and read in place so these structs can't change without bumping the
+// version.
+//
+// The manifest splits the assets into groups and each group gets its own
+// pack, so the web build can start once the title screen's group is in and
+// fetch the rest while it's up. Which packs there are goes in the index,
+// one line per pack in the order they should be fetched:
+//
+//   pack <group> <file> <content hash in hex> <size in bytes>
+
+#define ASSET_PACK_MAGIC      0x4B415047 // "GPAK"
+#define ASSET_PACK_VERSION    2
+#define ASSET_PACK_ALIGN      16
+#define ASSET_PACK_PATH_MAX   64
+#define ASSET_PACK_GROUP_MAX  16
+#define ASSET_PACK_INDEX_PATH "garden_packs.txt"
+
+enum Asset_Kind {
+    AssetKind_image, // RGBA8, width*height*4 bytes
+    AssetKind_wave,  // Interleaved PCM, frame_count*channels*sample_size/8 bytes
+    AssetKind_file,  // The file exactly as it was on disk
+};
+
+struct Asset_Pack_Header {
+    u32 magic;
+    u32 version;
+    u32 entry_count;
+    u32 content_hash; // Of the entries and then each blob, the index has it too.
+    u64 entries_offset;
+    u64 data_offset;
+};
+
+// Entries are looked up by the same path the game would have loaded the
+// file from, so the pack can be dropped in without touching the callers.
+struct Asset_Pack_Entry {
+    char path[ASSET_PACK_PATH_MAX];
+    u32  hash;
+    u32  kind;
+    u64  offset;
+    u64  size;
+
+    // Images
+    u32  width;
+    u32  height;
+
+    // Waves
+    u32  frame_count;
+    u32  sample_rate;
+    u32  sample_size;
+    u32  channels;
+};
+
+// Entries are found by the hash of their path, the game and the builder
+// both go through this so they always agree.
+inline u32 HashString(const char *string) {
+    // FNV-1a
+    u32 hash = 2166136261u;
+    for (const char *at = string; *at; at++) {
+        hash ^= (u8)*at;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Same as HashString() but over bytes, pass the last hash back in to keep
+// going across several blobs.
+inline u32 HashBytes(const void *data, u64 size, u32 hash = 2166136261u) {
+    const u8 *bytes = (const u8 *)data;
+    for (u64 index = 0; index < size; index++) {
+        hash ^= bytes[index];
+        hash *= 16777619u;
+    }
+    return hash;
+}
@@ -0,0 +1,53 @@
+// NOTE: Generated by atlas_packer.cpp from assets/atlas_manifest.txt, don't
+// edit this by hand. Run build_atlas.bat after changing any of the sprites.
+
+#define ATLAS_PATH   "../assets/atlas.png"
+#define ATLAS_WIDTH  2048
+#define ATLAS_HEIGHT 456
+
+enum Atlas_Region_Id {
+    AtlasRegion_hat_down,
+    AtlasRegion_hat_up,
+    AtlasRegion_hat_left,
+    AtlasRegion_hat_right,
+    AtlasRegion_celebration,
+    AtlasRegion_water_down,
+    AtlasRegion_demon,
+    AtlasRegion_disappear,
+    AtlasRegion_bowl,
+    AtlasRegion_angry,
+    AtlasRegion_meh,
+    AtlasRegion_happy,
+    AtlasRegion_win_blink,
+    AtlasRegion_tile_row,
+    AtlasRegion_bar,
+    AtlasRegion_layer_1,
+    AtlasRegion_layer_3,
+    AtlasRegion_layer_5,
+    AtlasRegion_layer_7,
+    AtlasRegion_anunnaki,
+    AtlasRegion_count,
+};
+
+static const Atlas_Region g_atlas_regions[AtlasRegion_count] = {
+    {"../assets/sprites/hat_down.png", {1866, 2, 80, 40}},
+    {"../assets/sprites/hat_up.png", {1950, 2, 80, 40}},
+    {"../assets/sprites/hat_left.png", {1866, 46, 80, 40}},
+    {"../assets/sprites/hat_right.png", {1950, 46, 80, 40}},
+    {"../assets/sprites/celebration.png", {1622, 370, 240, 40}},
+    {"../assets/sprites/water_down.png", {1866, 173, 120, 20}},
+    {"../assets/sprites/demon.png", {1866, 90, 80, 40}},
+    {"../assets/sprites/disappear.png", {2, 414, 200, 40}},
+    {"../assets/sprites/bowl.png", {550, 414, 260, 20}},
+    {"../assets/sprites/angry.png", {2, 326, 600, 40}},
+    {"../assets/sprites/meh.png", {606, 326, 600, 40}},
+    {"../assets/sprites/happy.png", {1210, 326, 600, 40}},
+    {"../assets/sprites/win_blink.png", {2, 2, 1600, 320}},
+    {"../assets/tiles/tile_row.png", {206, 414, 340, 20}},
+    {"../assets/tiles/bar.png", {2, 370, 320, 40}},
+    {"../assets/tiles/layer_1.png", {326, 370, 320, 40}},
+    {"../assets/tiles/layer_3.png", {650, 370, 320, 40}},
+    {"../assets/tiles/layer_5.png", {974, 370, 320, 40}},
+    {"../assets/tiles/layer_7.png", {1298, 370, 320, 40}},
+    {"../assets/titles/anunnaki.png", {1866, 134, 135, 35}},
+};
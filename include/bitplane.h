@@ -0,0 +1,81 @@
+
+// NOTE: A bit plane is one bit per tile, packed row after row (tile y*width + x
+// is bit (index & 63) of word (index >> 6)) with nothing in between the rows, so
+// a 16x16 map is exactly 256 bits. Moving a whole plane one tile sideways is a
+// shift by 1 and moving it one row is a shift by width, which is what the flood
+// fill is built out of.
+//
+// Which instructions get used is picked at compile time. Define BITPLANE_SCALAR
+// to force the plain C version, otherwise it goes AVX2, SSE2 (always there on
+// x64) or WASM SIMD when the web build is compiled with -msimd128.
+
+#if !defined(BITPLANE_SCALAR) && defined(__AVX2__)
+#define BITPLANE_AVX2 1
+#define BITPLANE_LANES 4
+#define BITPLANE_PATH "avx2"
+#include <immintrin.h>
+#elif !defined(BITPLANE_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64))
+#define BITPLANE_SSE2 1
+#define BITPLANE_LANES 2
+#define BITPLANE_PATH "sse2"
+#include <emmintrin.h>
+#elif !defined(BITPLANE_SCALAR) && defined(__wasm_simd128__)
+#define BITPLANE_WASM 1
+#define BITPLANE_LANES 2
+#define BITPLANE_PATH "wasm simd"
+#include <wasm_simd128.h>
+#else
+#define BITPLANE_LANES 1
+#define BITPLANE_PATH "scalar"
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Planes are always a multiple of this many words so the SIMD loops never
+// need a tail.
+#define BITPLANE_WORD_ALIGN 4
+
+// Every plane made with the same layout is the same size. Each one has pad
+// words of zeroes on both ends so the shifts can read one row past either
+// end of the map without checking.
+struct Bit_Plane_Layout {
+    u32 width;
+    u32 height;
+    u32 word_count;
+    u32 pad;
+};
+
+inline u32 PopCount64(u64 value) {
+#if defined(_MSC_VER)
+    u32 result = (u32)__popcnt64(value);
+#else
+    u32 result = (u32)__builtin_popcountll(value);
+#endif
+    return result;
+}
+
+// The value can't be zero.
+inline u32 CountTrailingZeros64(u64 value) {
+#if defined(_MSC_VER)
+    unsigned long result;
+    _BitScanForward64(&result, value);
+#else
+    u32 result = (u32)__builtin_ctzll(value);
+#endif
+    return (u32)result;
+}
+
+inline void BitPlaneSet(u64 *plane, u32 index) {
+    plane[index >> 6] |= 1ULL << (index & 63);
+}
+
+inline void BitPlaneUnset(u64 *plane, u32 index) {
+    plane[index >> 6] &= ~(1ULL << (index & 63));
+}
+
+inline b32 BitPlaneGet(u64 *plane, u32 index) {
+    b32 result = (plane[index >> 6] >> (index & 63)) & 1;
+    return result;
+}
@@ -31,3 +31,112 @@ void ArenaClear(Memory_Arena *arena) {
 void ArenaFree(Memory_Arena *arena) {
     free(arena->base);
 }
+
+// A fixed capacity pool of same sized things. Freed slots go on a 
+// free list and get handed out again, so unlike the arena a pool can 
+// run forever without growing. Every slot carries a generation that 
+// bumps whenever it's allocated or freed, which means a handle taken 
+// out before the slot got recycled won't resolve anymore.
+#define POOL_NONE 0xFFFFFFFF
+
+struct Pool_Handle {
+    u32 index;
+    u32 generation;
+};
+
+struct Memory_Pool {
+    u8  *base;
+    u32 *generations;
+    u32 *next_free;
+    u32  stride;
+    u32  capacity;
+
+    u32  free_head;
+    // Slots at or past this have never been handed out since the last reset.
+    u32  bump;
+
+    // Usage counters
+    u32  in_use;
+    u32  peak_in_use;
+    u32  alloc_count;
+    u32  free_count;
+    u32  failed_count;
+};
+
+void PoolInit(Memory_Pool *pool, Memory_Arena *arena, u32 stride, u32 capacity) {
+    pool->base         = (u8 *)ArenaAlloc(arena, (size_t)stride*capacity);
+    pool->generations  = (u32 *)ArenaAlloc(arena, sizeof(u32)*capacity);
+    pool->next_free    = (u32 *)ArenaAlloc(arena, sizeof(u32)*capacity);
+    pool->stride       = stride;
+    pool->capacity     = capacity;
+    pool->free_head    = POOL_NONE;
+    pool->bump         = 0;
+    pool->in_use       = 0;
+    pool->peak_in_use  = 0;
+    pool->alloc_count  = 0;
+    pool->free_count   = 0;
+    pool->failed_count = 0;
+    for (u32 index = 0; index < capacity; index++) {
+        pool->generations[index] = 0;
+    }
+}
+
+// Drops everything in the pool in one go. Handles from before the reset 
+// fail to resolve because their index is past the bump, and once the slot 
+// gets handed out again its generation will have moved on.
+void PoolReset(Memory_Pool *pool) {
+    pool->free_head = POOL_NONE;
+    pool->bump      = 0;
+    pool->in_use    = 0;
+}
+
+void *PoolAlloc(Memory_Pool *pool, Pool_Handle *handle) {
+    u32 index = POOL_NONE;
+    if (pool->free_head != POOL_NONE) {
+        index           = pool->free_head;
+        pool->free_head = pool->next_free[index];
+    } else if (pool->bump < pool->capacity) {
+        index = pool->bump++;
+    }
+
+    void *result = NULL;
+    if (index != POOL_NONE) {
+        // NOTE: Odd generations are live, even ones are free, so a fresh 
+        // pool never has a slot that matches a zeroed out handle.
+        pool->generations[index] += (pool->generations[index] & 1) ? 2 : 1;
+        pool->in_use++;
+        pool->alloc_count++;
+        if (pool->in_use > pool->peak_in_use) pool->peak_in_use = pool->in_use;
+
+        result = pool->base + (size_t)index*pool->stride;
+        if (handle) *handle = {index, pool->generations[index]};
+    } else {
+        pool->failed_count++;
+        if (handle) *handle = {};
+    }
+    return result;
+}
+
+b32 PoolHandleValid(Memory_Pool *pool, Pool_Handle handle) {
+    b32 result = (handle.index < pool->bump &&
+                  handle.generation == pool->generations[handle.index]);
+    return result;
+}
+
+void *PoolGet(Memory_Pool *pool, Pool_Handle handle) {
+    void *result = NULL;
+    if (PoolHandleValid(pool, handle)) {
+        result = pool->base + (size_t)handle.index*pool->stride;
+    }
+    return result;
+}
+
+void PoolFree(Memory_Pool *pool, Pool_Handle handle) {
+    ASSERT(PoolHandleValid(pool, handle));
+    u32 index                = handle.index;
+    pool->generations[index] += 1;
+    pool->next_free[index]   = pool->free_head;
+    pool->free_head          = index;
+    pool->in_use--;
+    pool->free_count++;
+}
@@ -7,16 +7,57 @@
 #define SPRITE_WIDTH 20
 #define TILE_ATLAS_COUNT 17
 #define WALL_ATLAS_COUNT 15
-#define STACK_MAX_SIZE 4096
+#define TILE_CHUNK_SHIFT 5
+#define TILE_CHUNK_SIZE (1 << TILE_CHUNK_SHIFT)
+#define TILE_CHUNK_MASK (TILE_CHUNK_SIZE - 1)
+#define TILE_CHUNK_AREA (TILE_CHUNK_SIZE*TILE_CHUNK_SIZE)
+#define TILEMAP_MAX_SIZE 1024
 #define MB(x) x*1024ULL*1024ULL
 #define ARENA_SIZE MB(500)
 #define FRAME_SPEED 8
+#define SIM_HZ 60
+#define SIM_DT (1.0f / SIM_HZ)
+#define SIM_MAX_FRAME_TIME 0.25f
 #define INPUT_MAX 5
+#define INPUT_FRAME_MAX 16
+#define ENCLOSURE_PENDING_MAX 8
+#define ENCLOSURE_MAX_GROUPS 4
+#define TEXTURE_REGISTRY_MAX 64
+#define TEXTURE_PATH_MAX 128
+#define RENDER_QUEUE_START 4096 // Commands the queue starts out with room for, it doubles after.
+#define ASSET_LOADER_MAX_JOBS 64
+#define ASSET_LOADER_MAX_THREADS 4
+#define ASSET_LOADER_UPLOAD_BUDGET 0.004 // Seconds of GPU/audio uploads per frame.
+#define WEB_SONG_DECODE_BUDGET 0.002 // Seconds of QOA song decoding per frame on the web.
+#define WEB_SONG_DECODE_SAMPLES 10240 // One QOA frame of stereo, what a slice decodes at a time.
+#define ASSET_LIBRARY_MAX_PACKS 8
+#define STEM_GROUP_MAX_STEMS 4
+#define STEM_GROUP_REFILL_FRAMES 2048 // Frames mixed per refill, about 46ms at 44.1kHz.
+#define PROFILER_FRAME_COUNT 240
+#define PROFILER_MAX_ZONES 48
+#define PROFILER_TRACE_PATH "garden_trace.json"
+#define REPLAY_MAGIC 0x4C505247 // "GRPL"
+#define REPLAY_VERSION 1
+#define REPLAY_CHECK_INTERVAL 60 // Frames between the state checksums in a replay.
+#define BOT_SEARCH_MAX 1024 // Most tiles one of the bot's searches looks at.
+#define BOT_SAFE_SPACE 24 // Room a move has to leave the bot before it counts as safe.
+#define BOT_PRESS_INTERVAL 0.5f // Seconds between the bot's space presses off the play screen.
+#define BOT_FRAME_BUCKETS 2000
+#define BOT_FRAME_BUCKET_MS 0.05 // So the frame time histogram covers 100 ms, anything slower lands in the last one.
+#define BOT_LOG_PATH "garden_soak.csv"
+#define EVENTS_PATH "../assets/events.txt"
+#define TIMELINE_MAX_EVENTS 64
+#define TIMELINE_MAX_FADES 8 // Named fades one sequence can have.
+#define TIMELINE_NAME_MAX 16
+#define TIMELINE_RELOAD_INTERVAL 0.5f // Seconds between looking at whether the events file changed.
+#define HOT_RELOAD_MAX_WATCHES 32
+#define HOT_RELOAD_MAX_CHANGES 16 // Changed files handled in one frame, any past that get missed.
+#define WOBBLE_FS_PATH "../shaders/wobble.fs"
+#define WOBBLE_SHADER_MAX 8
 #define HYPE_WORD_COUNT 12
 #define HYPE_SFX_BASE 5
 #define MAX_BURSTS 32
 #define BG_LAYERS 8 
-#define MAX_EVENTS 16
 #define MAX_FADEABLES 32
 
 const int base_screen_width  = 320;
@@ -28,12 +69,29 @@ enum Tile_Type {
     TileType_floor       = 2,
 };
 
+// Each flag lives in its own bit plane, the flag is just (1 << plane) so 
+// several can still be asked about at once.
+enum Tile_Plane {
+    TilePlane_fire,
+    TilePlane_visited,
+    TilePlane_powerup,
+    TilePlane_enemy,
+    TilePlane_count,
+};
+
 enum Tile_Flags {
-    TileFlag_fire      = 1 << 0,
-    TileFlag_visited   = 1 << 1,
-    TileFlag_powerup   = 1 << 2,
-    TileFlag_enemy     = 1 << 3,
-    TileFlag_moved     = 1 << 4,
+    TileFlag_fire      = 1 << TilePlane_fire,
+    TileFlag_visited   = 1 << TilePlane_visited,
+    TileFlag_powerup   = 1 << TilePlane_powerup,
+    TileFlag_enemy     = 1 << TilePlane_enemy,
+};
+
+enum Sim_Event_Flags {
+    SimEvent_game_over       = 1 << 0,
+    SimEvent_powerup_collect = 1 << 1,
+    SimEvent_powerup_over    = 1 << 2,
+    SimEvent_enemy_slain     = 1 << 3,
+    SimEvent_hype            = 1 << 4,
 };
 
 enum Game_State {
@@ -113,6 +171,25 @@ enum Atlas_Type {
     Atlas_count,
 };
 
+// Draw order, bottom to top. The world layers get drawn through the map 
+// camera, everything else is in screen space. 
+enum Render_Layer {
+    RenderLayer_back,
+    RenderLayer_middle,
+    RenderLayer_front,
+
+    RenderLayer_ground,
+    RenderLayer_floor,
+    RenderLayer_fire,
+    RenderLayer_pickups,
+    RenderLayer_enemies,
+    RenderLayer_water,
+    RenderLayer_player,
+
+    RenderLayer_overlay,
+    RenderLayer_count,
+};
+
 enum Song_Type {
     Song_play,
     Song_play_muted,
@@ -123,6 +200,28 @@ enum Song_Type {
 };
 
 
+// NOTE: A stem either streams QOA a refill at a time or, for anything
+// else, was decoded to f32 up front and plays out of the wave.
+struct Stem {
+    void *qoa;
+    Wave  wave;
+    f32   gain;
+    f32   target_gain;
+};
+
+// Several songs written to line up that play as one stream, see music.cpp.
+struct Stem_Group {
+    AudioStream stream;
+    Stem        stems[STEM_GROUP_MAX_STEMS];
+    u32         stem_count;
+    u32         channels;
+    u32         sample_rate;
+    u32         frame_count; // The shortest stem, they all loop there.
+    u32         position;
+    f32        *decoded;     // One refill of one stem.
+    f32        *mixed;       // One refill of everything.
+};
+
 struct Play_Text {
     const char *text;
     u32         font_size;
@@ -135,22 +234,182 @@ struct Fade_Object {
     f32       duration;
     f32       timer;
     Fade_Type fade_type;
-};
-
+    u32       fade_slot; // One past where it sits in the manager's fadeables while it's running.
+};
+
+// Index into the texture registry. Zero is the null handle so a 
+// zeroed out Animation doesn't point at a real texture.
+struct Texture_Handle {
+    u32 index;
+};
+
+// NOTE: Sprites that were packed into the atlas share its texture and 
+// only differ by region, they hold a ref on the atlas entry instead of 
+// owning a texture of their own. Everything else has a region covering 
+// the whole texture.
+// NOTE: An entry whose job is set is still being loaded in the background 
+// and has no texture yet, see TextureRegistryResolve().
+struct Texture_Entry {
+    char           path[TEXTURE_PATH_MAX];
+    u32            hash;
+    u32            ref_count;
+    Texture2D      texture;
+    Rectangle      region;
+    Texture_Handle atlas;
+    u32            job;
+};
+
+enum Asset_Pack_State {
+    AssetPack_waiting,  // Web only, hasn't been asked for yet.
+    AssetPack_fetching, // Web only, downloading or coming out of IndexedDB.
+    AssetPack_arrived,
+    AssetPack_failed,
+};
+
+// One garden_<group>.pak once it's been mapped or fetched, see 
+// asset_pack.cpp. A zeroed pack has no entries so every lookup just misses.
+struct Asset_Pack {
+    u8               *base;
+    size_t            size;
+    Asset_Pack_Entry *entries;
+    u32               entry_count;
+    u32               state;
+    char              group[ASSET_PACK_GROUP_MAX];
+    char              path[ASSET_PACK_PATH_MAX];
+    u32               content_hash; // What the index says it should be.
+    u64               index_size;   // And how many bytes the index says it is.
+    b32               refetched;    // Web only, the cached copy was stale.
+    void             *fetch;        // Web only, the emscripten_fetch_t that owns base.
+    void             *file;         // Windows only, handles to unmap on close.
+    void             *mapping;
+};
+
+// Every pack in the index. On the web they arrive one at a time in index
+// order, anything that looks an asset up before its pack is in should 
+// check AssetLibraryPending() before deciding it isn't packed.
+struct Asset_Library {
+    Asset_Pack packs[ASSET_LIBRARY_MAX_PACKS];
+    u32        pack_count;
+    b32        index_pending; // Web only, still fetching the index.
+    u32        arrival_count; // Goes up every time a pack arrives or fails.
+};
+
+enum Asset_Job_State {
+    AssetJob_queued,
+    AssetJob_decoding,
+    AssetJob_decoded,
+    AssetJob_done,
+    AssetJob_waiting, // Web only, its pack hasn't arrived yet.
+};
+
+// Startup assets have to be in before the game can init, background 
+// ones keep streaming in after that.
+enum Asset_Priority {
+    AssetPriority_startup,
+    AssetPriority_background,
+};
+
+// NOTE: Workers only ever move a job from queued to decoded and the main 
+// thread does everything after that, state is the only thing both touch.
+struct Asset_Job {
+    char           path[TEXTURE_PATH_MAX];
+    Asset_Kind     kind;
+    Asset_Priority priority;
+    volatile u32   state;
+    b32            owns_data;
+    b32            taken;
+
+    // Filled in by the decode.
+    Image          image;
+    Wave           wave;
+    u8            *file_data;
+    s32            file_size;
+
+    // Filled in by the upload. Files don't need one, whoever takes
+    // them decides what they are.
+    Texture2D      texture;
+    Sound          sound;
+};
+
+struct Asset_Loader {
+    Asset_Job      jobs[ASSET_LOADER_MAX_JOBS];
+    u32            job_count;
+    u32            done_count;
+    u32            thread_count;
+    Asset_Library *library;
+    u32            arrivals_seen;
+};
+
+// One named rectangle in the packed sprite atlas, see atlas_regions.h.
+struct Atlas_Region {
+    const char *path;
+    Rectangle   rect;
+};
+
+struct Texture_Registry {
+    Texture_Entry entries[TEXTURE_REGISTRY_MAX];
+    u32           load_count;
+};
+
+// NOTE: Copying an Animation copies the handle without taking a ref, 
+// so spawned entities just borrow the prototype's texture.
 struct Animation {
-    Texture2D texture;
-    u32       max_frames;
-    u32       current_frame;
-    Rectangle frame_rec;
-    bool      looping;
-};
-
+    Texture_Handle texture;
+    u32            max_frames;
+    u32            current_frame;
+    Rectangle      frame_rec;
+    bool           looping;
+};
+
+// The tile state is split out into one small array per field so a pass 
+// over the map that only cares about types only ever touches types. The 
+// flags aren't in here, they're bit planes over the whole map.
+struct Tile_Chunk {
+    u8 types[TILE_CHUNK_AREA];
+    u8 seeds[TILE_CHUNK_AREA];
+};
+
+// One bit per tile for every flag, plus the masks the flood fill needs that 
+// only change when the map gets reset.
+struct Tile_Planes {
+    Bit_Plane_Layout layout;
+    u64             *flags[TilePlane_count];
+    u64             *floor;
+    // Floor minus the first/last column, see BitPlaneFloodPass().
+    u64             *floor_from_left;
+    u64             *floor_from_right;
+    u64             *scratch;
+};
+
+// Where a tile lives, not the tile itself. It's cheap enough to make one 
+// whenever you need it and pass it around by value.
 struct Tile {
-    Tile_Type type;
-    u32       flags;
-    u32       seed;
-    Vector2   pos;
-    Animation animator;
+    Tile_Chunk  *chunk;
+    Tile_Planes *planes;
+    u32          slot;
+    u32          index;
+};
+
+// Keeps track of the tiles that caught fire since the last enclosure check
+// so we only need to look around those instead of flood filling the map.
+struct Enclosure_Tracker {
+    u32       pending[ENCLOSURE_PENDING_MAX];
+    u32       pending_count;
+    b32       needs_full_check;
+    b32       reset_is_one_area;
+    b32       first_check;
+
+    // Scratch for the searches, one entry per tile.
+    u32       stamp;
+    u32      *visit_stamp;
+    u8       *visit_group;
+    u32      *queues[ENCLOSURE_MAX_GROUPS];
+
+    // Stats
+    u32       full_checks;
+    u32       local_checks;
+    u32       searches;
+    u32       tiles_searched;
 };
 
 struct Tilemap {
@@ -161,7 +420,23 @@ struct Tilemap {
     Wobble_Shader wobble;
 
     u32          *original_map;
-    Tile         *tiles;
+
+    // Tiles live in square chunks of TILE_CHUNK_SIZE on a side so a big map 
+    // doesn't need one giant allocation. Go through TileAt()/GetTile().
+    Tile_Chunk  **chunks;
+    u32           chunks_x;
+    u32           chunks_y;
+    Tile_Planes   planes;
+    // Bumped every TileInit() so anything caching the tiles knows to redo them.
+    u32           reset_count;
+    // Picks the tile seeds, TileInit() draws a chunk's worth at a time.
+    Random_Series random;
+
+    // Per tile handle for whatever is standing there, zeroed if nothing.
+    Pool_Handle  *enemy_slots;
+    Pool_Handle  *powerup_slots;
+
+    Enclosure_Tracker enclosure;
 };
 
 struct Input_Buffer {
@@ -172,6 +447,7 @@ struct Input_Buffer {
 
 struct Player {
     Vector2          pos;
+    Vector2          prev_pos;
     Vector2          target_pos;
     Vector2          size;
     Color            col;
@@ -191,13 +467,14 @@ struct Player {
 
 struct Enemy {
     u32        tile_index;
+    u32        prev_tile_index;
     Animation  animators[EnemyAnimator_count];
     Enemy     *next;
     Enemy     *prev;
 };
 
 struct Powerup {
-    Tile      *tile;
+    u32        tile_index;
     Animation  animator;
     Powerup   *next;
     Powerup   *prev;
@@ -240,19 +517,109 @@ struct Text_Burst {
 };
 
 struct Game_Title {
-    Texture2D texture;
-    u32       scale;
-    Vector2   pos;
-    f32       bob;
-    f32       bob_velocity;
+    Texture_Handle texture;
+    u32            scale;
+    Vector2        pos;
+    f32            bob;
+    f32            bob_velocity;
 };
 
 struct Background_Layer {
+    Texture_Handle texture;
+    Vector2        pos;
+    s32            dir;
+    f32            scroll_speed;
+    b32            should_wobble;
+};
+
+struct Render_Command {
     Texture2D texture;
-    Vector2   pos;
-    s32       dir;
-    f32       scroll_speed;
-    b32       should_wobble;
+    Shader    shader;
+    Rectangle source;
+    Rectangle dest;
+    Vector2   origin;
+    Color     tint;
+};
+
+// Draws get pushed in here and only go out to rlgl on a flush, sorted by 
+// layer then shader then texture, so every shader change is paid for once 
+// per flush instead of once per sprite. Each key is the sort order in the 
+// high bits with the command index in the low 32. The arrays grow when a 
+// frame pushes more than they hold rather than flushing early, since an 
+// early flush would put everything after it on top whatever its layer.
+struct Render_Queue {
+    Render_Command *commands;
+    u64            *keys;
+    u32             capacity;
+    u32             count;
+    Camera2D        camera;
+
+    // Stats, reset every frame
+    u32             draws;
+    u32             flushes;
+    u32             shader_switches;
+};
+
+// The floor and wall tiles around the camera drawn once into a render texture 
+// so a frame only has to copy it out instead of drawing every tile. Tiles 
+// wrap around in the texture, so when the camera scrolls only the rows and 
+// columns that just came into view get drawn in.
+struct Tile_Cache {
+    RenderTexture2D target;
+    u32             width;
+    u32             height;
+
+    // First tile of the window that's in the texture right now.
+    u32             origin_x;
+    u32             origin_y;
+    b32             valid;
+    u32             reset_count;
+    // Walls get left out while they wobble and get drawn live instead.
+    b32             walls_baked;
+
+    // Stats, reset every frame
+    u32             tiles_drawn;
+};
+
+struct Profile_Zone {
+    const char *name;
+    f64         start;    // Seconds from the start of the frame.
+    f64         duration;
+    u32         depth;
+};
+
+// Everything the overlay shows next to the timings, per frame.
+struct Profile_Counters {
+    // What rlgl actually sent to the GPU.
+    u32 draw_calls;
+    u32 batch_flushes;
+    u32 vertices;
+    u32 texture_binds;
+
+    u32 queue_draws;
+    u32 queue_flushes;
+    u32 shader_switches;
+    u32 tiles_drawn;
+    u32 enemies;
+    u32 powerups;
+};
+
+struct Profile_Frame {
+    f64              start;
+    f64              duration;
+    Profile_Zone     zones[PROFILER_MAX_ZONES];
+    u32              zone_count;
+    Profile_Counters counters;
+};
+
+// The last PROFILER_FRAME_COUNT frames in a ring, see profiler.cpp.
+struct Profiler {
+    Profile_Frame frames[PROFILER_FRAME_COUNT];
+    u32           frame_index; // The one being recorded.
+    u32           frame_count; // Finished frames in the ring.
+    u32           depth;
+    b32           recording;
+    b32           show_overlay;
 };
 
 struct Title_Screen_Manager {
@@ -263,11 +630,11 @@ struct Title_Screen_Manager {
 };
 
 struct End_Screen {
-    Texture2D     textures[EndLayer_count];
-    Wobble_Shader shaders[EndLayer_count];
-    Animation     animator;
-    f32           timer;
-    f32           blink_duration;
+    Texture_Handle textures[EndLayer_count];
+    Wobble_Shader  shaders[EndLayer_count];
+    Animation      animator;
+    f32            timer;
+    f32            blink_duration;
 };
 
 struct Screen_Shake {
@@ -276,35 +643,56 @@ struct Screen_Shake {
     f32 decay;
 };
 
-struct Event {
-    Event_Type  type;
-    f32         duration;
-    u32         new_state;
-    Fade_Object fadeable;
+// One step of a sequence. Value is the Game_State for a state change and
+// which of the sequence's fades it is for a fade.
+struct Timeline_Event {
+    Event_Type type;
+    f32        duration;
+    u32        value;
 };
 
-struct Event_Queue {
-    Event events[MAX_EVENTS];
-    u32   count;
-    u32   index;
-    f32   timer;
-    bool  active;
+struct Timeline_Sequence {
+    u32  first;
+    u32  count;
+    u32  fade_count;
+    char fade_names[TIMELINE_MAX_FADES][TIMELINE_NAME_MAX];
+};
+
+// What EVENTS_PATH compiles into. Nothing writes to it while the game is
+// running except a reload, the cursors only read it.
+struct Timeline {
+    Timeline_Sequence sequences[Sequence_count];
+    Timeline_Event    events[TIMELINE_MAX_EVENTS];
+    u32               event_count;
+};
+
+// Where one sequence is up to and the fades it drives, so starting it over
+// is just zeroing this.
+struct Event_Cursor {
+    Event_Sequence  sequence;
+    const Timeline *timeline;
+    u32             index;
+    f32             timer;
+    bool            active;
+    Fade_Object     fades[TIMELINE_MAX_FADES];
 };
 
 struct Event_Manager {
-    Event_Queue sequence[Sequence_count];
-    Event_Queue original_sequence[Sequence_count];
+    Timeline     timeline;
+    Event_Cursor cursors[Sequence_count];
+    long         mod_time;
+    f32          reload_timer;
 };
 
 struct Gui {
-    Texture2D    bar;
-    God_Animator face_type;
-    Animation    animators[GodAnimator_count];
-    f32          anim_timer;
-    f32          anim_duration;
-    f32          step;
-    f32          face_scale;
-    Vector2      face_pos;
+    Texture_Handle bar;
+    God_Animator   face_type;
+    Animation      animators[GodAnimator_count];
+    f32            anim_timer;
+    f32            anim_duration;
+    f32            step;
+    f32            face_scale;
+    Vector2        face_pos;
 };
 
 struct Win_Screen {
@@ -322,11 +710,12 @@ struct Game_Manager {
     u32           satisfied_score;
     u32           score_multiplier;
 
-    u32           frame_counter;
+    f32           anim_timer;
+    u32           anim_steps;
     b32           fire_cleared;
     Game_State    state;
 
-    Texture2D     atlas[Atlas_count];
+    Texture_Handle atlas[Atlas_count];
     Gui           gui;
 
     // Enemy controller
@@ -339,6 +728,14 @@ struct Game_Manager {
     Enemy         enemy_sentinel;
     Powerup       powerup_sentinel;
 
+    // Where the enemies and powerups actually live
+    Memory_Pool   enemy_pool;
+    Memory_Pool   powerup_pool;
+
+    // Prototype animations that get copied into every spawned entity.
+    Animation     enemy_animators[EnemyAnimator_count];
+    Animation     powerup_animator;
+
     // Hype Sound
     f32           hype_sound_timer;
     u32           hype_prev_index;
@@ -348,26 +745,169 @@ struct Game_Manager {
     Sound         sounds[SoundEffect_count];
     Text_Burst    bursts[MAX_BURSTS];
 
+    // NOTE: Song_play and Song_play_muted aren't in here on desktop, they
+    // play together as the stems of play_stems.
     Music         song[Song_count];
+    Stem_Group    play_stems;
     f32           play_song_volume;
     f32           play_muted_song_volume;
     b32           should_title_music_play;
     u32           last_song_bit;
 
     Screen_Shake  screen_shake;
+    // Only for what the drawing picks, the shake and the faces blinking.
+    Random_Series cosmetic;
 
-    // Store a list of pointers to fadeable objects
-    // to easily access them and iterate over them to 
-    // fade their alpha values.
+    // The fades that are running right now, finished ones get swapped out
+    // so a frame only ever walks the live ones.
     Fade_Object   *fadeables[MAX_FADEABLES];
     u32           fade_count;
 
     Spacebar_Text spacebar_text;
 };
 
-struct StackU32 {
-    u32 x[STACK_MAX_SIZE];
-    u32 y[STACK_MAX_SIZE];
-    s32 top;
+// Everything the sim needs to know about the player's input for a
+// single step. The platform layer fills this in from the keyboard.
+struct Input_Frame {
+    Direction_Facing directions[INPUT_FRAME_MAX];
+    u32              direction_count;
+    b32              space_pressed;
+};
+
+// Things that happened during a sim step that the platform layer
+// might want to react to, mostly by playing sounds.
+struct Sim_Events {
+    u32 flags;
+    u32 hype_index;
+};
+
+struct Game_Sim {
+    Memory_Arena *arena;
+    Tilemap      *map;
+    Player       *player;
+    Game_Manager *manager;
+
+    f64           time;
+    Sim_Events    events;
+
+    // Spawns and enemy moves, then the hype words and text bursts in their 
+    // own series so changing how those look doesn't change the gameplay.
+    Random_Series random;
+    Random_Series effects;
+};
+
+enum Replay_Mode {
+    ReplayMode_off,
+    ReplayMode_record,
+    ReplayMode_play,
+    ReplayMode_play_fast,
+};
+
+struct Replay_Header {
+    u32 magic;
+    u32 version;
+    u32 seed;
+    u32 map_width;
+    u32 map_height;
+    u32 check_interval;
+    f64 start_time;
+};
+
+// A recording is the header and then one entry per frame from GameInit()
+// on, see replay.cpp for how they're packed.
+struct Replay {
+    Replay_Mode   mode;
+    Replay_Header header;
+    FILE         *file;  // Recording
+    u8           *data;  // Playing, the whole file.
+    u32           size;
+    u32           cursor;
+
+    u32           frame_index;
+    u32           last_frame_us;
+    f64           time;
+    b32           quit; // Fast playback ran out, the game closes.
+    u32           diverged_frame;
+    b32           diverged;
+
+    // Playing it back fast times each frame to find the slow ones.
+    f64           last_frame_start;
+    f64           started;
+    f64           worst_frame_time;
+    u32           worst_frame;
+
+    // -trace <frame> writes out the profiler's frames around that one.
+    u32           trace_frame;
+    b32           trace_wanted;
+    b32           trace_written;
+};
+
+enum Bot_Goal {
+    BotGoal_none,
+    BotGoal_fire,    // Powered up, clear it.
+    BotGoal_powerup,
+    BotGoal_enemy,   // Walk circles round them until the fire closes in.
+};
+
+struct Bot {
+    b32            active;
+    b32            fast;        // Fixed SIM_DT frames as quick as they'll go.
+    b32            quit;        // Played round_limit rounds, the game closes.
+    u32            round_limit; // 0 keeps going until the window gets closed.
+    u32            rounds;
+    u32            wins;
+    Random_Series  random;
+    FILE          *log;
+    Texture_Registry *textures; // Only looked at, for the texture counts.
+
+    // The tile the last direction was picked for, the next pick is for 
+    // whichever tile the player heads to after that.
+    u32            decided_tile;
+    f32            press_timer;
+    f64            time;
+
+    // Search scratch. A stamp per tile means nothing needs clearing 
+    // between searches.
+    u32           *seen;
+    u32            seen_count;
+    u32            stamp;
+    u32            queue[BOT_SEARCH_MAX];
+    u8             first_dir[BOT_SEARCH_MAX];
+
+    // The round being played.
+    b32            in_round;
+    f64            round_start;
+    u32            round_score;
+    u32            round_frames;
+    f64            last_frame;
+    f64            worst_frame;
+    u32            frame_buckets[BOT_FRAME_BUCKETS];
+
+    // Highest seen so far. Once the first few rounds are over, anything 
+    // that keeps setting new highs is leaking.
+    size_t         peak_arena;
+    u32            peak_texture_refs;
+    u32            peak_fadeables;
+};
+
+// The folders hot_reload.cpp is watching, a watch descriptor and the path
+// it was made for in each slot.
+struct Hot_Reload {
+    s32  fd;
+    s32  watches[HOT_RELOAD_MAX_WATCHES];
+    char dirs[HOT_RELOAD_MAX_WATCHES][TEXTURE_PATH_MAX];
+    u32  watch_count;
+};
+
+// A QOA song being decoded for WebAudio a slice at a time, see 
+// WebAudioSongDecodeUpdate(). Nothing's being decoded while qoa is null.
+struct Web_Song_Decode {
+    void *qoa;         // The qoaplay_desc, reads straight out of the pack.
+    u8   *file_data;   // Only when the song wasn't in a pack, freed at the end.
+    s32   slot;
+    b32   asked;       // The game is waiting on it, rather than it being ahead of time.
+    u32   channels;
+    u32   frame_count;
+    u32   frames_done;
+    f32   samples[WEB_SONG_DECODE_SAMPLES];
 };
-
@@ -0,0 +1,62 @@
+
+// NOTE: Every bit of randomness in the game comes out of a Random_Series
+// that belongs to whatever is using it, rather than one global stream, so
+// drawing the screen shake can't change where the next enemy spawns and a
+// replay or a second sim only has to seed its own series. It's PCG32, the
+// stream picks one of 2^63 sequences that don't overlap so every series
+// can be seeded from the same number.
+
+enum Random_Stream {
+    RandomStream_tiles,    // Which atlas frame each tile gets.
+    RandomStream_gameplay, // Spawns and enemy moves.
+    RandomStream_effects,  // Hype words and text bursts the sim kicks off.
+    RandomStream_cosmetic, // Screen shake and the faces, drawing only.
+    RandomStream_bot,      // The autopilot's tie breaks.
+};
+
+struct Random_Series {
+    u64 state;
+    u64 increment;
+};
+
+inline u32 RandomNextU32(Random_Series *series) {
+    u64 old        = series->state;
+    series->state  = old*6364136223846793005ULL + series->increment;
+    u32 xorshifted = (u32)(((old >> 18) ^ old) >> 27);
+    u32 rotate     = (u32)(old >> 59);
+    u32 result     = (xorshifted >> rotate) | (xorshifted << ((0u - rotate) & 31));
+    return result;
+}
+
+inline Random_Series RandomSeed(u64 seed, u32 stream) {
+    Random_Series result = {0, ((u64)stream << 1) | 1};
+    RandomNextU32(&result);
+    result.state += seed;
+    RandomNextU32(&result);
+    return result;
+}
+
+// Between min and max inclusive, same as GetRandomValue(). The multiply
+// instead of a modulo keeps it fast and about as fair for small ranges.
+inline s32 RandomRange(Random_Series *series, s32 min, s32 max) {
+    u32 range  = (u32)(max - min) + 1;
+    s32 result = min + (s32)(((u64)RandomNextU32(series)*range) >> 32);
+    return result;
+}
+
+// Zero up to but not including one.
+inline f32 RandomUnilateral(Random_Series *series) {
+    f32 result = (f32)(RandomNextU32(series) >> 8)*(1.0f / 16777216.0f);
+    return result;
+}
+
+// Fills values with the next count numbers in the series, which comes out
+// the same as calling RandomNextU32() count times but keeps the state in a
+// register for the whole loop.
+inline void RandomFill(Random_Series *series, u32 *values, u32 count) {
+    Random_Series local = *series;
+    for (u32 index = 0; index < count; index++) {
+        values[index] = RandomNextU32(&local);
+    }
+    *series = local;
+}
@@ -420,6 +420,15 @@ typedef struct rlRenderBatch {
     float currentDepth;         // Current depth value for next draw
 } rlRenderBatch;
 
+// NOTE(garden): Running totals of what rlDrawRenderBatch() has sent to the GPU,
+// the profiler diffs them every frame
+typedef struct rlDrawCounters {
+    unsigned int drawCalls;     // glDrawArrays()/glDrawElements() calls
+    unsigned int batchFlushes;  // Batches that had anything in them
+    unsigned int vertices;      // Vertices uploaded
+    unsigned int textureBinds;  // Texture changes between draw calls
+} rlDrawCounters;
+
 // OpenGL version
 typedef enum {
     RL_OPENGL_11 = 1,           // OpenGL 1.1
@@ -723,6 +732,7 @@ RLAPI void rlDrawRenderBatch(rlRenderBatch *batch);     // Draw render batch dat
 RLAPI void rlSetRenderBatchActive(rlRenderBatch *batch); // Set the active render batch for rlgl (NULL for default internal)
 RLAPI void rlDrawRenderBatchActive(void);               // Update and draw internal render batch
 RLAPI bool rlCheckRenderBatchLimit(int vCount);         // Check internal buffer overflow for a given number of vertex
+RLAPI rlDrawCounters rlGetDrawCounters(void);           // NOTE(garden): Get the running draw totals
 
 RLAPI void rlSetTexture(unsigned int id);               // Set current texture for render batch and check buffers limits
 
@@ -1119,6 +1129,8 @@ static double rlCullDistanceFar = RL_CULL_DISTANCE_FAR;
 static rlglData RLGL = { 0 };
 #endif  // GRAPHICS_API_OPENGL_33 || GRAPHICS_API_OPENGL_ES2
 
+static rlDrawCounters rlCounters = { 0 };   // NOTE(garden): See rlGetDrawCounters()
+
 #if defined(GRAPHICS_API_OPENGL_ES2) && !defined(GRAPHICS_API_OPENGL_ES3)
 // NOTE: VAO functionality is exposed through extensions (OES)
 static PFNGLGENVERTEXARRAYSOESPROC glGenVertexArrays = NULL;
@@ -2886,6 +2898,10 @@ void rlDrawRenderBatch(rlRenderBatch *batch)
     // TODO: If no data changed on the CPU arrays --> No need to re-update GPU arrays (use a change detector flag?)
     if (RLGL.State.vertexCounter > 0)
     {
+        // NOTE(garden): Counted for the profiler
+        rlCounters.batchFlushes++;
+        rlCounters.vertices += RLGL.State.vertexCounter;
+
         // Activate elements VAO
         if (RLGL.ExtSupported.vao) glBindVertexArray(batch->vertexBuffer[batch->currentBuffer].vaoId);
 
@@ -3033,6 +3049,10 @@ void rlDrawRenderBatch(rlRenderBatch *batch)
                 // Bind current draw call texture, activated as GL_TEXTURE0 and Bound to sampler2D texture0 by default
                 glBindTexture(GL_TEXTURE_2D, batch->draws[i].textureId);
 
+                // NOTE(garden): Counted for the profiler
+                rlCounters.drawCalls++;
+                if ((i == 0) || (batch->draws[i].textureId != batch->draws[i - 1].textureId)) rlCounters.textureBinds++;
+
                 if ((batch->draws[i].mode == RL_LINES) || (batch->draws[i].mode == RL_TRIANGLES)) glDrawArrays(batch->draws[i].mode, vertexOffset, batch->draws[i].vertexCount);
                 else
                 {
@@ -3112,6 +3132,12 @@ void rlSetRenderBatchActive(rlRenderBatch *batch)
 #endif
 }
 
+// NOTE(garden): Get the running draw totals
+rlDrawCounters rlGetDrawCounters(void)
+{
+    return rlCounters;
+}
+
 // Update and draw internal render batch
 void rlDrawRenderBatchActive(void)
 {
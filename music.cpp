@@ -0,0 +1,191 @@
+
+// NOTE: A stem group plays songs that were written to line up, like the
+// play music and its muted version, as a single stream. Every refill
+// decodes each stem from the same position and mixes them down here, so
+// they can't drift apart and the device only has one stream to mix.
+// Crossfading is just moving the stem gains around, the mix ramps each
+// stem from its old gain to the new one over the refill so it doesn't
+// click.
+//
+// QOA stems stream through the decoder raudio already has, anything else
+// gets decoded up front and plays out of memory.
+
+extern "C" {
+// NOTE: These are in raudio (external/qoaplay.c), raylib just doesn't put
+// them in raylib.h. The stream reads straight out of the data it's given.
+struct qoaplay_desc;
+qoaplay_desc *qoaplay_open_memory(const unsigned char *data, int data_size);
+void          qoaplay_close(qoaplay_desc *qoa_ctx);
+void          qoaplay_rewind(qoaplay_desc *qoa_ctx);
+unsigned int  qoaplay_decode(qoaplay_desc *qoa_ctx, float *sample_data, int num_samples);
+}
+
+// The file header only has the length, the channels and sample rate come
+// from the header of the first frame. Everything is big endian.
+b32 ReadQoaHeader(u8 *data, s32 size, u32 *channels, u32 *sample_rate, u32 *frame_count) {
+    if (size < 16 || data[0] != 'q' || data[1] != 'o' || data[2] != 'a' || data[3] != 'f') return false;
+    *frame_count = ((u32)data[4] << 24) | ((u32)data[5] << 16) | ((u32)data[6] << 8) | (u32)data[7];
+    *channels    = data[8];
+    *sample_rate = ((u32)data[9] << 16) | ((u32)data[10] << 8) | (u32)data[11];
+    return *channels > 0 && *sample_rate > 0 && *frame_count > 0;
+}
+
+// Adds a stem at the given gain. The first one decides the format of the
+// group. The data has to stay alive until the group is unloaded.
+b32 StemGroupAdd(Stem_Group *group, const char *path, u8 *data, s32 size, f32 gain) {
+    ASSERT(group->stem_count < STEM_GROUP_MAX_STEMS);
+    Stem stem        = {};
+    stem.gain        = gain;
+    stem.target_gain = gain;
+
+    u32 channels = 0, sample_rate = 0, frame_count = 0;
+    b32 is_qoa   = data && IsFileExtension(path, ".qoa") &&
+                   ReadQoaHeader(data, size, &channels, &sample_rate, &frame_count);
+    if (is_qoa && group->stem_count > 0 && (channels != group->channels || sample_rate != group->sample_rate)) {
+        // Doesn't match the rest so it has to be converted up front.
+        is_qoa = false;
+    }
+
+    if (is_qoa) {
+        stem.qoa = qoaplay_open_memory(data, size);
+    } else if (data) {
+        stem.wave = LoadWaveFromMemory(GetFileExtension(path), data, size);
+        if (IsWaveReady(stem.wave)) {
+            if (group->stem_count == 0) {
+                group->channels    = stem.wave.channels;
+                group->sample_rate = stem.wave.sampleRate;
+            }
+            WaveFormat(&stem.wave, group->sample_rate, 32, group->channels);
+            channels    = stem.wave.channels;
+            sample_rate = stem.wave.sampleRate;
+            frame_count = stem.wave.frameCount;
+        }
+    }
+    if (!stem.qoa && !IsWaveReady(stem.wave)) {
+        TraceLog(LOG_WARNING, "MUSIC: Can't play %s as a stem", path);
+        return false;
+    }
+
+    if (group->stem_count == 0) {
+        group->channels    = channels;
+        group->sample_rate = sample_rate;
+        group->frame_count = frame_count;
+        group->decoded     = (f32 *)MemAlloc(STEM_GROUP_REFILL_FRAMES*channels*sizeof(f32));
+        group->mixed       = (f32 *)MemAlloc(STEM_GROUP_REFILL_FRAMES*channels*sizeof(f32));
+
+        // NOTE: Refills have to be exactly one sub-buffer or raylib pads them
+        // out with silence, so set the size instead of taking its default.
+        SetAudioStreamBufferSizeDefault(STEM_GROUP_REFILL_FRAMES);
+        group->stream      = LoadAudioStream(sample_rate, 32, channels);
+        SetAudioStreamBufferSizeDefault(0);
+    }
+    if (frame_count < group->frame_count) group->frame_count = frame_count;
+    group->stems[group->stem_count++] = stem;
+    return true;
+}
+
+void StemGroupUnload(Stem_Group *group) {
+    for (u32 index = 0; index < group->stem_count; index++) {
+        Stem *stem = &group->stems[index];
+        if (stem->qoa) qoaplay_close((qoaplay_desc *)stem->qoa);
+        else           UnloadWave(stem->wave);
+    }
+    if (group->stem_count) UnloadAudioStream(group->stream);
+    MemFree(group->decoded);
+    MemFree(group->mixed);
+    *group = {};
+}
+
+void StemGroupSetGain(Stem_Group *group, u32 stem, f32 gain) {
+    group->stems[stem].target_gain = gain;
+}
+
+// Mixes the next refill of every stem into one sub-buffer of the stream.
+void StemGroupRefill(Stem_Group *group) {
+    u32 channels = group->channels;
+    memset(group->mixed, 0, STEM_GROUP_REFILL_FRAMES*channels*sizeof(f32));
+
+    f32 gain_steps[STEM_GROUP_MAX_STEMS];
+    for (u32 index = 0; index < group->stem_count; index++) {
+        Stem *stem        = &group->stems[index];
+        gain_steps[index] = (stem->target_gain - stem->gain) / STEM_GROUP_REFILL_FRAMES;
+    }
+
+    u32 frames_done = 0;
+    while (frames_done < STEM_GROUP_REFILL_FRAMES) {
+        u32 frames = STEM_GROUP_REFILL_FRAMES - frames_done;
+        if (frames > group->frame_count - group->position) frames = group->frame_count - group->position;
+        f32 *out   = group->mixed + frames_done*channels;
+
+        for (u32 index = 0; index < group->stem_count; index++) {
+            Stem      *stem = &group->stems[index];
+            f32        step = gain_steps[index];
+            const f32 *in   = NULL;
+            // NOTE: Silent stems still have to be decoded to stay in step,
+            // they just don't need mixing.
+            if (stem->qoa) {
+                qoaplay_decode((qoaplay_desc *)stem->qoa, group->decoded, (s32)frames);
+                in = group->decoded;
+            } else {
+                in = (f32 *)stem->wave.data + group->position*channels;
+            }
+            if (stem->gain == 0.0f && step == 0.0f) continue;
+
+            // The gain comes from the start of the ramp every frame rather
+            // than being stepped, so a crossfade doesn't pick up rounding.
+            for (u32 frame = 0; frame < frames; frame++) {
+                f32 gain = stem->gain + step*(f32)(frames_done + frame);
+                for (u32 channel = 0; channel < channels; channel++) {
+                    out[frame*channels + channel] += gain*in[frame*channels + channel];
+                }
+            }
+        }
+
+        frames_done     += frames;
+        group->position += frames;
+        if (group->position >= group->frame_count) {
+            group->position = 0;
+            for (u32 index = 0; index < group->stem_count; index++) {
+                if (group->stems[index].qoa) qoaplay_rewind((qoaplay_desc *)group->stems[index].qoa);
+            }
+        }
+    }
+
+    // Every ramp ends on its target.
+    for (u32 index = 0; index < group->stem_count; index++) {
+        group->stems[index].gain = group->stems[index].target_gain;
+    }
+    UpdateAudioStream(group->stream, group->mixed, STEM_GROUP_REFILL_FRAMES);
+}
+
+// The per frame pump, the stem group equivalent of UpdateMusicStream().
+void StemGroupUpdate(Stem_Group *group) {
+    if (!group->stem_count) return;
+    while (IsAudioStreamProcessed(group->stream)) {
+        StemGroupRefill(group);
+    }
+}
+
+// Starts every stem over from the top. Both sub-buffers get filled before
+// it starts so the first one isn't silent.
+void StemGroupPlay(Stem_Group *group) {
+    if (!group->stem_count) return;
+    group->position = 0;
+    for (u32 index = 0; index < group->stem_count; index++) {
+        Stem *stem = &group->stems[index];
+        stem->gain = stem->target_gain;
+        if (stem->qoa) qoaplay_rewind((qoaplay_desc *)stem->qoa);
+    }
+    StopAudioStream(group->stream);
+    StemGroupUpdate(group);
+    PlayAudioStream(group->stream);
+}
+
+void StemGroupStop(Stem_Group *group) {
+    if (group->stem_count) StopAudioStream(group->stream);
+}
+
+b32 StemGroupIsPlaying(Stem_Group *group) {
+    b32 result = group->stem_count && IsAudioStreamPlaying(group->stream);
+    return result;
+}
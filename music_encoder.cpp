@@ -0,0 +1,55 @@
+// NOTE: Offline music encoder. The songs are authored as WAV but they get
+// shipped as QOA, which is about a fifth of the size and is cheap enough to
+// decode that streaming it costs next to nothing over streaming raw PCM.
+// raylib already knows how to write and stream it so this just loads each
+// master and exports it again. See build_music.bat for the songs it runs on.
+//
+// Usage: music_encoder in.wav out.qoa [in.wav out.qoa ...]
+
+#include <stdio.h>
+#include "raylib.h"
+#include "types.h"
+
+s64 FileSize(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return 0;
+    fseek(file, 0, SEEK_END);
+    s64 result = (s64)ftell(file);
+    fclose(file);
+    return result;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 3 || (argc - 1) % 2 != 0) {
+        fprintf(stderr, "usage: music_encoder in.wav out.qoa [in.wav out.qoa ...]\n");
+        return 1;
+    }
+    SetTraceLogLevel(LOG_WARNING);
+
+    s32 result = 0;
+    for (s32 index = 1; index + 1 < argc; index += 2) {
+        const char *in_path  = argv[index];
+        const char *out_path = argv[index + 1];
+
+        Wave wave = LoadWave(in_path);
+        if (!IsWaveReady(wave)) {
+            // NOTE: Not fatal, the game just keeps whatever it had before.
+            fprintf(stderr, "warning: skipping %s, can't decode it\n", in_path);
+            continue;
+        }
+        // QOA only takes 16 bit samples.
+        if (wave.sampleSize != 16) WaveFormat(&wave, wave.sampleRate, 16, wave.channels);
+
+        if (ExportWave(wave, out_path)) {
+            s64 in_size  = FileSize(in_path);
+            s64 out_size = FileSize(out_path);
+            printf("%s: %.1f MB -> %.1f MB (%.1fx)\n", out_path, in_size / (1024.0*1024.0),
+                   out_size / (1024.0*1024.0), out_size ? (f64)in_size / out_size : 0.0);
+        } else {
+            fprintf(stderr, "error: can't write %s\n", out_path);
+            result = 1;
+        }
+        UnloadWave(wave);
+    }
+    return result;
+}
@@ -0,0 +1,246 @@
+// NOTE: Offline asset pack builder. Reads assets/pack_manifest.txt and bakes
+// each group listed in it into its own garden_<group>.pak in the folder it's
+// run from, along with the garden_packs.txt index of them. See asset_pack.h
+// for the layout and build_pack.bat for how to run it.
+// Run build_atlas.bat and build_music.bat first so the pack gets the current
+// atlas and songs.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "types.h"
+#include "asset_pack.h"
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#include "stb_image.h"
+#define DR_WAV_IMPLEMENTATION
+#include "dr_wav.h"
+
+#define PACK_MANIFEST_PATH "../assets/pack_manifest.txt"
+#define PACK_MAX_ENTRIES   256
+#define PACK_MAX_GROUPS    8
+
+struct Pack_Blob {
+    void *data;
+    u64   size;
+    b32   from_stb;
+    u32   group;
+};
+
+static Asset_Pack_Entry g_entries[PACK_MAX_ENTRIES];
+static Pack_Blob        g_blobs[PACK_MAX_ENTRIES];
+static u32              g_entry_count;
+static char             g_groups[PACK_MAX_GROUPS][ASSET_PACK_GROUP_MAX];
+static u32              g_group_count;
+
+void *ReadWholeFile(const char *path, u64 *size) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    *size = (u64)ftell(file);
+    fseek(file, 0, SEEK_SET);
+    void *result = malloc(*size ? *size : 1);
+    if (fread(result, 1, *size, file) != *size) {
+        free(result);
+        result = NULL;
+    }
+    fclose(file);
+    return result;
+}
+
+b32 BakeEntry(Asset_Pack_Entry *entry, Pack_Blob *blob, const char *kind, const char *path) {
+    *entry = {};
+    *blob  = {};
+    if (strlen(path) >= ASSET_PACK_PATH_MAX) {
+        fprintf(stderr, "warning: skipping %s, the path is too long\n", path);
+        return false;
+    }
+    snprintf(entry->path, ASSET_PACK_PATH_MAX, "%s", path);
+    entry->hash = HashString(path);
+
+    if (strcmp(kind, "image") == 0) {
+        s32 width, height, channels;
+        u8 *pixels = stbi_load(path, &width, &height, &channels, 4);
+        if (!pixels) {
+            fprintf(stderr, "warning: skipping %s (%s)\n", path, stbi_failure_reason());
+            return false;
+        }
+        entry->kind     = AssetKind_image;
+        entry->width    = (u32)width;
+        entry->height   = (u32)height;
+        blob->data      = pixels;
+        blob->size      = (u64)width*height*4;
+        blob->from_stb  = true;
+    } else if (strcmp(kind, "wave") == 0) {
+        // NOTE: Everything gets converted to 16 bit since that's what the
+        // sound effects mostly are already and it halves the size over f32.
+        u32 channels, sample_rate;
+        drwav_uint64 frame_count;
+        s16 *samples = drwav_open_file_and_read_pcm_frames_s16(path, &channels, &sample_rate,
+                                                                &frame_count, NULL);
+        if (!samples) {
+            fprintf(stderr, "warning: skipping %s, can't decode it\n", path);
+            return false;
+        }
+        entry->kind        = AssetKind_wave;
+        entry->frame_count = (u32)frame_count;
+        entry->sample_rate = sample_rate;
+        entry->sample_size = 16;
+        entry->channels    = channels;
+        blob->data         = samples;
+        blob->size         = (u64)frame_count*channels*sizeof(s16);
+    } else if (strcmp(kind, "file") == 0) {
+        blob->data  = ReadWholeFile(path, &blob->size);
+        if (!blob->data) {
+            fprintf(stderr, "warning: skipping %s, can't read it\n", path);
+            return false;
+        }
+        entry->kind = AssetKind_file;
+    } else {
+        fprintf(stderr, "warning: skipping %s, don't know what a '%s' is\n", path, kind);
+        return false;
+    }
+
+    entry->size = blob->size;
+    return true;
+}
+
+// Each line is the kind of asset followed by its path, "image ../assets/x.png".
+// A "group <name>" line puts everything after it in that group, anything
+// before the first one goes in "main".
+b32 LoadManifest(const char *manifest_path) {
+    FILE *file = fopen(manifest_path, "r");
+    if (!file) {
+        fprintf(stderr, "error: can't open %s\n", manifest_path);
+        return false;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), file)) {
+        char kind[16], path[256];
+        if (line[0] == '#' || sscanf(line, "%15s %255s", kind, path) != 2) continue;
+
+        if (strcmp(kind, "group") == 0) {
+            if (strlen(path) >= ASSET_PACK_GROUP_MAX || g_group_count == PACK_MAX_GROUPS) {
+                fprintf(stderr, "error: can't have a group called %s\n", path);
+                fclose(file);
+                return false;
+            }
+            snprintf(g_groups[g_group_count++], ASSET_PACK_GROUP_MAX, "%s", path);
+            continue;
+        }
+        if (g_group_count == 0) {
+            snprintf(g_groups[g_group_count++], ASSET_PACK_GROUP_MAX, "main");
+        }
+
+        if (g_entry_count == PACK_MAX_ENTRIES) {
+            fprintf(stderr, "error: more than %d assets in the manifest\n", PACK_MAX_ENTRIES);
+            fclose(file);
+            return false;
+        }
+        if (BakeEntry(&g_entries[g_entry_count], &g_blobs[g_entry_count], kind, path)) {
+            g_blobs[g_entry_count].group = g_group_count - 1;
+            g_entry_count++;
+        }
+    }
+
+    fclose(file);
+    return true;
+}
+
+u64 AlignPackOffset(u64 offset) {
+    u64 result = (offset + ASSET_PACK_ALIGN - 1) & ~(u64)(ASSET_PACK_ALIGN - 1);
+    return result;
+}
+
+// Writes every entry in the group out as one pack and hands back its size
+// and content hash for the index.
+b32 WritePack(u32 group, const char *pack_path, u64 *pack_size, u32 *content_hash) {
+    static Asset_Pack_Entry entries[PACK_MAX_ENTRIES];
+    static Pack_Blob        blobs[PACK_MAX_ENTRIES];
+    u32 entry_count = 0;
+    for (u32 index = 0; index < g_entry_count; index++) {
+        if (g_blobs[index].group != group) continue;
+        entries[entry_count] = g_entries[index];
+        blobs[entry_count]   = g_blobs[index];
+        entry_count++;
+    }
+
+    Asset_Pack_Header header = {};
+    header.magic             = ASSET_PACK_MAGIC;
+    header.version           = ASSET_PACK_VERSION;
+    header.entry_count       = entry_count;
+    header.entries_offset    = AlignPackOffset(sizeof(header));
+    header.data_offset       = AlignPackOffset(header.entries_offset + entry_count*sizeof(Asset_Pack_Entry));
+
+    u64 offset = header.data_offset;
+    for (u32 index = 0; index < entry_count; index++) {
+        entries[index].offset = offset;
+        offset = AlignPackOffset(offset + entries[index].size);
+    }
+
+    u32 hash = HashBytes(entries, entry_count*sizeof(Asset_Pack_Entry));
+    for (u32 index = 0; index < entry_count; index++) {
+        hash = HashBytes(blobs[index].data, blobs[index].size, hash);
+    }
+    header.content_hash = hash;
+
+    FILE *file = fopen(pack_path, "wb");
+    if (!file) {
+        fprintf(stderr, "error: can't write %s\n", pack_path);
+        return false;
+    }
+
+    static const u8 zeroes[ASSET_PACK_ALIGN] = {};
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(zeroes, 1, header.entries_offset - sizeof(header), file);
+    fwrite(entries, sizeof(Asset_Pack_Entry), entry_count, file);
+    fwrite(zeroes, 1, header.data_offset - (header.entries_offset + entry_count*sizeof(Asset_Pack_Entry)), file);
+    for (u32 index = 0; index < entry_count; index++) {
+        Asset_Pack_Entry *entry = &entries[index];
+        fwrite(blobs[index].data, 1, blobs[index].size, file);
+        fwrite(zeroes, 1, AlignPackOffset(entry->offset + entry->size) - (entry->offset + entry->size), file);
+    }
+    fclose(file);
+
+    *pack_size    = offset;
+    *content_hash = hash;
+    printf("packed %u assets into %s (%.1f MB)\n", entry_count, pack_path, offset / (1024.0*1024.0));
+    return true;
+}
+
+int main() {
+    if (!LoadManifest(PACK_MANIFEST_PATH)) return 1;
+
+    FILE *index_file = fopen(ASSET_PACK_INDEX_PATH, "w");
+    if (!index_file) {
+        fprintf(stderr, "error: can't write %s\n", ASSET_PACK_INDEX_PATH);
+        return 1;
+    }
+    fprintf(index_file, "# Generated by pack_builder.cpp from assets/pack_manifest.txt, see asset_pack.h\n");
+
+    s32 result = 0;
+    for (u32 group = 0; group < g_group_count; group++) {
+        char pack_path[ASSET_PACK_PATH_MAX];
+        snprintf(pack_path, sizeof(pack_path), "garden_%s.pak", g_groups[group]);
+
+        u64 pack_size    = 0;
+        u32 content_hash = 0;
+        if (!WritePack(group, pack_path, &pack_size, &content_hash)) {
+            result = 1;
+            break;
+        }
+        fprintf(index_file, "pack %s %s %08x %llu\n", g_groups[group], pack_path, content_hash,
+                (unsigned long long)pack_size);
+    }
+    fclose(index_file);
+
+    for (u32 index = 0; index < g_entry_count; index++) {
+        Pack_Blob *blob = &g_blobs[index];
+        if (blob->from_stb) stbi_image_free(blob->data);
+        else if (g_entries[index].kind == AssetKind_wave) drwav_free(blob->data, NULL);
+        else free(blob->data);
+    }
+    return result;
+}
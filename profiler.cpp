@@ -0,0 +1,278 @@
+
+// NOTE: A frame profiler. Zones are named spans of CPU time inside a frame,
+// either PROFILE_ZONE("name") for the rest of a scope or a begin/end pair
+// around code that doesn't have one. Each frame's zones and counters go
+// into a ring of the last PROFILER_FRAME_COUNT frames, which the overlay
+// graphs and ProfilerExportTrace() writes out as a Chrome trace (load it in
+// chrome://tracing or ui.perfetto.dev).
+//
+// Zone names have to be string literals, only the pointer gets kept. Zones
+// outside ProfilerBeginFrame()/ProfilerEndFrame() don't get recorded, so
+// the bench can pull in sim.cpp without paying for any of this.
+
+#include <stdarg.h>
+#include <chrono>
+
+#if defined(_WIN32)
+// NOTE: Same deal as asset_pack.cpp, windows.h and raylib don't mix.
+extern "C" {
+struct Profiler_Memory_Counters {
+    unsigned long cb;
+    unsigned long page_fault_count;
+    size_t        peak_working_set_size;
+    size_t        working_set_size;
+    size_t        quota_peak_paged_pool_usage;
+    size_t        quota_paged_pool_usage;
+    size_t        quota_peak_non_paged_pool_usage;
+    size_t        quota_non_paged_pool_usage;
+    size_t        pagefile_usage;
+    size_t        peak_pagefile_usage;
+};
+__declspec(dllimport) void *__stdcall GetCurrentProcess(void);
+__declspec(dllimport) int   __stdcall K32GetProcessMemoryInfo(void *, Profiler_Memory_Counters *, unsigned long);
+}
+#else
+#include <unistd.h>
+#endif
+
+static Profiler g_profiler;
+
+f64 ProfilerNow() {
+    using namespace std::chrono;
+    f64 result = duration<f64>(steady_clock::now().time_since_epoch()).count();
+    return result;
+}
+
+void ProfilerBeginFrame(Profiler *profiler) {
+    Profile_Frame *frame = &profiler->frames[profiler->frame_index];
+    frame->start         = ProfilerNow();
+    frame->zone_count    = 0;
+    profiler->depth      = 0;
+    profiler->recording  = true;
+}
+
+void ProfilerEndFrame(Profiler *profiler, Profile_Counters *counters) {
+    Profile_Frame *frame  = &profiler->frames[profiler->frame_index];
+    frame->duration       = ProfilerNow() - frame->start;
+    frame->counters       = *counters;
+    profiler->recording   = false;
+    profiler->frame_index = (profiler->frame_index + 1) % PROFILER_FRAME_COUNT;
+    if (profiler->frame_count < PROFILER_FRAME_COUNT) profiler->frame_count++;
+}
+
+// How much of the process is actually in physical memory right now. The web
+// build has no /proc so it always gets 0.
+u64 ProfilerResidentBytes() {
+    u64 result = 0;
+#if defined(_WIN32)
+    Profiler_Memory_Counters counters = {};
+    counters.cb                       = sizeof(counters);
+    if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        result = counters.working_set_size;
+    }
+#else
+    FILE *file = fopen("/proc/self/statm", "r");
+    if (file) {
+        unsigned long total_pages = 0, resident_pages = 0;
+        if (fscanf(file, "%lu %lu", &total_pages, &resident_pages) == 2) {
+            result = (u64)resident_pages*(u64)sysconf(_SC_PAGESIZE);
+        }
+        fclose(file);
+    }
+#endif
+    return result;
+}
+
+// Returns the zone to hand to ProfilerEndZone(), or PROFILER_MAX_ZONES when
+// it isn't being recorded.
+u32 ProfilerBeginZone(Profiler *profiler, const char *name) {
+    Profile_Frame *frame = &profiler->frames[profiler->frame_index];
+    if (!profiler->recording || frame->zone_count == PROFILER_MAX_ZONES) return PROFILER_MAX_ZONES;
+
+    u32           index = frame->zone_count++;
+    Profile_Zone *zone  = &frame->zones[index];
+    zone->name          = name;
+    zone->depth         = profiler->depth++;
+    zone->duration      = 0;
+    zone->start         = ProfilerNow() - frame->start;
+    return index;
+}
+
+void ProfilerEndZone(Profiler *profiler, u32 index) {
+    if (index == PROFILER_MAX_ZONES) return;
+    Profile_Frame *frame = &profiler->frames[profiler->frame_index];
+    Profile_Zone  *zone  = &frame->zones[index];
+    zone->duration       = (ProfilerNow() - frame->start) - zone->start;
+    profiler->depth--;
+}
+
+// NOTE: Only here so PROFILE_ZONE() can end the zone when the scope does.
+struct Profile_Scope {
+    u32 zone;
+    Profile_Scope(const char *name) { zone = ProfilerBeginZone(&g_profiler, name); }
+    ~Profile_Scope()                { ProfilerEndZone(&g_profiler, zone); }
+};
+
+#define PROFILE_JOIN_(a, b) a##b
+#define PROFILE_JOIN(a, b)  PROFILE_JOIN_(a, b)
+#define PROFILE_ZONE(name)  Profile_Scope PROFILE_JOIN(profile_scope_, __LINE__)(name)
+
+// Oldest first, index 0 is the oldest finished frame still in the ring.
+Profile_Frame *ProfilerFrame(Profiler *profiler, u32 index) {
+    u32 first = (profiler->frame_index + PROFILER_FRAME_COUNT - profiler->frame_count) % PROFILER_FRAME_COUNT;
+    return &profiler->frames[(first + index) % PROFILER_FRAME_COUNT];
+}
+
+// The same zone always gets the same colour in the graph and the list.
+Color ProfilerZoneColor(const char *name) {
+    static const Color palette[] = {
+        {230,  90,  80, 255}, { 90, 180, 230, 255}, {240, 190,  60, 255}, {120, 200, 110, 255},
+        {190, 120, 220, 255}, {240, 140,  60, 255}, { 80, 200, 190, 255}, {220, 110, 160, 255},
+    };
+    Color result = palette[HashString(name) % ARRAY_COUNT(palette)];
+    return result;
+}
+
+// Each bar is a frame with its top level zones stacked up from the bottom,
+// the gray on top is the time no zone covers. The line is 60 fps.
+void ProfilerDrawOverlay(Profiler *profiler, s32 x, s32 y) {
+    if (!profiler->show_overlay || profiler->frame_count == 0) return;
+
+    const s32 bar_width    = 2;
+    const s32 graph_height = 120;
+    const f64 graph_time   = 1.0 / 30.0;
+    const s32 font_size    = 10;
+    s32       width        = PROFILER_FRAME_COUNT*bar_width;
+    DrawRectangle(x - 4, y - 4, width + 8, graph_height + 8 + 22*font_size, Fade(BLACK, 0.75f));
+
+    for (u32 index = 0; index < profiler->frame_count; index++) {
+        Profile_Frame *frame  = ProfilerFrame(profiler, index);
+        s32            bar_x  = x + (s32)index*bar_width;
+        s32            bottom = y + graph_height;
+        f64            height = CLAMP(frame->duration / graph_time, 0.0, 1.0)*graph_height;
+        DrawRectangle(bar_x, bottom - (s32)height, bar_width, (s32)height, DARKGRAY);
+
+        f64 stacked = 0;
+        for (u32 zone_index = 0; zone_index < frame->zone_count; zone_index++) {
+            Profile_Zone *zone = &frame->zones[zone_index];
+            if (zone->depth != 0) continue;
+            f64 zone_height = zone->duration / graph_time*graph_height;
+            if (stacked + zone_height > graph_height) zone_height = graph_height - stacked;
+            DrawRectangle(bar_x, bottom - (s32)(stacked + zone_height), bar_width, (s32)zone_height,
+                          ProfilerZoneColor(zone->name));
+            stacked += zone_height;
+        }
+    }
+    s32 target_y = y + graph_height - (s32)((1.0 / 60.0) / graph_time*graph_height);
+    DrawLine(x, target_y, x + width, target_y, WHITE);
+
+    // The list is the last finished frame, next to each zone is how long
+    // a frame spends in zones of that name on average over the whole ring.
+    Profile_Frame *last  = ProfilerFrame(profiler, profiler->frame_count - 1);
+    f64            total = 0;
+    for (u32 index = 0; index < profiler->frame_count; index++) {
+        total += ProfilerFrame(profiler, index)->duration;
+    }
+    s32 text_y = y + graph_height + 8;
+    DrawText(TextFormat("frame %6.2f ms   avg %6.2f ms", last->duration*1000.0, total / profiler->frame_count*1000.0),
+             x, text_y, font_size, WHITE);
+    text_y += font_size + 2;
+
+    for (u32 zone_index = 0; zone_index < last->zone_count && zone_index < 12; zone_index++) {
+        Profile_Zone *zone     = &last->zones[zone_index];
+        f64           zone_sum = 0;
+        for (u32 index = 0; index < profiler->frame_count; index++) {
+            Profile_Frame *frame = ProfilerFrame(profiler, index);
+            for (u32 other = 0; other < frame->zone_count; other++) {
+                if (frame->zones[other].name == zone->name) zone_sum += frame->zones[other].duration;
+            }
+        }
+        s32 indent = x + 12 + (s32)zone->depth*10;
+        DrawRectangle(x, text_y + 2, 6, 6, ProfilerZoneColor(zone->name));
+        DrawText(zone->name, indent, text_y, font_size, WHITE);
+        DrawText(TextFormat("%6.2f ms   avg %6.2f ms", zone->duration*1000.0, zone_sum / profiler->frame_count*1000.0),
+                 x + 160, text_y, font_size, LIGHTGRAY);
+        text_y += font_size + 2;
+    }
+
+    Profile_Counters *counters = &last->counters;
+    text_y += 4;
+    DrawText(TextFormat("gpu    %u draws  %u flushes  %u verts  %u binds", counters->draw_calls,
+                        counters->batch_flushes, counters->vertices, counters->texture_binds),
+             x, text_y, font_size, WHITE);
+    text_y += font_size + 2;
+    DrawText(TextFormat("queue  %u draws  %u flushes  %u shader switches  %u tiles", counters->queue_draws,
+                        counters->queue_flushes, counters->shader_switches, counters->tiles_drawn),
+             x, text_y, font_size, WHITE);
+    text_y += font_size + 2;
+    DrawText(TextFormat("pools  %u enemies  %u powerups", counters->enemies, counters->powerups),
+             x, text_y, font_size, WHITE);
+}
+
+struct Trace_Buffer {
+    char *data;
+    u32   size;
+    u32   capacity;
+};
+
+void TraceAppend(Trace_Buffer *buffer, const char *format, ...) {
+    for (;;) {
+        va_list args;
+        va_start(args, format);
+        s32 length = vsnprintf(buffer->data + buffer->size, buffer->capacity - buffer->size, format, args);
+        va_end(args);
+        if (length < 0) return;
+        if (buffer->size + (u32)length < buffer->capacity) {
+            buffer->size += (u32)length;
+            return;
+        }
+        buffer->capacity = buffer->capacity ? buffer->capacity*2 : 64*1024;
+        buffer->data     = (char *)realloc(buffer->data, buffer->capacity);
+    }
+}
+
+// Writes every frame in the ring out in the Chrome trace event format: a
+// complete event per zone on one thread, timestamps in microseconds from
+// the oldest frame, and the counters as counter events. The web build
+// hands it to the browser as a download instead.
+void ProfilerExportTrace(Profiler *profiler, const char *path) {
+    if (profiler->frame_count == 0) return;
+
+    Trace_Buffer buffer = {};
+    f64          base   = ProfilerFrame(profiler, 0)->start;
+    TraceAppend(&buffer, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    TraceAppend(&buffer, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"main\"}}");
+    for (u32 index = 0; index < profiler->frame_count; index++) {
+        Profile_Frame *frame = ProfilerFrame(profiler, index);
+        f64            start = (frame->start - base)*1e6;
+        TraceAppend(&buffer, ",\n{\"name\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                    start, frame->duration*1e6);
+        for (u32 zone_index = 0; zone_index < frame->zone_count; zone_index++) {
+            Profile_Zone *zone = &frame->zones[zone_index];
+            TraceAppend(&buffer, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}",
+                        zone->name, start + zone->start*1e6, zone->duration*1e6);
+        }
+
+        Profile_Counters *counters = &frame->counters;
+        TraceAppend(&buffer, ",\n{\"name\":\"gpu\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":"
+                    "{\"draw_calls\":%u,\"batch_flushes\":%u,\"vertices\":%u,\"texture_binds\":%u}}",
+                    start, counters->draw_calls, counters->batch_flushes, counters->vertices, counters->texture_binds);
+        TraceAppend(&buffer, ",\n{\"name\":\"render queue\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":"
+                    "{\"draws\":%u,\"flushes\":%u,\"shader_switches\":%u,\"tiles_drawn\":%u}}",
+                    start, counters->queue_draws, counters->queue_flushes, counters->shader_switches,
+                    counters->tiles_drawn);
+        TraceAppend(&buffer, ",\n{\"name\":\"pools\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":"
+                    "{\"enemies\":%u,\"powerups\":%u}}",
+                    start, counters->enemies, counters->powerups);
+    }
+    TraceAppend(&buffer, "\n]}\n");
+
+#if defined(PLATFORM_WEB)
+    WebDownloadFile(path, buffer.data, buffer.size);
+#else
+    if (SaveFileData(path, buffer.data, (s32)buffer.size)) {
+        TraceLog(LOG_INFO, "PROFILER: Wrote %u frames to %s", profiler->frame_count, path);
+    }
+#endif
+    free(buffer.data);
+}
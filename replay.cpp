@@ -0,0 +1,222 @@
+
+// NOTE: Records everything that feeds the game from outside, so a session
+// can be played back exactly: the random seed, and then for every frame its
+// frame time and the input GatherInputFrame() picked up. GameInit() seeds
+// every Random_Series from the one seed and from then on the game only
+// depends on what's in here. The drawing only pulls from its own series, so
+// it could be skipped, but fast playback still draws into a hidden window
+// so the frame times it reports are real ones.
+//
+// Each frame is one varint of the change in frame time in microseconds,
+// zigzagged and shifted up one, with the bottom bit set if there was input.
+// Input is a byte with the direction count in the bottom five bits and
+// space in the next one, then the directions packed two bits each. A steady
+// frame with nothing pressed is one byte. Every check_interval frames
+// there's also a checksum of the game state, so playback can tell where it
+// stopped matching the recording.
+
+void ReplayPutVarint(FILE *file, u32 value) {
+    while (value >= 0x80) {
+        fputc((s32)((value & 0x7F) | 0x80), file);
+        value >>= 7;
+    }
+    fputc((s32)value, file);
+}
+
+b32 ReplayGetVarint(Replay *replay, u32 *value) {
+    u32 result = 0;
+    for (u32 shift = 0; shift < 35; shift += 7) {
+        if (replay->cursor >= replay->size) return false;
+        u8 byte = replay->data[replay->cursor++];
+        result |= (u32)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+b32 ReplayGetBytes(Replay *replay, void *bytes, u32 size) {
+    if (replay->size - replay->cursor < size) return false;
+    memcpy(bytes, replay->data + replay->cursor, size);
+    replay->cursor += size;
+    return true;
+}
+
+// Everything the sim decides, the screen the game is on, and the tiles
+// that are on fire or have an enemy on them.
+u32 ReplayStateHash(Game_Sim *sim) {
+    Tile_Planes *planes = &sim->map->planes;
+    u32          words  = planes->layout.word_count;
+    u32          hash   = HashBytes(&sim->manager->state, sizeof(sim->manager->state));
+    hash = HashBytes(&sim->manager->score, sizeof(sim->manager->score), hash);
+    hash = HashBytes(&sim->player->pos, sizeof(sim->player->pos), hash);
+    hash = HashBytes(&sim->time, sizeof(sim->time), hash);
+    hash = HashBytes(planes->flags[TilePlane_fire],  words*sizeof(u64), hash);
+    hash = HashBytes(planes->flags[TilePlane_enemy], words*sizeof(u64), hash);
+    return hash;
+}
+
+b32 ReplayOpenRecording(Replay *replay, const char *path) {
+    *replay      = {};
+    replay->file = fopen(path, "wb");
+    if (!replay->file) {
+        TraceLog(LOG_WARNING, "REPLAY: Can't write %s", path);
+        return false;
+    }
+    replay->mode = ReplayMode_record;
+    return true;
+}
+
+// The map size comes out of the header, the caller has to use it.
+b32 ReplayOpenPlayback(Replay *replay, const char *path, b32 fast) {
+    *replay    = {};
+    s32 size   = 0;
+    u8 *data   = LoadFileData(path, &size);
+    if (!data) return false;
+
+    replay->data = data;
+    replay->size = (u32)size;
+    if (!ReplayGetBytes(replay, &replay->header, sizeof(replay->header)) ||
+        replay->header.magic != REPLAY_MAGIC || replay->header.version != REPLAY_VERSION) {
+        TraceLog(LOG_WARNING, "REPLAY: %s isn't a replay this build can play", path);
+        UnloadFileData(data);
+        *replay = {};
+        return false;
+    }
+    replay->mode = fast ? ReplayMode_play_fast : ReplayMode_play;
+    return true;
+}
+
+// Call right before GameInit() and hand it the seed this returns. Recording
+// writes the seed it's given into the header, playing back swaps in the one
+// from the header.
+u32 ReplayStart(Replay *replay, u32 seed, u32 map_width, u32 map_height) {
+    if (replay->mode == ReplayMode_off) return seed;
+
+    if (replay->mode == ReplayMode_record) {
+        Replay_Header *header  = &replay->header;
+        header->magic          = REPLAY_MAGIC;
+        header->version        = REPLAY_VERSION;
+        header->seed           = seed;
+        header->map_width      = map_width;
+        header->map_height     = map_height;
+        header->check_interval = REPLAY_CHECK_INTERVAL;
+        header->start_time     = GetTime();
+        fwrite(header, sizeof(*header), 1, replay->file);
+    }
+    replay->started          = ProfilerNow();
+    replay->last_frame_start = replay->started;
+    return replay->header.seed;
+}
+
+void ReplayFinish(Replay *replay) {
+    f64 elapsed = ProfilerNow() - replay->started;
+    if (replay->diverged) {
+        TraceLog(LOG_WARNING, "REPLAY: Stopped matching the recording around frame %u", replay->diverged_frame);
+    } else {
+        TraceLog(LOG_INFO, "REPLAY: Matched the recording for the %u frames played", replay->frame_index);
+    }
+    if (replay->mode == ReplayMode_play_fast && replay->frame_index) {
+        TraceLog(LOG_INFO, "REPLAY: %u frames in %.2f s, %.3f ms a frame, the slowest was frame %u at %.3f ms",
+                 replay->frame_index, elapsed, elapsed / replay->frame_index*1000.0,
+                 replay->worst_frame, replay->worst_frame_time*1000.0);
+        replay->quit = true;
+    }
+    replay->mode = ReplayMode_off;
+}
+
+// Call once a frame where the input has been gathered. Recording writes the
+// frame out, playing back swaps in the recorded one. Either way the frame
+// time gets rounded to what the file can hold and the time comes from the
+// frame times, so the recording and the playback see exactly the same.
+void ReplayFrame(Replay *replay, Game_Sim *sim, Input_Frame *input, f32 *delta_t, f32 *current_time) {
+    if (replay->mode == ReplayMode_off) return;
+
+    u32 frame  = replay->frame_index;
+    b32 check  = frame % replay->header.check_interval == 0;
+    f64 now    = ProfilerNow();
+    if (frame > 0 && now - replay->last_frame_start > replay->worst_frame_time) {
+        replay->worst_frame_time = now - replay->last_frame_start;
+        replay->worst_frame      = frame - 1;
+    }
+    replay->last_frame_start = now;
+
+    u32 frame_us = 0;
+    if (replay->mode == ReplayMode_record) {
+        frame_us  = (u32)(*delta_t*1e6f + 0.5f);
+        s32 delta = (s32)(frame_us - replay->last_frame_us);
+        u32 value = ((u32)(delta << 1) ^ (u32)(delta >> 31)) << 1;
+        b32 any   = input->direction_count || input->space_pressed;
+        ReplayPutVarint(replay->file, value | (any ? 1 : 0));
+        if (any) {
+            fputc((s32)(input->direction_count | (input->space_pressed ? 0x20 : 0)), replay->file);
+            for (u32 index = 0; index < input->direction_count; index += 4) {
+                u32 packed = 0;
+                for (u32 slot = 0; slot < 4 && index + slot < input->direction_count; slot++) {
+                    packed |= (u32)input->directions[index + slot] << (slot*2);
+                }
+                fputc((s32)packed, replay->file);
+            }
+        }
+        if (check) {
+            u32 hash = ReplayStateHash(sim);
+            fwrite(&hash, sizeof(hash), 1, replay->file);
+            fflush(replay->file);
+        }
+    } else {
+        u32 value = 0;
+        if (!ReplayGetVarint(replay, &value)) {
+            ReplayFinish(replay);
+            return;
+        }
+        u32 zigzag = value >> 1;
+        s32 delta  = (s32)(zigzag >> 1) ^ -(s32)(zigzag & 1);
+        frame_us   = (u32)((s32)replay->last_frame_us + delta);
+
+        *input     = {};
+        if (value & 1) {
+            u8 bits = 0;
+            ReplayGetBytes(replay, &bits, 1);
+            input->direction_count = CLAMP(bits & 0x1F, 0, INPUT_FRAME_MAX);
+            input->space_pressed   = (bits & 0x20) != 0;
+            for (u32 index = 0; index < input->direction_count; index += 4) {
+                u8 packed = 0;
+                ReplayGetBytes(replay, &packed, 1);
+                for (u32 slot = 0; slot < 4 && index + slot < input->direction_count; slot++) {
+                    input->directions[index + slot] = (Direction_Facing)((packed >> (slot*2)) & 3);
+                }
+            }
+        }
+        if (check) {
+            u32 hash = 0;
+            ReplayGetBytes(replay, &hash, sizeof(hash));
+            if (!replay->diverged && hash != ReplayStateHash(sim)) {
+                replay->diverged       = true;
+                replay->diverged_frame = frame;
+            }
+        }
+
+        // NOTE: The profiler only keeps the last PROFILER_FRAME_COUNT frames,
+        // so the trace gets written once the frame asked for is in the middle.
+        if (replay->trace_wanted && !replay->trace_written && frame == replay->trace_frame + PROFILER_FRAME_COUNT / 2) {
+            ProfilerExportTrace(&g_profiler, PROFILER_TRACE_PATH);
+            replay->trace_written = true;
+        }
+    }
+
+    replay->last_frame_us = frame_us;
+    replay->time         += frame_us / 1e6;
+    replay->frame_index++;
+    *delta_t              = frame_us / 1e6f;
+    *current_time         = (f32)(replay->header.start_time + replay->time);
+}
+
+void ReplayClose(Replay *replay) {
+    if (replay->mode == ReplayMode_play || replay->mode == ReplayMode_play_fast) ReplayFinish(replay);
+    if (replay->file) fclose(replay->file);
+    if (replay->data) UnloadFileData(replay->data);
+    replay->file = NULL;
+    replay->data = NULL;
+}
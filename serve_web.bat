@@ -0,0 +1,18 @@
+@echo off
+
+:: NOTE: Serves dist\ the way the real host would, a plain static file
+:: server, so the pack fetching can be tried locally. Run build_pack.bat
+:: and build_web.bat first, then open http://localhost:8080/index.html
+::
+:: The packs get cached in IndexedDB after the first visit, so a reload
+:: only fetches garden_packs.txt. Rebuilding the packs changes their hashes
+:: in it and the next reload fetches just the ones that changed. To see
+:: the title screen come up before the rest are in, throttle the network
+:: in the browser's dev tools and clear the site data.
+
+IF NOT EXIST dist (
+    echo Nothing to serve, run build_web.bat first.
+    exit /b 1
+)
+
+python -m http.server 8080 --directory dist
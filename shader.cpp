@@ -138,10 +138,23 @@ static const char *WOBBLE_FS =
 
 #endif
 
-void WobbleShaderInit(Wobble_Shader *shader, float amplitude, float frequency, float speed)
-{
-    shader->shader = LoadShaderFromMemory(WOBBLE_VS, WOBBLE_FS);
+// NOTE: Every wobble shader that's been made, so a reload of the fragment
+// shader can get to all of them. They're all globals so the pointers stay
+// good.
+static Wobble_Shader *g_wobble_shaders[WOBBLE_SHADER_MAX];
+static u32            g_wobble_shader_count;
+
+// raylib hands back its own default program when a link fails and an id of
+// zero when a compile fails, neither of which is the wobble.
+b32 WobbleShaderCompiled(Shader shader) {
+    b32 result = shader.id != 0 && shader.id != rlGetShaderIdDefault();
+    return result;
+}
 
+// Points the shader at its program's uniforms and sends it the values it 
+// already has, for a new program or one that's just been swapped in.
+void WobbleShaderBind(Wobble_Shader *shader)
+{
     shader->shader.locs[SHADER_LOC_MAP_DIFFUSE] = GetShaderLocation(shader->shader, "texture0");
 
     int texSlot = 0;
@@ -153,7 +166,65 @@ void WobbleShaderInit(Wobble_Shader *shader, float amplitude, float frequency, f
     shader->frequency_location = GetShaderLocation(shader->shader, "frequency");
     shader->speed_location     = GetShaderLocation(shader->shader, "speed");
 
+    SetShaderValue(shader->shader, shader->amplitude_location, &shader->amplitude, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shader->shader, shader->frequency_location, &shader->frequency, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shader->shader, shader->speed_location,     &shader->speed,     SHADER_UNIFORM_FLOAT);
+}
+
+// Desktop builds the fragment shader out of WOBBLE_FS_PATH when it's there
+// so it can be edited while the game runs, the built in one is what's left
+// if it isn't or it doesn't compile. The web build only has the built in one.
+Shader WobbleShaderLoad()
+{
+    Shader result = {};
+#if !defined(PLATFORM_WEB)
+    if (FileExists(WOBBLE_FS_PATH)) {
+        char *code = LoadFileText(WOBBLE_FS_PATH);
+        if (code) {
+            result = LoadShaderFromMemory(WOBBLE_VS, code);
+            UnloadFileText(code);
+        }
+    }
+#endif
+    if (!WobbleShaderCompiled(result)) result = LoadShaderFromMemory(WOBBLE_VS, WOBBLE_FS);
+    return result;
+}
+
+void WobbleShaderInit(Wobble_Shader *shader, float amplitude, float frequency, float speed)
+{
+    b32 known = false;
+    for (u32 index = 0; index < g_wobble_shader_count; index++) {
+        if (g_wobble_shaders[index] == shader) known = true;
+    }
+    if (!known && g_wobble_shader_count < WOBBLE_SHADER_MAX) g_wobble_shaders[g_wobble_shader_count++] = shader;
+
+    shader->shader    = WobbleShaderLoad();
     shader->amplitude = amplitude;
     shader->frequency = frequency;
     shader->speed     = speed;
+    WobbleShaderBind(shader);
+}
+
+// Builds every wobble shader again from WOBBLE_FS_PATH. If the new code 
+// doesn't compile they all keep the program they had.
+b32 WobbleShaderReload()
+{
+    char *code = LoadFileText(WOBBLE_FS_PATH);
+    if (!code) return false;
+
+    b32 result = true;
+    for (u32 index = 0; index < g_wobble_shader_count && result; index++) {
+        Wobble_Shader *shader  = g_wobble_shaders[index];
+        Shader         program = LoadShaderFromMemory(WOBBLE_VS, code);
+        if (WobbleShaderCompiled(program)) {
+            UnloadShader(shader->shader);
+            shader->shader = program;
+            WobbleShaderBind(shader);
+        } else {
+            TraceLog(LOG_WARNING, "SHADER: %s doesn't compile, keeping the last one that did", WOBBLE_FS_PATH);
+            result = false;
+        }
+    }
+    UnloadFileText(code);
+    return result;
 }
@@ -0,0 +1,1031 @@
+// NOTE: Everything in here is the gameplay simulation. It must not call anything
+// that touches the window, the GPU or the audio device so that the game rules
+// can be stepped headless. Anything that wants a sound played or the screen
+// drawn reads the sim state afterwards or checks the events the step raised.
+
+u32 TilemapIndex(u32 x, u32 y, u32 width) {
+    u32 result = y * width + x;
+    return result;
+}
+
+inline Tile TileAt(Tilemap *tilemap, u32 x, u32 y) {
+    Tile result;
+    result.chunk  = tilemap->chunks[(y >> TILE_CHUNK_SHIFT)*tilemap->chunks_x + (x >> TILE_CHUNK_SHIFT)];
+    result.planes = &tilemap->planes;
+    result.slot   = ((y & TILE_CHUNK_MASK) << TILE_CHUNK_SHIFT) + (x & TILE_CHUNK_MASK);
+    result.index  = TilemapIndex(x, y, tilemap->width);
+    return result;
+}
+
+inline Tile GetTile(Tilemap *tilemap, u32 index) {
+    Tile result = TileAt(tilemap, index % tilemap->width, index / tilemap->width);
+    return result;
+}
+
+inline Tile_Type GetTileType(Tile tile) {
+    Tile_Type result = (Tile_Type)tile.chunk->types[tile.slot];
+    return result;
+}
+
+inline u32 GetTileSeed(Tile tile) {
+    u32 result = tile.chunk->seeds[tile.slot];
+    return result;
+}
+
+// Everything a tilemap of this size will pull out of the arena, including 
+// the entity pools and the enclosure tracker scratch that scale with it.
+size_t TilemapMemorySize(u32 width, u32 height) {
+    size_t chunk_count = (size_t)((width  + TILE_CHUNK_MASK) >> TILE_CHUNK_SHIFT) *
+                                 ((height + TILE_CHUNK_MASK) >> TILE_CHUNK_SHIFT);
+    size_t tile_count  = (size_t)width*height;
+    Bit_Plane_Layout layout;
+    BitPlaneLayoutInit(&layout, width, height);
+    size_t result      = chunk_count*(sizeof(Tile_Chunk *) + sizeof(Tile_Chunk));
+    result            += BitPlaneMemorySize(&layout, TilePlane_count + 4); // Flags, floor masks, scratch
+    result            += tile_count*(sizeof(u32) + 2*sizeof(Pool_Handle));
+    result            += tile_count*(sizeof(Enemy) + sizeof(Powerup) + 4*sizeof(u32));
+    result            += tile_count*(sizeof(u32)*(1 + ENCLOSURE_MAX_GROUPS) + sizeof(u8));
+    return result;
+}
+
+// Sets up the storage for a width by height map. The original map still 
+// has to be filled in before TileInit() gets called.
+void TilemapAlloc(Tilemap *tilemap, Memory_Arena *arena, u32 width, u32 height) {
+    ASSERT(width  <= TILEMAP_MAX_SIZE && height <= TILEMAP_MAX_SIZE);
+    u32 tile_count         = width*height;
+    tilemap->width         = width;
+    tilemap->height        = height;
+    tilemap->chunks_x      = (width  + TILE_CHUNK_MASK) >> TILE_CHUNK_SHIFT;
+    tilemap->chunks_y      = (height + TILE_CHUNK_MASK) >> TILE_CHUNK_SHIFT;
+    tilemap->original_map  = (u32 *)ArenaAlloc(arena, sizeof(u32)*tile_count);
+    tilemap->enemy_slots   = (Pool_Handle *)ArenaAlloc(arena, sizeof(Pool_Handle)*tile_count);
+    tilemap->powerup_slots = (Pool_Handle *)ArenaAlloc(arena, sizeof(Pool_Handle)*tile_count);
+
+    u32 chunk_count  = tilemap->chunks_x*tilemap->chunks_y;
+    tilemap->chunks  = (Tile_Chunk **)ArenaAlloc(arena, sizeof(Tile_Chunk *)*chunk_count);
+    for (u32 index = 0; index < chunk_count; index++) {
+        // NOTE: Zeroed so the slots hanging off the edge of the map are 
+        // TileType_none, the seeds get drawn for whole chunks at a time.
+        tilemap->chunks[index]  = (Tile_Chunk *)ArenaAlloc(arena, sizeof(Tile_Chunk));
+        *tilemap->chunks[index] = {};
+    }
+
+    Tile_Planes *planes = &tilemap->planes;
+    BitPlaneLayoutInit(&planes->layout, width, height);
+    for (u32 plane = 0; plane < TilePlane_count; plane++) {
+        planes->flags[plane] = BitPlaneAlloc(&planes->layout, arena);
+    }
+    planes->floor            = BitPlaneAlloc(&planes->layout, arena);
+    planes->floor_from_left  = BitPlaneAlloc(&planes->layout, arena);
+    planes->floor_from_right = BitPlaneAlloc(&planes->layout, arena);
+    planes->scratch          = BitPlaneAlloc(&planes->layout, arena);
+}
+
+// A plain walled in field for the big arena variants. The top two rows 
+// are wall to leave room for the gui bar same as the hand made map.
+void TilemapGenerateArena(Tilemap *tilemap) {
+    for (u32 y = 0; y < tilemap->height; y++) {
+        for (u32 x = 0; x < tilemap->width; x++) {
+            b32 wall = (x == 0 || y < 2 || x == tilemap->width - 1 || y == tilemap->height - 1);
+            tilemap->original_map[TilemapIndex(x, y, tilemap->width)] = wall ? TileType_wall : TileType_floor;
+        }
+    }
+}
+
+// Picks every tile's atlas frame. The random numbers for a whole chunk get 
+// drawn in one go and then scaled into the range for each tile's type, 
+// which is a lot cheaper on the big maps than a call per tile.
+void TileSeedsInit(Tilemap *tilemap) {
+    static const u32 seed_ranges[] = {1, WALL_ATLAS_COUNT, TILE_ATLAS_COUNT}; // By Tile_Type
+    u32 random[TILE_CHUNK_AREA];
+    u32 chunk_count = tilemap->chunks_x*tilemap->chunks_y;
+    for (u32 chunk_index = 0; chunk_index < chunk_count; chunk_index++) {
+        Tile_Chunk *chunk = tilemap->chunks[chunk_index];
+        RandomFill(&tilemap->random, random, TILE_CHUNK_AREA);
+        for (u32 slot = 0; slot < TILE_CHUNK_AREA; slot++) {
+            u32 type           = chunk->types[slot];
+            u32 range          = type < ARRAY_COUNT(seed_ranges) ? seed_ranges[type] : 1;
+            chunk->seeds[slot] = (u8)(((u64)random[slot]*range) >> 32);
+        }
+    }
+}
+
+void TileInit(Tilemap *tilemap) {
+    tilemap->reset_count++;
+
+    Tile_Planes *planes = &tilemap->planes;
+    for (u32 plane = 0; plane < TilePlane_count; plane++) {
+        BitPlaneClear(&planes->layout, planes->flags[plane]);
+    }
+    BitPlaneClear(&planes->layout, planes->floor);
+    BitPlaneClear(&planes->layout, planes->floor_from_left);
+    BitPlaneClear(&planes->layout, planes->floor_from_right);
+
+    for (u32 y = 0; y < tilemap->height; y++) {
+        for (u32 x = 0; x < tilemap->width; x++) {
+            u32  index = TilemapIndex(x, y, tilemap->width);
+            Tile tile  = TileAt(tilemap, x, y);
+            tile.chunk->types[tile.slot] = (u8)tilemap->original_map[index];
+
+            if (GetTileType(tile) == TileType_floor) {
+                BitPlaneSet(planes->floor, index);
+                if (x > 0)                  BitPlaneSet(planes->floor_from_left,  index);
+                if (x < tilemap->width - 1) BitPlaneSet(planes->floor_from_right, index);
+            }
+
+            tilemap->enemy_slots[index]   = {};
+            tilemap->powerup_slots[index] = {};
+        }
+    }
+    TileSeedsInit(tilemap);
+
+    // The whole map just changed under the enclosure tracker. Once we know 
+    // the starting map is all one open area there's nothing to find though.
+    Enclosure_Tracker *tracker  = &tilemap->enclosure;
+    tracker->pending_count      = 0;
+    tracker->needs_full_check   = !tracker->reset_is_one_area;
+    tracker->first_check        = true;
+}
+
+void PlayerInit(Player *player) {
+    player->pos                 = {base_screen_width*0.5, base_screen_height*0.5};
+    player->target_pos          = player->pos;
+    player->prev_pos            = player->pos;
+    player->size                = {20, 20};
+    player->col                 = WHITE;
+    player->speed               = 75.0f;
+    player->powered_up          = false;
+    player->powerup_timer       = 0;
+    player->blink_speed         = 0;
+    player->blinking_duration   = 0;
+    player->col_bool            = false;
+    player->facing              = DirectionFacing_down;
+    for(u32 index = 0; index < INPUT_MAX; index++) {
+        player->input_buffer.inputs[index] = DirectionFacing_down;
+    }
+    player->input_buffer.start = 0;
+    player->input_buffer.end   = 0;
+}
+
+// The animations handed in here are prototypes that were loaded once up front,
+// spawning only copies them so the sim never has to go anywhere near the GPU.
+void PowerupInit(Powerup *powerup, Powerup *sentinel, u32 tile_index, Animation *animator) {
+    powerup->tile_index = tile_index;
+    powerup->next       = sentinel->next;
+    powerup->prev       = sentinel;
+    powerup->next->prev = powerup;
+    powerup->prev->next = powerup;
+    powerup->animator   = *animator;
+}
+
+void EnemyInit(Enemy *enemy, Enemy *sentinel, u32 tile_index, Animation *animators) {
+    enemy->tile_index      = tile_index;
+    enemy->prev_tile_index = tile_index;
+    enemy->next            = sentinel->next;
+    enemy->prev            = sentinel;
+    enemy->next->prev      = enemy;
+    enemy->prev->next      = enemy;
+    for (u32 index = 0; index < EnemyAnimator_count; index++) {
+        enemy->animators[index] = animators[index];
+    }
+}
+
+// The slot arrays mirror the enemy/powerup tile flags so whatever is
+// standing on a tile can be grabbed straight away instead of walking
+// the linked lists. Anything that sets or clears one of those flags
+// needs to keep the slot in step with it. The slots hold pool handles
+// rather than pointers so a slot that's gone stale resolves to NULL.
+Enemy *FindEnemyAtTile(Tilemap *tilemap, Memory_Pool *pool, u32 index) {
+    Enemy *result = (Enemy *)PoolGet(pool, tilemap->enemy_slots[index]);
+    return result;
+}
+
+Powerup *FindPowerupAtTile(Tilemap *tilemap, Memory_Pool *pool, u32 index) {
+    Powerup *result = (Powerup *)PoolGet(pool, tilemap->powerup_slots[index]);
+    return result;
+}
+
+void DeleteEnemyAtTile(Tilemap *tilemap, Memory_Pool *pool, u32 index) {
+    Enemy *enemy_to_delete = FindEnemyAtTile(tilemap, pool, index);
+    ASSERT(enemy_to_delete);
+    enemy_to_delete->prev->next = enemy_to_delete->next;
+    enemy_to_delete->next->prev = enemy_to_delete->prev;
+    PoolFree(pool, tilemap->enemy_slots[index]);
+    tilemap->enemy_slots[index] = {};
+}
+
+void DeletePowerupAtTile(Tilemap *tilemap, Memory_Pool *pool, u32 index) {
+    Powerup *powerup_to_delete = FindPowerupAtTile(tilemap, pool, index);
+    ASSERT(powerup_to_delete);
+    powerup_to_delete->prev->next = powerup_to_delete->next;
+    powerup_to_delete->next->prev = powerup_to_delete->prev;
+    PoolFree(pool, tilemap->powerup_slots[index]);
+    tilemap->powerup_slots[index] = {};
+}
+
+void BeginScreenShake(Screen_Shake *shake, f32 intensity, f32 duration, f32 decay) {
+    shake->intensity = intensity;
+    shake->duration  = duration;
+    shake->decay     = decay;
+}
+
+void GameOver(Player *player, Tilemap *tilemap,  Game_Manager *manager) {
+    PlayerInit(player);
+    manager->state            = GameState_play;
+    manager->score            = 0;
+    manager->score_multiplier = 0;
+
+    // Delete all enemies and powerups from the enemy/powerup linked lists
+    // and hand all their memory back to the pools.
+    manager->enemy_sentinel.next = &manager->enemy_sentinel;
+    manager->enemy_sentinel.prev = &manager->enemy_sentinel;
+    manager->powerup_sentinel.next = &manager->powerup_sentinel;
+    manager->powerup_sentinel.prev = &manager->powerup_sentinel;
+    PoolReset(&manager->enemy_pool);
+    PoolReset(&manager->powerup_pool);
+
+    // Reset the tilemap back to it's original orientation
+    TileInit(tilemap);
+}
+
+// NOTE: The flag functions take a mask of TileFlag_ values. Callers almost 
+// always pass a single constant so after inlining this is one bit op on 
+// one plane.
+inline void AddFlag(Tile tile, u32 flag) {
+    for (u32 plane = 0; plane < TilePlane_count; plane++) {
+        if (flag & (1 << plane)) BitPlaneSet(tile.planes->flags[plane], tile.index);
+    }
+}
+
+inline void ClearFlag(Tile tile, u32 flag) {
+    for (u32 plane = 0; plane < TilePlane_count; plane++) {
+        if (flag & (1 << plane)) BitPlaneUnset(tile.planes->flags[plane], tile.index);
+    }
+}
+
+inline b32 IsFlagSet(Tile tile, u32 flag) {
+    b32 result = false;
+    for (u32 plane = 0; plane < TilePlane_count; plane++) {
+        if (flag & (1 << plane)) result |= BitPlaneGet(tile.planes->flags[plane], tile.index);
+    }
+    return result;
+}
+
+// All of a tile's flags gathered back up into one mask.
+u32 GetTileFlags(Tile tile) {
+    u32 result = 0;
+    for (u32 plane = 0; plane < TilePlane_count; plane++) {
+        if (BitPlaneGet(tile.planes->flags[plane], tile.index)) result |= 1 << plane;
+    }
+    return result;
+}
+
+u32 CountTilesWithFlag(Tilemap *tilemap, Tile_Plane plane) {
+    u32 result = BitPlaneCount(&tilemap->planes.layout, tilemap->planes.flags[plane]);
+    return result;
+}
+
+b32 IsOpenTile(Tilemap *tilemap, s32 x, s32 y) {
+    b32 result = false;
+    if (x >= 0 && y >= 0 && x < (s32)tilemap->width && y < (s32)tilemap->height) {
+        u32 index = TilemapIndex(x, y, tilemap->width);
+        result    = BitPlaneGet(tilemap->planes.floor, index) &&
+                    !BitPlaneGet(tilemap->planes.flags[TilePlane_fire], index);
+    }
+    return result;
+}
+
+// Marks everything the player can reach as visited by growing the visited 
+// plane out from their tile, a whole plane of tiles at a time.
+void CheckEnclosedAreasFromPlayerPosition(Tilemap *tilemap, u32 start_x, u32 start_y) {
+    Tile_Planes *planes  = &tilemap->planes;
+    u64         *visited = planes->flags[TilePlane_visited];
+    BitPlaneClear(&planes->layout, visited);
+
+    if (!IsOpenTile(tilemap, start_x, start_y)) return;
+    BitPlaneSet(visited, TilemapIndex(start_x, start_y, tilemap->width));
+    BitPlaneFlood(&planes->layout, visited, planes->floor, planes->floor_from_left,
+                  planes->floor_from_right, planes->flags[TilePlane_fire]);
+}
+
+// Fills the scratch plane with every floor tile that has nothing on it.
+u64 *BuildEmptyTilePlane(Tilemap *tilemap) {
+    Tile_Planes *planes  = &tilemap->planes;
+    u64         *fire    = planes->flags[TilePlane_fire];
+    u64         *powerup = planes->flags[TilePlane_powerup];
+    u64         *enemy   = planes->flags[TilePlane_enemy];
+    u64         *result  = planes->scratch;
+    for (u32 word = 0; word < planes->layout.word_count; word++) {
+        result[word] = planes->floor[word] & ~(fire[word] | powerup[word] | enemy[word]);
+    }
+    return result;
+}
+
+// Picks uniformly from the tiles set in the plane, or returns zero if there 
+// aren't any. Zero is always a wall corner so it's safe as a nothing value.
+u32 PickRandomTile(Tilemap *tilemap, u64 *plane, Random_Series *random) {
+    u32 result = 0;
+    u32 count  = BitPlaneCount(&tilemap->planes.layout, plane);
+    if (count) {
+        u32 pick = (u32)RandomRange(random, 0, count - 1);
+        result   = BitPlaneSelect(&tilemap->planes.layout, plane, pick);
+    }
+    return result;
+}
+
+u32 GetRandomEmptyTileIndex(Tilemap *tilemap, Random_Series *random) {
+    u64 *empty  = BuildEmptyTilePlane(tilemap);
+    u32  result = PickRandomTile(tilemap, empty, random);
+    return result;
+}
+
+// Same again but never right next to the given tile, so enemies don't 
+// spawn on top of the player.
+u32 GetRandomEmptyTileIndex(Tilemap *tilemap, u32 tile_index, Random_Series *random) {
+    u64 *empty = BuildEmptyTilePlane(tilemap);
+    s32  x     = tile_index % tilemap->width;
+    s32  y     = tile_index / tilemap->width;
+    s32 offset_x[4] = {1,-1, 0, 0};
+    s32 offset_y[4] = {0, 0, 1,-1};
+    for (u32 dir = 0; dir < 4; dir++) {
+        s32 next_x = x + offset_x[dir];
+        s32 next_y = y + offset_y[dir];
+        if (next_x >= 0 && next_y >= 0 && next_x < (s32)tilemap->width && next_y < (s32)tilemap->height) {
+            BitPlaneUnset(empty, TilemapIndex(next_x, next_y, tilemap->width));
+        }
+    }
+    u32 result = PickRandomTile(tilemap, empty, random);
+    return result;
+}
+
+u32 FindEligibleTileIndexForEnemyMove(Tilemap *tilemap, u32 index, Random_Series *random) {
+    u32 right_tile   = index + 1;
+    u32 left_tile    = index - 1;
+    u32 bottom_tile  = index + tilemap->width;
+    u32 top_tile     = index - tilemap->width;
+
+    const u32 adjacent_count = 4;
+    u32 adjacent_tile_indexes[adjacent_count] = {right_tile, left_tile, bottom_tile, top_tile};
+    u32 eligible_tiles[adjacent_count] = {};
+    u32 eligible_count = 0;
+    u32 result = 0;
+
+    for (int adjacent_index = 0; adjacent_index < ARRAY_COUNT(adjacent_tile_indexes); adjacent_index++) {
+        Tile tile = GetTile(tilemap, adjacent_tile_indexes[adjacent_index]);
+
+        if(GetTileType(tile) == TileType_floor) {
+            if (!IsFlagSet(tile, TileFlag_fire) && !IsFlagSet(tile, TileFlag_powerup) &&
+                !IsFlagSet(tile, TileFlag_enemy)) {
+                eligible_tiles[eligible_count] = adjacent_tile_indexes[adjacent_index];
+                eligible_count++;
+            }
+        }
+    }
+
+    if (eligible_count) {
+        u32 eligible_index = eligible_count - 1;
+        u32 random_index = (u32)RandomRange(random, 0, eligible_index);
+        result = eligible_tiles[random_index];
+    }
+
+    return result;
+}
+
+// Sets an enclosed tile on fire and takes out whatever was standing on it.
+// Returns true if an enemy got caught in it.
+b32 BurnEnclosedTile(Game_Sim *sim, u32 index) {
+    Tilemap      *tilemap = sim->map;
+    Game_Manager *manager = sim->manager;
+    Tile          tile    = GetTile(tilemap, index);
+    b32           result  = false;
+
+    AddFlag(tile, TileFlag_fire);
+    if (IsFlagSet(tile, TileFlag_powerup)) {
+        ClearFlag(tile, TileFlag_powerup);
+        DeletePowerupAtTile(tilemap, &manager->powerup_pool, index);
+    }
+    if (IsFlagSet(tile, TileFlag_enemy)) {
+        DeleteEnemyAtTile(tilemap, &manager->enemy_pool, index);
+        ClearFlag(tile, TileFlag_enemy);
+        f32 speed_increase   = 10.0f;
+        sim->player->speed  += speed_increase;
+        result               = true;
+    }
+    return result;
+}
+
+// The original way of doing it. Flood fill the whole map from the player and 
+// burn everything that didn't get reached. Still used whenever the tracker 
+// has lost track of things, like straight after the map gets reset.
+u32 BurnAllEnclosedAreas(Game_Sim *sim, u32 current_x, u32 current_y) {
+    Tilemap     *tilemap     = sim->map;
+    Tile_Planes *planes      = &tilemap->planes;
+    u64         *visited     = planes->flags[TilePlane_visited];
+    u64         *fire        = planes->flags[TilePlane_fire];
+    u32          enemy_slain = 0;
+
+    // Mark all reachable areas from the player with a visited flag on the tile.
+    // All areas not marked are enclosed areas.
+    CheckEnclosedAreasFromPlayerPosition(tilemap, current_x, current_y);
+    // Any floor tiles not marked as visited are enclosed
+    for (u32 word = 0; word < planes->layout.word_count; word++) {
+        u64 enclosed = planes->floor[word] & ~fire[word] & ~visited[word];
+        while (enclosed) {
+            u32 index = (word << 6) + CountTrailingZeros64(enclosed);
+            enclosed &= enclosed - 1;
+            if (BurnEnclosedTile(sim, index)) enemy_slain++;
+        }
+    }
+    BitPlaneClear(&planes->layout, visited);
+
+    tilemap->enclosure.full_checks++;
+    return enemy_slain;
+}
+
+void EnclosureTrackerInit(Enclosure_Tracker *tracker, Memory_Arena *arena, u32 tile_count) {
+    tracker->pending_count     = 0;
+    tracker->needs_full_check  = true;
+    tracker->reset_is_one_area = false;
+    tracker->first_check       = true;
+    tracker->stamp             = 0;
+    tracker->visit_stamp       = (u32 *)ArenaAlloc(arena, sizeof(u32)*tile_count);
+    tracker->visit_group       = (u8 *)ArenaAlloc(arena, sizeof(u8)*tile_count);
+    for (u32 group = 0; group < ENCLOSURE_MAX_GROUPS; group++) {
+        tracker->queues[group] = (u32 *)ArenaAlloc(arena, sizeof(u32)*tile_count);
+    }
+    for (u32 index = 0; index < tile_count; index++) {
+        tracker->visit_stamp[index] = 0;
+    }
+}
+
+void EnclosureMarkFire(Tilemap *tilemap, u32 index) {
+    Enclosure_Tracker *tracker = &tilemap->enclosure;
+    if (tracker->pending_count < ENCLOSURE_PENDING_MAX) {
+        tracker->pending[tracker->pending_count++] = index;
+    } else {
+        tracker->needs_full_check = true;
+    }
+}
+
+// Walks the eight tiles around a tile that just caught fire and works out 
+// which of its open side neighbours can still reach each other without going 
+// through it. Neighbours that sit in the same unbroken run of open tiles 
+// around the ring are still connected, so only one seed per run is written out. 
+// If there's only one run the new fire can't have cut anything off.
+u32 FindSplitSeeds(Tilemap *tilemap, u32 index, u32 *seeds) {
+    s32 x = index % tilemap->width;
+    s32 y = index / tilemap->width;
+
+    // Clockwise starting from straight up, sides on the even slots.
+    s32 ring_x[8] = { 0, 1, 1, 1, 0,-1,-1,-1};
+    s32 ring_y[8] = {-1,-1, 0, 1, 1, 1, 0,-1};
+    b32 open[8];
+    for (u32 slot = 0; slot < 8; slot++) {
+        open[slot] = IsOpenTile(tilemap, x + ring_x[slot], y + ring_y[slot]);
+    }
+
+    // Start walking from a closed slot so a run never gets split across the 
+    // end of the ring. If everything is open there's nothing to split.
+    u32 start = 8;
+    for (u32 slot = 0; slot < 8; slot++) {
+        if (!open[slot]) { start = slot; break; }
+    }
+    if (start == 8) return 0;
+
+    u32 seed_count = 0;
+    b32 run_seeded = false;
+    for (u32 step = 1; step <= 8; step++) {
+        u32 slot = (start + step) % 8;
+        if (!open[slot]) {
+            run_seeded = false;
+        } else if (!run_seeded && (slot & 1) == 0) {
+            seeds[seed_count++] = TilemapIndex(x + ring_x[slot], y + ring_y[slot], tilemap->width);
+            run_seeded = true;
+        }
+    }
+    return seed_count;
+}
+
+inline u32 EnclosureFindGroup(u32 *parent, u32 group) {
+    while (parent[group] != group) group = parent[group];
+    return group;
+}
+
+// A tile catching fire might have split the open area into pieces. Flood out 
+// from each side of it in lock step and whichever pieces run out of tiles 
+// without reaching the player are enclosed. Because the searches move together 
+// the cost is roughly the size of the small pieces, the big open area the 
+// player is in never has to be walked all the way.
+u32 BurnEnclosedAreasAround(Game_Sim *sim, u32 fire_index, u32 player_index) {
+    Tilemap           *tilemap = sim->map;
+    Enclosure_Tracker *tracker = &tilemap->enclosure;
+
+    u32 seeds[ENCLOSURE_MAX_GROUPS];
+    u32 group_count = FindSplitSeeds(tilemap, fire_index, seeds);
+    tracker->local_checks++;
+    if (group_count < 2) return 0;
+
+    tracker->searches++;
+    tracker->stamp++;
+    if (tracker->stamp == 0) {
+        for (u32 index = 0; index < tilemap->width*tilemap->height; index++) {
+            tracker->visit_stamp[index] = 0;
+        }
+        tracker->stamp = 1;
+    }
+
+    u32 parent[ENCLOSURE_MAX_GROUPS];
+    u32 head[ENCLOSURE_MAX_GROUPS];
+    u32 tail[ENCLOSURE_MAX_GROUPS];
+    b32 has_player[ENCLOSURE_MAX_GROUPS];
+    for (u32 group = 0; group < group_count; group++) {
+        u32 seed                    = seeds[group];
+        parent[group]               = group;
+        head[group]                 = 0;
+        tail[group]                 = 1;
+        has_player[group]           = (seed == player_index);
+        tracker->queues[group][0]   = seed;
+        tracker->visit_stamp[seed]  = tracker->stamp;
+        tracker->visit_group[seed]  = (u8)group;
+    }
+
+    s32 offset_x[4] = {1,-1, 0, 0};
+    s32 offset_y[4] = {0, 0, 1,-1};
+    u32 player_root = ENCLOSURE_MAX_GROUPS;
+    for (;;) {
+        // Work out where things stand. Each root is one piece as far as we 
+        // know so far, it's done once all the searches that make it up have 
+        // run dry.
+        b32 root_active[ENCLOSURE_MAX_GROUPS] = {};
+        b32 root_player[ENCLOSURE_MAX_GROUPS] = {};
+        u32 root_count = 0, active_count = 0;
+        for (u32 group = 0; group < group_count; group++) {
+            u32 root = EnclosureFindGroup(parent, group);
+            if (root == group) root_count++;
+            if (head[group] < tail[group]) root_active[root] = true;
+            if (has_player[group])         root_player[root] = true;
+        }
+        if (root_count == 1) return 0;
+
+        player_root = ENCLOSURE_MAX_GROUPS;
+        for (u32 group = 0; group < group_count; group++) {
+            if (EnclosureFindGroup(parent, group) != group) continue;
+            if (root_player[group]) player_root = group;
+            if (root_active[group]) active_count++;
+        }
+
+        // Once every piece except the one with the player is finished we're 
+        // done. If no finished piece has the player in it then the last one 
+        // still going must be the one they're in.
+        u32 other_active = active_count;
+        if (player_root != ENCLOSURE_MAX_GROUPS && root_active[player_root]) other_active--;
+        if (player_root == ENCLOSURE_MAX_GROUPS && active_count == 1) {
+            for (u32 group = 0; group < group_count; group++) {
+                if (EnclosureFindGroup(parent, group) == group && root_active[group]) player_root = group;
+            }
+            other_active = 0;
+        }
+        if (other_active == 0) break;
+
+        for (u32 group = 0; group < group_count; group++) {
+            if (head[group] >= tail[group]) continue;
+            if (EnclosureFindGroup(parent, group) == player_root) continue;
+
+            u32 index = tracker->queues[group][head[group]++];
+            s32 x     = index % tilemap->width;
+            s32 y     = index / tilemap->width;
+            for (u32 dir = 0; dir < 4; dir++) {
+                s32 next_x = x + offset_x[dir];
+                s32 next_y = y + offset_y[dir];
+                if (!IsOpenTile(tilemap, next_x, next_y)) continue;
+
+                u32 next = TilemapIndex(next_x, next_y, tilemap->width);
+                if (tracker->visit_stamp[next] != tracker->stamp) {
+                    tracker->visit_stamp[next]              = tracker->stamp;
+                    tracker->visit_group[next]              = (u8)group;
+                    tracker->queues[group][tail[group]++]   = next;
+                    if (next == player_index) has_player[group] = true;
+                } else {
+                    u32 root_a = EnclosureFindGroup(parent, group);
+                    u32 root_b = EnclosureFindGroup(parent, tracker->visit_group[next]);
+                    if (root_a != root_b) parent[root_b] = root_a;
+                }
+            }
+        }
+    }
+
+    // The player ended up somewhere none of the searches could reach. That 
+    // shouldn't happen, but if it does let the full check sort it out.
+    if (player_root == ENCLOSURE_MAX_GROUPS) {
+        tracker->needs_full_check = true;
+        return 0;
+    }
+
+    u32 enemy_slain = 0;
+    for (u32 group = 0; group < group_count; group++) {
+        if (EnclosureFindGroup(parent, group) == player_root) continue;
+        for (u32 entry = 0; entry < tail[group]; entry++) {
+            if (BurnEnclosedTile(sim, tracker->queues[group][entry])) enemy_slain++;
+        }
+        tracker->tiles_searched += tail[group];
+    }
+    return enemy_slain;
+}
+
+void FillEnclosedAreas(Game_Sim *sim, u32 current_x, u32 current_y) {
+    PROFILE_ZONE("FillEnclosedAreas");
+    Tilemap           *tilemap = sim->map;
+    Game_Manager      *manager = sim->manager;
+    Enclosure_Tracker *tracker = &tilemap->enclosure;
+
+    u32 enemy_slain = 0;
+    if (!tracker->needs_full_check) {
+        u32 player_index = TilemapIndex(current_x, current_y, tilemap->width);
+        for (u32 pending = 0; pending < tracker->pending_count; pending++) {
+            enemy_slain += BurnEnclosedAreasAround(sim, tracker->pending[pending], player_index);
+            if (tracker->needs_full_check) break;
+        }
+    }
+    if (tracker->needs_full_check) {
+        u32 fire_count = CountTilesWithFlag(tilemap, TilePlane_fire);
+        enemy_slain   += BurnAllEnclosedAreas(sim, current_x, current_y);
+        // Nothing burning on the first check after a reset means the map 
+        // starts out as one open area, so later resets can skip the full check.
+        if (tracker->first_check && CountTilesWithFlag(tilemap, TilePlane_fire) == fire_count) {
+            tracker->reset_is_one_area = true;
+        }
+        tracker->needs_full_check = false;
+    }
+    tracker->pending_count = 0;
+    tracker->first_check   = false;
+
+    if (enemy_slain) {
+        sim->events.flags |= SimEvent_enemy_slain;
+        BeginScreenShake(&manager->screen_shake, 2.0f*enemy_slain, 0.6f, 10.0f);
+        manager->score_multiplier = enemy_slain;
+    }
+    while (enemy_slain) {
+        u32 tile_index = GetRandomEmptyTileIndex(tilemap, &sim->random);
+        if (tile_index) {
+            Tile tile = GetTile(tilemap, tile_index);
+            Pool_Handle handle;
+            Powerup *new_powerup = (Powerup *)PoolAlloc(&manager->powerup_pool, &handle);
+            if (new_powerup) {
+                AddFlag(tile, TileFlag_powerup);
+                PowerupInit(new_powerup, &manager->powerup_sentinel, tile_index, &manager->powerup_animator);
+                tilemap->powerup_slots[tile_index] = handle;
+            }
+        }
+        enemy_slain--;
+    }
+}
+
+// TODO: Maybe make these functions take the input buffer as the argument
+// instead of the player
+inline bool InputBufferEmpty(Player *player) {
+    bool result = player->input_buffer.start == player->input_buffer.end;
+    return result;
+}
+
+inline bool InputBufferFull(Player *player) {
+    bool result = ((player->input_buffer.end + 1) % INPUT_MAX) == player->input_buffer.start;
+    return result;
+}
+
+void InputBufferPush(Player *player, Direction_Facing dir) {
+    if (!InputBufferFull(player)) {
+
+        player->input_buffer.inputs[player->input_buffer.end] = dir;
+        player->input_buffer.end = (player->input_buffer.end + 1) % INPUT_MAX;
+    }
+}
+
+Direction_Facing InputBufferPop(Player *player) {
+    Direction_Facing result = DirectionFacing_none;
+    if(!InputBufferEmpty(player)) {
+        result = player->input_buffer.inputs[player->input_buffer.start];
+        player->input_buffer.start = (player->input_buffer.start + 1) % INPUT_MAX;
+    }
+    return result;
+}
+
+void StorePlayerDirectionsInBuffer(Player *player, Input_Frame *input) {
+    for (u32 input_index = 0; input_index < input->direction_count; input_index++) {
+        Direction_Facing dir = input->directions[input_index];
+        if (dir == DirectionFacing_none) continue;
+
+        if (InputBufferEmpty(player)) {
+            if ((player->facing == DirectionFacing_up    && dir == DirectionFacing_down) ||
+                (player->facing == DirectionFacing_down  && dir == DirectionFacing_up)   ||
+                (player->facing == DirectionFacing_left  && dir == DirectionFacing_right)||
+                (player->facing == DirectionFacing_right && dir == DirectionFacing_left)) {
+                continue;
+            }
+        }
+
+        if (!InputBufferEmpty(player)) {
+            if (player->input_buffer.inputs[player->input_buffer.end] == dir)
+                continue;
+        }
+
+        InputBufferPush(player, dir);
+    }
+}
+
+Text_Burst CreateTextBurst(const char *text, Random_Series *random) {
+    Text_Burst burst =  {};
+    burst.text       =  text;
+    burst.pos        =  {(f32)RandomRange(random, 0+TILE_SIZE, base_screen_width-TILE_SIZE),
+                         (f32)RandomRange(random, 0+TILE_SIZE, base_screen_height-TILE_SIZE)};
+    burst.alpha      =  0.0f;
+    burst.scale      =  0.25f;
+    burst.max_scale  =  0.75f + (float)RandomRange(random, 0, 99) / 100.0f;
+    burst.drift.x    = -1.25f + (float)RandomRange(random, 0, 1);
+    burst.drift.y    = -1.25f + (float)RandomRange(random, 0, 1);
+    burst.lifetime   =  1.0f;
+    burst.age        =  0.0f;
+    burst.active     =  true;
+    return burst;
+}
+
+b32 IsPowerupEnding(Player *player, f64 time) {
+    f32 end_duration_signal = 3.0f;
+    b32 result = player->powered_up && (player->powerup_timer - end_duration_signal) < time;
+    return result;
+}
+
+void SimGameOver(Game_Sim *sim) {
+    GameOver(sim->player, sim->map, sim->manager);
+    sim->events.flags |= SimEvent_game_over;
+}
+
+void SimUpdatePlayer(Game_Sim *sim, Input_Frame *input, f32 delta_t) {
+    Tilemap      *map     = sim->map;
+    Player       *player  = sim->player;
+    Game_Manager *manager = sim->manager;
+
+    // TODO: My unchecked/unsubstantiated theory of why the player movement
+    // feel off and why buttons pressed in quick successsion aren't logged
+    // is because of the is_moving flag. I think maybe while the player is moving
+    // it ignores directions inputs. But as you can see the directions are stored
+    // inside the buffer before is is_moving flag is checked. So i'm not 100% sure,
+    // because I don't see how that could happen. But it definitely feels like inputs
+    // get ignored while the player is moving. But I guess only if the buttons are pressed
+    // in quick succession. Also strangely I feel like when the player picks up speed
+    // and starts to move a lot faster things feel a bit more tighter. This I guess
+    // is also why I think it's related to is_moving because the window where that
+    // bool switches is so much shorter and the late game when the character is moving
+    // really fast.
+    StorePlayerDirectionsInBuffer(player, input);
+    if (!player->is_moving) {
+        Direction_Facing dir = InputBufferPop(player);
+        if (dir == DirectionFacing_none) dir = player->facing;
+
+        Vector2 input_axis = {0, 0};
+        switch (dir) {
+            case DirectionFacing_up:    input_axis = { 0,-1}; break;
+            case DirectionFacing_down:  input_axis = { 0, 1}; break;
+            case DirectionFacing_left:  input_axis = {-1, 0}; break;
+            case DirectionFacing_right: input_axis = { 1, 0}; break;
+            default: break;
+        }
+
+        if (input_axis.x || input_axis.y) {
+            s32 current_tile_x = (s32)floorf(player->pos.x / map->tile_size);
+            s32 current_tile_y = (s32)floorf(player->pos.y / map->tile_size);
+
+            s32 direction_x = (s32)input_axis.x;
+            s32 direction_y = (s32)input_axis.y;
+
+            s32 target_tile_x = current_tile_x + direction_x;
+            s32 target_tile_y = current_tile_y + direction_y;
+
+            if (target_tile_x < 0 || target_tile_y < 0 ||
+                target_tile_x >= (s32)map->width || target_tile_y >= (s32)map->height) {
+                // Right off the edge of the map so there's no tile to even look at.
+                SimGameOver(sim);
+                return;
+            }
+
+            u32 target_tile_index = TilemapIndex((u32)target_tile_x, (u32)target_tile_y, map->width);
+            Tile target_tile = GetTile(map, target_tile_index);
+
+            if (target_tile_x > 0 && target_tile_x < (s32)map->width - 1 &&
+                target_tile_y > 0 && target_tile_y < (s32)map->height - 1) {
+
+                if (GetTileType(target_tile) != TileType_wall && GetTileType(target_tile) != TileType_none) {
+                    player->facing = dir;
+                    player->target_pos = {(float)target_tile_x * map->tile_size, (float)target_tile_y * map->tile_size};
+                    player->is_moving = true;
+
+                    u32 current_tile_index = TilemapIndex((u32)current_tile_x, (u32)current_tile_y, map->width);
+                    Tile current_tile = GetTile(map, current_tile_index);
+                    if (!player->powered_up && !IsFlagSet(current_tile, TileFlag_fire)) {
+                        AddFlag(current_tile, TileFlag_fire);
+                        EnclosureMarkFire(map, current_tile_index);
+                    }
+                } else {
+                    SimGameOver(sim);
+                }
+            } else {
+                // Out of bounds
+                SimGameOver(sim);
+            }
+
+            if (IsFlagSet(target_tile, TileFlag_powerup)) {
+                f32 powerup_duration       = 10.0f;
+                player->powerup_timer      = sim->time + powerup_duration;
+                player->powered_up         = true;
+                player->blink_speed        = 0.1f;
+                player->blinking_duration  = player->blink_speed;
+                ClearFlag(target_tile, TileFlag_powerup);
+                DeletePowerupAtTile(map, &manager->powerup_pool, target_tile_index);
+                sim->events.flags         |= SimEvent_powerup_collect;
+                manager->hype_sound_timer  = 0;
+            }
+
+            if (player->powered_up) {
+                if (IsFlagSet(target_tile, TileFlag_fire)) {
+                    ClearFlag(target_tile, TileFlag_fire);
+                    manager->score += (10 * manager->score_multiplier);
+                    BeginScreenShake(&manager->screen_shake, 1.5f, 0.6f, 10.0f);
+                    // Create the text bursts
+                    for (int index = 0; index < MAX_BURSTS; index++) {
+                        if (!manager->bursts[index].active) {
+                            u32 random_index      = (u32)RandomRange(&sim->effects, 0, HYPE_WORD_COUNT - 1);
+                            const char *word      = manager->hype_text[random_index];
+                            // TODO: Settle on what kind of positioning I want to have the create
+                            // text burst appear at.
+                            manager->bursts[index] = CreateTextBurst(word, &sim->effects);
+                            break;
+                        }
+                    }
+                    // Pick the hype sound, the platform layer plays it.
+                    if (manager->hype_sound_timer <= sim->time) {
+                        u32 index = (u32)RandomRange(&sim->effects, 0, HYPE_WORD_COUNT - 1);
+                        while (index == manager->hype_prev_index) {
+                            index = (u32)RandomRange(&sim->effects, 0, HYPE_WORD_COUNT - 1);
+                        }
+                        ASSERT(index < HYPE_WORD_COUNT);
+                        sim->events.flags         |= SimEvent_hype;
+                        sim->events.hype_index     = index;
+
+                        manager->hype_prev_index   = index;
+                        f32 sound_duration         = sim->time + 0.90f;
+                        manager->hype_sound_timer  = sound_duration;
+                    }
+                }
+            }
+
+            if (IsFlagSet(target_tile, TileFlag_fire) || IsFlagSet(target_tile, TileFlag_enemy)) {
+                SimGameOver(sim);
+            }
+        }
+    } else {
+        // Move towards target position
+        Vector2 direction = VectorSub(player->target_pos, player->pos);
+        float distance    = Length(direction);
+        if (distance <= player->speed * delta_t) {
+            player->pos       = player->target_pos;
+            player->is_moving = false;
+
+            u32 current_tile_x = (u32)player->pos.x / map->tile_size;
+            u32 current_tile_y = (u32)player->pos.y / map->tile_size;
+
+            FillEnclosedAreas(sim, current_tile_x, current_tile_y);
+        } else {
+            direction        = VectorNorm(direction);
+            Vector2 movement = VectorScale(direction, player->speed * delta_t);
+            player->pos      = VectorAdd(player->pos, movement);
+        }
+    }
+}
+
+void SimUpdatePowerup(Game_Sim *sim, f32 delta_t) {
+    Player       *player  = sim->player;
+    Game_Manager *manager = sim->manager;
+
+    // How much of the full volume range the play tracks crossfade per second.
+    f32 crossfade_rate = 1.2f;
+
+    if (player->powered_up) {
+        manager->play_song_volume       -= crossfade_rate * delta_t;
+        manager->play_muted_song_volume += crossfade_rate * delta_t;
+
+        if (player->powerup_timer < sim->time) { // Powerup is over.
+            player->powered_up         = false;
+            player->col_bool           = false;
+            manager->score_multiplier  = 1;
+            sim->events.flags         |= SimEvent_powerup_over;
+        } else {
+            if (IsPowerupEnding(player, sim->time)) { // Powerup over soon warning.
+                player->blink_speed = 0.05f;
+            }
+
+            if (player->blinking_duration > 0) {
+                player->blinking_duration -= delta_t;
+            } else {
+                player->blinking_duration = player->blink_speed;
+                player->col_bool          = !player->col_bool;
+            }
+        }
+
+        if (player->col_bool) {
+            player->col = BLUE;
+        } else {
+            player->col = WHITE;
+        }
+    } else {
+        manager->play_song_volume       += crossfade_rate * delta_t;
+        manager->play_muted_song_volume -= crossfade_rate * delta_t;
+    }
+
+    // TODO: I need to set up a better way to crossfade these tracks. Right not this is the
+    // only track I fade so it's probably fine
+    manager->play_song_volume       = CLAMP(manager->play_song_volume,  0.0f, 1.0f);
+    manager->play_muted_song_volume = CLAMP(manager->play_muted_song_volume, 0.0f, 1.0f);
+}
+
+void SimUpdateEnemies(Game_Sim *sim, f32 delta_t) {
+    Tilemap      *map     = sim->map;
+    Player       *player  = sim->player;
+    Game_Manager *manager = sim->manager;
+
+    // Enemy spawning
+    if (manager->spawn_timer > 0) {
+        manager->spawn_timer -= delta_t;
+    } else {
+        manager->spawn_timer = manager->enemy_spawn_duration;
+
+        s32 player_tile_x     = (u32)player->pos.x / map->tile_size;
+        s32 player_tile_y     = (u32)player->pos.y / map->tile_size;
+        u32 player_tile_index = TilemapIndex(player_tile_x, player_tile_y, map->width);
+
+        u32 tile_index = GetRandomEmptyTileIndex(map, player_tile_index, &sim->random);
+        if (tile_index) {
+            Tile tile = GetTile(map, tile_index);
+
+            // Add enemy
+            Pool_Handle handle;
+            Enemy *new_enemy = (Enemy *)PoolAlloc(&manager->enemy_pool, &handle);
+            if (new_enemy) {
+                AddFlag(tile, TileFlag_enemy);
+                EnemyInit(new_enemy, &manager->enemy_sentinel, tile_index, manager->enemy_animators);
+                map->enemy_slots[tile_index] = handle;
+            }
+        }
+    }
+
+    // Enemy movement
+    if (manager->enemy_move_timer > 0) {
+        manager->enemy_move_timer -= delta_t;
+    } else {
+        // Walking the enemy list rather than the map means each enemy moves 
+        // exactly once and the cost doesn't grow with the size of the map.
+        for (Enemy *enemy = manager->enemy_sentinel.next;
+             enemy != &manager->enemy_sentinel;
+             enemy = enemy->next) {
+            u32 tile_index          = enemy->tile_index;
+            u32 eligible_tile_index = FindEligibleTileIndexForEnemyMove(map, tile_index, &sim->random);
+            if (eligible_tile_index) {
+                map->enemy_slots[eligible_tile_index] = map->enemy_slots[tile_index];
+                map->enemy_slots[tile_index]          = {};
+                enemy->tile_index                     = eligible_tile_index;
+                ClearFlag(GetTile(map, tile_index), TileFlag_enemy);
+                AddFlag(GetTile(map, eligible_tile_index), TileFlag_enemy);
+            }
+        }
+
+        manager->enemy_move_timer = manager->enemy_move_duration;
+    }
+}
+
+void SimStep(Game_Sim *sim, Input_Frame *input, f32 delta_t) {
+    Tilemap      *map     = sim->map;
+    Player       *player  = sim->player;
+    Game_Manager *manager = sim->manager;
+
+    sim->events = {};
+    sim->time  += delta_t;
+
+    // Remember where everything was at the start of the step so the
+    // renderer can interpolate between the last two sim states.
+    player->prev_pos = player->pos;
+    for (Enemy *enemy = manager->enemy_sentinel.next;
+         enemy != &manager->enemy_sentinel;
+         enemy = enemy->next) {
+        enemy->prev_tile_index = enemy->tile_index;
+    }
+
+    if (manager->state == GameState_play) {
+        SimUpdatePlayer(sim, input, delta_t);
+        SimUpdatePowerup(sim, delta_t);
+        SimUpdateEnemies(sim, delta_t);
+
+        manager->fire_cleared = (CountTilesWithFlag(map, TilePlane_fire) == 0);
+
+        if (manager->fire_cleared && player->powered_up) {
+            manager->state = GameState_win;
+        }
+    }
+}
@@ -11,37 +11,6 @@
 // I can add more slots later and the sound effects 
 // can be done in the same way.
 
-static const char *g_song_paths[Song_count] = {
-    "../assets/sounds/music.wav",          // Song_play
-    "../assets/sounds/music_muted.wav",    // Song_play_muted
-    "../assets/sounds/tutorial_track.wav", // Song_tutorial
-    "../assets/sounds/intro_music.wav",    // Song_intro
-    "../assets/sounds/win_track.wav",      // Song_win
-};
-
-static const char *g_sfx_paths[SoundEffect_count] = {
-    "../assets/sounds/powerup.wav",         // SoundEffect_powerup
-    "../assets/sounds/powerup_end.wav",     // SoundEffect_powerup_end
-    "../assets/sounds/powerup_collect.wav", // SoundEffect_powerup_collect
-    "../assets/sounds/powerup_appear.wav",  // SoundEffect_powerup_appear
-    "../assets/sounds/start.wav",           // SoundEffect_spacebar
-};
-
-static const char *g_hype_paths[HYPE_WORD_COUNT] = {
-    "../assets/sounds/hype_1.wav", 
-    "../assets/sounds/hype_2.wav", 
-    "../assets/sounds/hype_3.wav", 
-    "../assets/sounds/hype_4.wav", 
-    "../assets/sounds/hype_5.wav", 
-    "../assets/sounds/hype_6.wav", 
-    "../assets/sounds/hype_7.wav", 
-    "../assets/sounds/hype_8.wav", 
-    "../assets/sounds/hype_9.wav", 
-    "../assets/sounds/hype_10.wav", 
-    "../assets/sounds/hype_11.wav", 
-    "../assets/sounds/hype_12.wav", 
-};
-
 EM_JS(void, wa_setup, (), {
   if (!Module._wa) Module._wa = {};
   const A = Module._wa;
@@ -55,7 +24,7 @@ EM_JS(void, wa_setup, (), {
   if (!A.slots) {
     A.slots = {};
     for (let i = 0; i < 8; ++i) {
-      A.slots[i] = { gain: null, src: null, html: null, startTime: 0, duration: 0, elNode: null };
+      A.slots[i] = { gain: null, src: null, html: null, startTime: 0, duration: 0, elNode: null, pcm: null };
     }
   }
   for (let i = 0; i < 8; ++i) {
@@ -98,8 +67,9 @@ EM_JS(int, wa_slot_is_playing, (int slot), {
   return S.src ? 1 : 0;
 });
 
-// Read file BYTES from MEMFS, decode via WebAudio; fallback to HTMLAudio(Blob) if decode fails.
-EM_JS(void, wa_slot_play_file, (int slot, const char* path_c, int loop), {
+// Read file BYTES from the asset pack (data != 0) or MEMFS, decode via WebAudio; 
+// fallback to HTMLAudio(Blob) if decode fails.
+EM_JS(void, wa_slot_play_file, (int slot, const char* path_c, const void* data, int size, int loop), {
   try {
     const path = UTF8ToString(path_c);
     const A = Module._wa; if (!A) return;
@@ -112,8 +82,9 @@ EM_JS(void, wa_slot_play_file, (int slot, const char* path_c, int loop), {
     if (S.html) { try { S.html.pause(); } catch(e) {} S.html = null; }
     S.src = null;
 
-    // Read from MEMFS (because --preload-file is used in the web build script)
-    const u8 = FS.readFile(path);
+    // The pack lives in the wasm heap, which can grow and move, so copy the 
+    // bytes out before handing them to the async decode.
+    const u8 = data ? HEAPU8.slice(data, data + size) : FS.readFile(path);
     const ab = u8.buffer.slice(u8.byteOffset, u8.byteOffset + u8.byteLength);
 
     function mime(p){
@@ -158,6 +129,70 @@ EM_JS(void, wa_slot_play_file, (int slot, const char* path_c, int loop), {
   } catch(e) { console.error('wa_slot_play_file error', e); }
 });
 
+// Songs that were decoded on the C side (QOA, see WebAudioSongDecodeUpdate). 
+// The buffer gets made up front and filled in a chunk at a time over a few
+// frames, it only becomes the slot's once it's full. The slot keeps it so
+// replaying the song doesn't decode it again.
+EM_JS(void, wa_slot_begin_pcm, (int slot, const char* path_c, int frame_count, int sample_rate, int channels), {
+  try {
+    const A = Module._wa; if (!A) return;
+    if (!A.ctx) { Module._wa = {}; wa_setup(); }
+    const S = A.slots[slot]; if (!S) return;
+    S.pending = { path: UTF8ToString(path_c), buf: A.ctx.createBuffer(channels, frame_count, sample_rate) };
+  } catch(e) { console.error('wa_slot_begin_pcm error', e); }
+});
+
+// Interleaved floats, frame_count of them per channel, from frame offset on.
+EM_JS(void, wa_slot_append_pcm, (int slot, int offset, const float* data, int frame_count), {
+  try {
+    const A = Module._wa; if (!A) return;
+    const S = A.slots[slot]; if (!S || !S.pending) return;
+    const buf      = S.pending.buf;
+    const channels = buf.numberOfChannels;
+    const pcm      = HEAPF32.subarray(data >> 2, (data >> 2) + frame_count*channels);
+    for (let c = 0; c < channels; ++c) {
+      const out = buf.getChannelData(c);
+      for (let i = 0; i < frame_count; ++i) out[offset + i] = pcm[i*channels + c];
+    }
+  } catch(e) { console.error('wa_slot_append_pcm error', e); }
+});
+
+EM_JS(void, wa_slot_finish_pcm, (int slot), {
+  const A = Module._wa; if (!A) return; const S = A.slots[slot]; if (!S || !S.pending) return;
+  S.pcm = S.pending;
+  S.pending = null;
+});
+
+EM_JS(int, wa_slot_has_pcm, (int slot, const char* path_c), {
+  const A = Module._wa; if (!A) return 0; const S = A.slots[slot]; if (!S || !S.pcm) return 0;
+  return S.pcm.path === UTF8ToString(path_c) ? 1 : 0;
+});
+
+// Starts count slots from first, all off the same currentTime so stems that
+// get crossfaded stay in step.
+EM_JS(void, wa_slots_play_pcm, (int first, int count, int loop), {
+  try {
+    const A = Module._wa; if (!A || !A.ctx) return;
+    if (A.ctx.state === 'suspended') A.ctx.resume();
+    const when = A.ctx.currentTime;
+    for (let slot = first; slot < first + count; ++slot) {
+      const S = A.slots[slot]; if (!S || !S.pcm) continue;
+
+      try { if (S.src) S.src.stop(); } catch(e) {}
+      if (S.html) { try { S.html.pause(); } catch(e) {} S.html = null; }
+
+      const node = A.ctx.createBufferSource();
+      node.buffer = S.pcm.buf;
+      node.loop = !!loop;
+      node.connect(S.gain);
+      node.start(when);
+      S.src = node;
+      S.startTime = when;
+      S.duration  = S.pcm.buf.duration;
+    }
+  } catch(e) { console.error('wa_slots_play_pcm error', e); }
+});
+
 EM_JS(void, wa_sfx_init, (), {
   if (!Module._wa) Module._wa = {};
   const A = Module._wa;
@@ -200,6 +235,27 @@ EM_JS(void, wa_sfx_preload, (int id, const char* path_c), {
   } catch(e) { console.error('wa_sfx_preload error', e); }
 });
 
+// Same as wa_sfx_preload but from 16 bit PCM that's already decoded in the 
+// asset pack, so it skips decodeAudioData altogether.
+EM_JS(void, wa_sfx_preload_pcm, (int id, const short* data, int frame_count, int sample_rate, int channels), {
+  try {
+    const A = Module._wa; if (!A) return;
+    if (!A.ctx) { Module._wa = {}; wa_sfx_init(); }
+
+    if (!A.sfx) wa_sfx_init();
+    if (!A.sfx.gains[id]) { const g = A.sfx.gains[id] = A.ctx.createGain(); g.gain.value = 1.0; g.connect(A.sfx.master); }
+    if (!A.sfx.actives[id]) A.sfx.actives[id] = [];
+
+    const buf = A.ctx.createBuffer(channels, frame_count, sample_rate);
+    const pcm = HEAP16.subarray(data >> 1, (data >> 1) + frame_count*channels);
+    for (let c = 0; c < channels; ++c) {
+      const out = buf.getChannelData(c);
+      for (let i = 0; i < frame_count; ++i) out[i] = pcm[i*channels + c] / 32768.0;
+    }
+    A.sfx.buffers[id] = buf;
+  } catch(e) { console.error('wa_sfx_preload_pcm error', e); }
+});
+
 EM_JS(void, wa_sfx_set_volume, (int id, double v), {
   const A = Module._wa; if (!A || !A.sfx || !A.sfx.gains[id]) return;
   A.sfx.gains[id].gain.value = Math.max(0, v);
@@ -245,15 +301,38 @@ EM_JS(void, wa_sfx_stop_all, (), {
   }
 });
 
+// Hands the bytes to the browser as a file download, for things like the
+// profiler's trace that have nowhere else to go on the web.
+EM_JS(void, web_download, (const char* name_c, const char* data, int size), {
+  try {
+    const blob = new Blob([HEAPU8.slice(data, data + size)], { type: 'application/octet-stream' });
+    const a = document.createElement('a');
+    a.href = URL.createObjectURL(blob);
+    a.download = UTF8ToString(name_c);
+    a.click();
+    setTimeout(() => URL.revokeObjectURL(a.href), 1000);
+  } catch(e) { console.error('web_download error', e); }
+});
+
+static inline void WebDownloadFile(const char *name, const char *data, u32 size) { web_download(name, data, (int)size); }
+
 static inline void WebAudioInit() { wa_setup(); }
 static inline void WebAudioUnlockOnGesture() { wa_setup(); wa_unlock(); }
-static inline void WebAudioPlaySlot(int slot, const char *path, bool loop) { wa_slot_play_file(slot, path, loop?1:0); }
+static inline void WebAudioPlaySlot(int slot, const char *path, bool loop) { wa_slot_play_file(slot, path, 0, 0, loop?1:0); }
+static inline void WebAudioPlaySlotMemory(int slot, const char *path, const void *data, u32 size, bool loop) { wa_slot_play_file(slot, path, data, (int)size, loop?1:0); }
+static inline void WebAudioSlotBeginPcm(int slot, const char *path, u32 frame_count, u32 sample_rate, u32 channels) { wa_slot_begin_pcm(slot, path, (int)frame_count, (int)sample_rate, (int)channels); }
+static inline void WebAudioSlotAppendPcm(int slot, u32 offset, const f32 *data, u32 frame_count) { wa_slot_append_pcm(slot, (int)offset, data, (int)frame_count); }
+static inline void WebAudioSlotFinishPcm(int slot) { wa_slot_finish_pcm(slot); }
+static inline bool WebAudioSlotHasPcm(int slot, const char *path) { return wa_slot_has_pcm(slot, path) != 0; }
+static inline void WebAudioPlaySlotPcm(int slot, bool loop) { wa_slots_play_pcm(slot, 1, loop?1:0); }
+static inline void WebAudioPlaySlotsPcm(int first, int count, bool loop) { wa_slots_play_pcm(first, count, loop?1:0); }
 static inline void WebAudioStopSlot(int slot) { wa_slot_stop(slot); }
 static inline void WebAudioSetVol(int slot, float v) { wa_slot_set_volume(slot, (double)v); }
 static inline bool WebAudioIsPlaying(int slot) { return wa_slot_is_playing(slot) != 0; }
 
 static inline void WebAudioSfxInit() { wa_sfx_init(); }
 static inline void WebAudioSfxPreload(int id, const char *path) { wa_sfx_preload(id, path); }
+static inline void WebAudioSfxPreloadPcm(int id, const s16 *data, u32 frame_count, u32 sample_rate, u32 channels) { wa_sfx_preload_pcm(id, data, (int)frame_count, (int)sample_rate, (int)channels); }
 static inline void WebAudioSfxSetVolume(int id, float v) { wa_sfx_set_volume(id, (double)v); }
 static inline void WebAudioSfxPlay(int id) { wa_sfx_play(id); }
 static inline bool WebAudioSfxIsPlaying(int id) { return wa_sfx_is_playing(id) != 0; }